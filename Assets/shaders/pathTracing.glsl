@@ -0,0 +1,70 @@
+//included by raytrace.rgen, raytrace.rchit, raytrace.rmiss, the wavefront kernels and the visibility queries, so that both integrators follow the same paths for the same seed
+#extension GL_EXT_buffer_reference : require
+
+//the BLAS inputs, packed float3 positions and 32 bit indices
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer Vertices { float vertices[]; };
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer Indices { uint indices[]; };
+
+//matches InstanceGeometry in Raytracer.cpp, one per TLAS instance
+struct Geometry
+{
+	Vertices vertices;
+	Indices indices;
+};
+
+//albedo in rgb and hit distance in a, negative for misses, world space normal facing the ray in normal
+struct Payload
+{
+	vec4 colorDistance;
+	vec3 normal;
+};
+
+//there are no lights, every path leaving the scene after a bounce sees a uniformly white sky
+const vec3 skyColor = vec3(1.0);
+//bounces start this far off the surface along its normal
+const float surfaceOffset = 1e-3;
+
+//R2 sequence, the first sample is the pixel center
+vec2 getJitter(uint sampleIndex) {
+	return fract(.5 + float(sampleIndex) * vec2(.7548776662, .5698402910));
+}
+
+//pcg
+uint hash(uint value) {
+	const uint state = value * 747796405u + 2891336453u;
+	const uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+//two uniform numbers in [0, 1) for the bounce off the hit at the given depth of the path through the pixel
+vec2 getRandom(uint pixelIndex, uint seed, uint depth) {
+	const uint first = hash(pixelIndex ^ hash(seed ^ hash(depth)));
+	const uint second = hash(first);
+	return vec2(first >> 8, second >> 8) / 16777216.0;
+}
+
+//cosine weighted direction around the normal, which cancels the cosine and the pdf of a diffuse bounce
+vec3 sampleCosine(vec3 normal, vec2 random) {
+	const vec3 tangent = normalize(cross(normal, abs(normal.x) > .9 ? vec3(.0, 1.0, .0) : vec3(1.0, .0, .0)));
+	const vec3 bitangent = cross(normal, tangent);
+	const float radius = sqrt(random.x);
+	const float angle = 6.28318530718 * random.y;
+	return normalize(tangent * radius * cos(angle) + bitangent * radius * sin(angle) + normal * sqrt(max(1.0 - random.x, .0)));
+}
+
+vec3 getVertex(Geometry geometry, uint index) {
+	return vec3(geometry.vertices.vertices[3 * index], geometry.vertices.vertices[3 * index + 1], geometry.vertices.vertices[3 * index + 2]);
+}
+
+//geometric normal of the triangle in world space, flipped to face against the ray as the instances are not culled
+vec3 getWorldNormal(Geometry geometry, uint primitive, mat4x3 objectToWorld, vec3 direction) {
+	const vec3 a = getVertex(geometry, geometry.indices.indices[3 * primitive]);
+	const vec3 b = getVertex(geometry, geometry.indices.indices[3 * primitive + 1]);
+	const vec3 c = getVertex(geometry, geometry.indices.indices[3 * primitive + 2]);
+	const vec3 objectNormal = cross(b - a, c - a);
+	//the poles of the generated spheres have degenerate triangles
+	if(dot(objectNormal, objectNormal) == .0) return -direction;
+
+	const vec3 normal = normalize(transpose(inverse(mat3(objectToWorld))) * objectNormal);
+	return dot(normal, direction) > .0 ? -normal : normal;
+}
@@ -0,0 +1,51 @@
+//shared by visibilityQuery.comp, which traces with ray queries, and visibilityQuery.rgen, which traces through the ray tracing pipeline
+//set 0 is the descriptor set of raytrace.rgen, set 1 holds the output of the queries
+#include "pathTracing.glsl"
+
+layout(binding = 2, set = 0) uniform Camera
+{
+	mat4 viewInverse;
+	mat4 projectionInverse;
+	mat4 viewProjection;
+	mat4 previousViewProjection;
+} camera;
+//albedo shaded by the sun, its shadow and the ambient occlusion of the first hit
+layout(binding = 0, set = 1, rgba16f) uniform writeonly image2D result;
+
+layout(push_constant) uniform PushConstants
+{
+	uint width;
+	uint height;
+	uint aoSamples;
+	float aoRadius;
+	//towards the sun
+	float sunX;
+	float sunY;
+	float sunZ;
+	uint seed;
+	//render resolution pixel the pick query goes through
+	uint cursorX;
+	uint cursorY;
+};
+
+//share of the sky light in the shading, the rest comes from the sun
+const float ambient = .3;
+
+//matches raytrace.rgen
+vec3 computeDir(vec2 position) {
+	const vec2 uv = (position / vec2(width, height)) * 2.0 - 1.0;
+	vec4 target = camera.projectionInverse * vec4(uv.x, uv.y, 1.0, 1.0);
+	return normalize((camera.viewInverse * vec4(normalize(target.xyz), .0)).xyz);
+}
+
+vec3 getCameraPosition() {
+	return (camera.viewInverse * vec4(.0, .0, .0, 1.0)).xyz;
+}
+
+vec3 getSunDirection() {
+	return normalize(vec3(sunX, sunY, sunZ));
+}
+
+vec3 shade(vec3 albedo, vec3 normal, float sunVisibility, float unoccluded) {
+	return albedo * (ambient * unoccluded + (1.0 - ambient) * sunVisibility * max(dot(normal, getSunDirection()), .0));
+}
@@ -0,0 +1,85 @@
+//bindings and push constants shared by the wavefront kernels, all of them use the same descriptor set and pipeline layout
+//a bounce runs wavefrontIntersect.comp, wavefrontPrepare.comp, wavefrontScatter.comp and wavefrontShade.comp on the rays of one queue
+//and the shade kernel appends the rays of the next bounce to the other queue
+#include "pathTracing.glsl"
+
+//matches maxBounces in Wavefront.h
+const uint maxBounces = 4;
+//local size of the kernels running over a queue
+const uint groupSize = 64;
+//the material and the octant of the direction, misses all go into the last bucket
+const uint bucketCount = 256;
+const uint missBucket = bucketCount - 1;
+
+//throughput is the product of the albedos the path hit so far, depth the number of hits
+struct Ray
+{
+	vec3 origin;
+	uint pixel;
+	vec3 direction;
+	uint depth;
+	vec3 throughput;
+	uint padding;
+};
+
+//distance is negative for misses
+struct Hit
+{
+	vec3 normal;
+	float distance;
+	uint material;
+	uint key;
+	uint padding[2];
+};
+
+//the dispatch arguments come first so that the queue can be dispatched indirectly
+struct Queue
+{
+	uint groupCountX;
+	uint groupCountY;
+	uint groupCountZ;
+	uint count;
+};
+
+struct Material
+{
+	vec4 albedo;
+};
+
+layout(binding = 2, set = 0, std430) readonly buffer Materials { Material materials[]; };
+//indexed by the instance
+layout(binding = 3, set = 0, std430) readonly buffer Geometries { Geometry geometries[]; };
+//the trace image, the shade kernel adds the radiance of the paths ending at their pixel
+layout(binding = 4, set = 0, rgba16f) uniform image2D radiance;
+//both queues one after the other, capacity rays each
+layout(binding = 5, set = 0, std430) buffer Rays { Ray rays[]; };
+//one per ray of the queue being traced
+layout(binding = 6, set = 0, std430) buffer Hits { Hit hits[]; };
+//indices of the rays of the queue being traced sorted by bucket
+layout(binding = 7, set = 0, std430) buffer Order { uint order[]; };
+layout(binding = 8, set = 0, std430) buffer Queues { Queue queues[2]; };
+//the counts are zero outside of a bounce, the offsets are where the next ray of every bucket goes
+layout(binding = 9, set = 0, std430) buffer Buckets
+{
+	uint bucketCounts[bucketCount];
+	uint bucketOffsets[bucketCount];
+};
+//rays traced in every bounce of the frame, read by the host
+layout(binding = 10, set = 0, std430) buffer Stats { uint rayCounts[maxBounces + 1]; };
+
+layout(push_constant) uniform PushConstants
+{
+	uint width;
+	uint height;
+	//rays per queue
+	uint capacity;
+	uint seed;
+	uint bounces;
+	//bounce recorded, the rays of queue depth % 2 are traced
+	uint depth;
+	uint sorted;
+};
+
+uint getInputQueue() {
+	return depth & 1;
+}
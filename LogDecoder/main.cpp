@@ -0,0 +1,131 @@
+#include "Logger/LogRecord.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+//turns a binary log written by Logger::openBinaryLogFile back into the text the console would have shown
+//usage : LogDecoder <binary log> [text output], writes to stdout without an output path
+
+namespace {
+
+	template<typename T>
+	bool readBinary(std::ifstream &stream, T &value)
+	{
+		return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+	}
+
+	bool readFormat(std::ifstream &stream, uint32_t &id, std::string &format)
+	{
+		uint16_t length;
+		if (!readBinary(stream, id) || !readBinary(stream, length)) return false;
+
+		format.resize(length);
+		return static_cast<bool>(stream.read(format.data(), length));
+	}
+
+	bool decode(std::ifstream &input, std::ostream &output)
+	{
+		char magic[sizeof(logging::binaryLogMagic)];
+		if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, logging::binaryLogMagic, sizeof(magic)) != 0)
+		{
+			std::fprintf(stderr, "Not a binary log!\n");
+			return false;
+		}
+
+		std::unordered_map<uint32_t, std::string> formats = {};
+		logging::Record record = {};
+		char text[1024];
+		uint64_t recordCount = 0;
+		bool truncated = false;
+
+		logging::BinaryEntry entry;
+		while (readBinary(input, entry))
+		{
+			if (entry == logging::BinaryEntry::FORMAT)
+			{
+				uint32_t id;
+				std::string format = {};
+				if (!readFormat(input, id, format))
+				{
+					truncated = true;
+					break;
+				}
+				formats[id] = std::move(format);
+				continue;
+			}
+
+			if (entry != logging::BinaryEntry::RECORD)
+			{
+				std::fprintf(stderr, "Unknown entry %u after %llu records!\n", static_cast<uint32_t>(entry), static_cast<unsigned long long>(recordCount));
+				return false;
+			}
+
+			uint8_t verbosity;
+			uint32_t formatId;
+			if (!readBinary(input, verbosity) || !readBinary(input, record.kind) || !readBinary(input, formatId) || !readBinary(input, record.size) ||
+				verbosity > Logger::Verbosity::TRIVIAL || record.size > logging::payloadSize || !input.read(reinterpret_cast<char *>(record.payload), record.size))
+			{
+				truncated = true;
+				break;
+			}
+			record.verbosity = static_cast<Logger::Verbosity>(verbosity);
+
+			const char *format = nullptr;
+			if (record.kind == logging::RecordKind::DEFERRED)
+			{
+				auto it = formats.find(formatId);
+				if (it == formats.end())
+				{
+					std::fprintf(stderr, "Record %llu uses undefined format %u!\n", static_cast<unsigned long long>(recordCount), formatId);
+					return false;
+				}
+				format = it->second.c_str();
+			}
+
+			const size_t length = logging::formatRecord(record, format, text, sizeof(text));
+			output << "[" << logging::getVerbosityPrefix(record.verbosity) << "] ";
+			output.write(text, static_cast<std::streamsize>(length));
+			output << '\n';
+			recordCount++;
+		}
+
+		//a log cut short by a crash still decodes up to its last complete record
+		if (truncated)
+		{
+			std::fprintf(stderr, "Truncated record after %llu records!\n", static_cast<unsigned long long>(recordCount));
+		}
+		return true;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage : LogDecoder <binary log> [text output]\n");
+		return 1;
+	}
+
+	std::ifstream input = std::ifstream(argv[1], std::ios::in | std::ios::binary);
+	if (!input.is_open())
+	{
+		std::fprintf(stderr, "Couldn't open %s!\n", argv[1]);
+		return 1;
+	}
+
+	if (argc < 3)
+	{
+		return decode(input, std::cout) ? 0 : 1;
+	}
+
+	std::ofstream output = std::ofstream(argv[2], std::ios::out | std::ios::trunc);
+	if (!output.is_open())
+	{
+		std::fprintf(stderr, "Couldn't open %s!\n", argv[2]);
+		return 1;
+	}
+	return decode(input, output) ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+#include "AdaptiveSampling.h"
+#include <assert.h>
+#include "Logger/Logger.h"
+#include <cstring>
+
+namespace {
+
+	//matches the push constant block in sampleBudget.comp
+	struct PushConstants
+	{
+		uint32_t adaptive;
+		uint32_t samplesPerFrame;
+		uint32_t minSamples;
+		uint32_t maxSamplesPerFrame;
+		uint32_t maxSamples;
+		float errorThreshold;
+		uint32_t reset;
+		uint32_t width;
+		uint32_t height;
+		uint32_t pattern;
+		uint32_t phase;
+	};
+
+	constexpr uint32_t imageBindingCount = 3;
+	constexpr uint32_t statsBinding = 3;
+	constexpr uint32_t tilesBinding = 4;
+
+	PushConstants getPushConstants(VkExtent2D extent, reconstruction::TracePattern pattern, uint32_t phase, const adaptive::Settings &settings, bool reset)
+	{
+		return PushConstants
+		{
+			.adaptive = settings.adaptive ? 1U : 0U,
+			.samplesPerFrame = settings.samplesPerFrame,
+			.minSamples = settings.minSamples,
+			.maxSamplesPerFrame = settings.maxSamplesPerFrame,
+			.maxSamples = settings.maxSamples,
+			.errorThreshold = settings.errorThreshold,
+			.reset = reset ? 1U : 0U,
+			.width = extent.width,
+			.height = extent.height,
+			.pattern = static_cast<uint32_t>(pattern),
+			.phase = phase
+		};
+	}
+}
+
+namespace adaptive {
+
+	Pipeline createPipeline()
+	{
+		Pipeline pipeline = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(imageBindingCount + 2);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = i < imageBindingCount ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipeline.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipeline.layout = vkut::common::createPipelineLayout({ pipeline.descriptorSetLayout }, { pushConstantRange });
+
+		VkShaderModule shaderModule = vkut::common::createShaderModule("../Assets/shaders/sampleBudget.comp.spv");
+		pipeline.pipeline = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		shaderModule = vkut::common::createShaderModule("../Assets/shaders/traceTiles.comp.spv");
+		pipeline.tiles = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		return pipeline;
+	}
+
+	void destroyPipeline(Pipeline pipeline)
+	{
+		vkut::common::destroyPipeline(pipeline.tiles);
+		vkut::common::destroyPipeline(pipeline.pipeline);
+		vkut::common::destroyPipelineLayout(pipeline.layout);
+		vkut::common::destroyDescriptorSetLayout(pipeline.descriptorSetLayout);
+	}
+
+	Targets createTargets(VkCommandPool commandPool, const Pipeline &pipeline, VkExtent2D extent, size_t framesInFlight)
+	{
+		Targets targets
+		{
+			.accumulation = vkut::common::createStorageImage(commandPool, extent, accumulationFormat),
+			.moments = vkut::common::createStorageImage(commandPool, extent, momentsFormat),
+			.budget = vkut::common::createStorageImage(commandPool, extent, budgetFormat),
+			.statsBuffer = vkut::common::createPersistentBuffer(sizeof(Stats), static_cast<uint32_t>(framesInFlight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		};
+
+		//enough for every tile of a launch over the whole extent, the indirect trace reads the command through its device address
+		VkMemoryAllocateFlagsInfo allocateFlags
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+			.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+		};
+		const VkDeviceSize tileCount = static_cast<VkDeviceSize>((extent.width + tileSize - 1) / tileSize) * ((extent.height + tileSize - 1) / tileSize);
+		targets.tiles = vkut::common::createBuffer(
+			sizeof(VkTraceRaysIndirectCommandKHR) + tileCount * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			allocateFlags);
+
+		const uint32_t setCount = static_cast<uint32_t>(framesInFlight);
+		targets.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }, setCount * imageBindingCount, setCount);
+		targets.descriptorSets.resize(framesInFlight);
+
+		const VkImageView views[imageBindingCount] = { targets.accumulation.view, targets.moments.view, targets.budget.view };
+		VkDescriptorImageInfo imageInfos[imageBindingCount] = {};
+		for (uint32_t binding = 0; binding < imageBindingCount; binding++)
+		{
+			imageInfos[binding] = { .sampler = VK_NULL_HANDLE, .imageView = views[binding], .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+		}
+
+		for (size_t i = 0; i < framesInFlight; i++)
+		{
+			VkDescriptorBufferInfo statsInfo
+			{
+				.buffer = targets.statsBuffer.buffer.buffer,
+				.offset = vkut::common::getRegionOffset(targets.statsBuffer, static_cast<uint32_t>(i)),
+				.range = targets.statsBuffer.regionSize
+			};
+
+			VkDescriptorBufferInfo tilesInfo
+			{
+				.buffer = targets.tiles.buffer,
+				.offset = 0,
+				.range = VK_WHOLE_SIZE
+			};
+
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(imageBindingCount + 2);
+			for (uint32_t binding = 0; binding < imageBindingCount; binding++)
+			{
+				descriptorSetInfos[binding] = vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = binding,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+					.pImageInfo = &imageInfos[binding],
+					.pBufferInfo = nullptr,
+					.pTexelBufferView = nullptr
+				};
+			}
+			descriptorSetInfos[statsBinding] = vkut::DescriptorSetInfo
+			{
+				.pNext = nullptr,
+				.dstBinding = statsBinding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pImageInfo = nullptr,
+				.pBufferInfo = &statsInfo,
+				.pTexelBufferView = nullptr
+			};
+			descriptorSetInfos[tilesBinding] = vkut::DescriptorSetInfo
+			{
+				.pNext = nullptr,
+				.dstBinding = tilesBinding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pImageInfo = nullptr,
+				.pBufferInfo = &tilesInfo,
+				.pTexelBufferView = nullptr
+			};
+
+			targets.descriptorSets[i] = vkut::common::createDescriptorSet(pipeline.descriptorSetLayout, targets.descriptorPool, descriptorSetInfos);
+		}
+
+		Logger::logMessageFormatted("Created adaptive sampling targets of %ux%u! ", extent.width, extent.height);
+
+		return targets;
+	}
+
+	void destroyTargets(Targets targets)
+	{
+		vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		vkut::common::destroyBuffer(targets.tiles);
+		vkut::common::destroyPersistentBuffer(targets.statsBuffer);
+		vkut::common::destroyStorageImage(targets.budget);
+		vkut::common::destroyStorageImage(targets.moments);
+		vkut::common::destroyStorageImage(targets.accumulation);
+	}
+
+	void recordBudget(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t frame, VkExtent2D extent, reconstruction::TracePattern pattern, uint32_t phase, const Settings &settings, bool reset)
+	{
+		assert(settings.samplesPerFrame > 0 && settings.minSamples > 1);
+		assert(extent.width <= targets.budget.extent.width && extent.height <= targets.budget.extent.height);
+
+		const Stats zero = {};
+		vkut::common::writeRegion(targets.statsBuffer, static_cast<uint32_t>(frame), &zero, sizeof(Stats));
+
+		PushConstants pushConstants = getPushConstants(extent, pattern, phase, settings, reset);
+
+		//the previous frame may still be tracing into the accumulation, or reading its launch size from the tiles
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &targets.descriptorSets[frame], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (extent.width + workgroupSize - 1) / workgroupSize, (extent.height + workgroupSize - 1) / workgroupSize, 1);
+	}
+
+	void recordTiles(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t frame, VkExtent2D extent, reconstruction::TracePattern pattern, uint32_t phase)
+	{
+		//only the budget and the pixels of the pattern are read
+		PushConstants pushConstants = getPushConstants(extent, pattern, phase, Settings{}, false);
+		const VkExtent2D launchExtent = reconstruction::getLaunchExtent(extent, pattern);
+
+		//the budget pass wrote the budget and reset the launch size
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.tiles);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &targets.descriptorSets[frame], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (launchExtent.width + tileSize - 1) / tileSize, (launchExtent.height + tileSize - 1) / tileSize, 1);
+	}
+
+	Stats getStats(const Targets &targets, size_t frame)
+	{
+		const uint32_t region = static_cast<uint32_t>(frame);
+		vkut::common::invalidateRegion(targets.statsBuffer, region, 0, sizeof(Stats));
+
+		Stats stats = {};
+		memcpy(&stats, vkut::common::getRegionPointer(targets.statsBuffer, region), sizeof(Stats));
+		return stats;
+	}
+
+	void addFrame(Convergence &convergence, const Stats &stats, double gpuMilliseconds, uint32_t pixelCount, double convergedRatio)
+	{
+		if (convergence.converged) return;
+
+		convergence.frames++;
+		convergence.rays += stats.rays;
+		convergence.gpuMilliseconds += gpuMilliseconds;
+		convergence.activePixels = stats.activePixels;
+		convergence.converged = static_cast<double>(stats.activePixels) < convergedRatio * static_cast<double>(pixelCount);
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "vkutils.h"
+#include "Reconstruction.h"
+#include <vector>
+
+//per pixel sample budgets from the running variance of the accumulated image, so that rays go where the image is still noisy
+//sampleBudget.comp reads the accumulation, writes how many samples every pixel traces this frame and counts them
+//traceTiles.comp lists the tiles of the launch with a pixel left to trace and writes the launch size of an indirect trace over them
+namespace adaptive {
+
+	constexpr uint32_t workgroupSize = 8;
+	//launch IDs per tile side, a tile is one workgroup of traceTiles.comp
+	constexpr uint32_t tileSize = 8;
+
+	constexpr VkFormat accumulationFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+	constexpr VkFormat momentsFormat = VK_FORMAT_R32G32_SFLOAT;
+	constexpr VkFormat budgetFormat = VK_FORMAT_R32_UINT;
+
+	struct Settings
+	{
+		//variance driven budgets, otherwise every pixel below maxSamples traces samplesPerFrame
+		bool adaptive = true;
+		//samples per frame of pixels without enough samples for a variance estimate yet
+		uint32_t samplesPerFrame = 1;
+		uint32_t minSamples = 8;
+		uint32_t maxSamplesPerFrame = 8;
+		//pixels stop tracing once they accumulated this many samples
+		uint32_t maxSamples = 1024;
+		//standard error of the mean relative to the luminance of the pixel, below it the pixel counts as converged
+		float errorThreshold = .01f;
+	};
+
+	struct Pipeline
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+		VkPipeline tiles;
+	};
+
+	//matches the Stats block in sampleBudget.comp
+	struct Stats
+	{
+		uint32_t rays;
+		uint32_t activePixels;
+	};
+
+	struct Targets
+	{
+		//running mean color in rgb, sample count in a
+		vkut::StorageImage accumulation;
+		//running mean of the luminance and of its square
+		vkut::StorageImage moments;
+		//samples every pixel traces in the current frame
+		vkut::StorageImage budget;
+		//one region per frame in flight, zeroed when the budget pass is recorded
+		vkut::PersistentBuffer statsBuffer;
+		//VkTraceRaysIndirectCommandKHR followed by the tiles it launches, x in the low and y in the high 16 bits
+		vkut::Buffer tiles;
+		VkDescriptorPool descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+	};
+
+	//time and rays since the accumulation was last reset, until few enough pixels are still traced
+	struct Convergence
+	{
+		uint32_t frames;
+		uint64_t rays;
+		double gpuMilliseconds;
+		uint32_t activePixels;
+		bool converged;
+	};
+
+	[[nodiscard]]
+	Pipeline createPipeline();
+	void destroyPipeline(Pipeline pipeline);
+
+	//the accumulation starts out empty
+	[[nodiscard]]
+	Targets createTargets(VkCommandPool commandPool, const Pipeline &pipeline, VkExtent2D extent, size_t framesInFlight);
+	void destroyTargets(Targets targets);
+
+	//writes the budget of the given frame in flight for the top left extent of the targets, reset discards everything accumulated so far
+	//pixels the pattern does not trace in the given phase get no samples
+	//the trace reading the budget has to be behind a barrier from the compute stage
+	void recordBudget(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t frame, VkExtent2D extent, reconstruction::TracePattern pattern, uint32_t phase, const Settings &settings, bool reset);
+
+	//lists the tiles of the launch of the given pattern and phase with samples left in the budget, and sets the launch size to one row per tile
+	//has to be recorded after the budget of the frame, the indirect trace has to be behind common::recordIndirectBarrier from the compute stage
+	void recordTiles(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t frame, VkExtent2D extent, reconstruction::TracePattern pattern, uint32_t phase);
+
+	//the frame has to be completed
+	Stats getStats(const Targets &targets, size_t frame);
+
+	//adds a completed frame, convergedRatio is the fraction of pixels still traced below which the accumulation counts as converged
+	void addFrame(Convergence &convergence, const Stats &stats, double gpuMilliseconds, uint32_t pixelCount, double convergedRatio = .01);
+}
@@ -0,0 +1,61 @@
+#include "Benchmark.h"
+#include <assert.h>
+#include <cstdio>
+#include "Logger/Logger.h"
+#include "Files.h"
+
+BenchmarkReport::BenchmarkReport(const char *givenTitle, const std::vector<std::string> &givenColumns) : title(givenTitle), columns(givenColumns) {}
+
+void BenchmarkReport::addRow(const std::string &name, const std::vector<double> &values)
+{
+	assert(values.size() == columns.size());
+	rows.push_back(Row{ .name = name, .values = values });
+}
+
+void BenchmarkReport::log() const
+{
+	std::string header = "";
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		char cell[64];
+		snprintf(cell, sizeof(cell), "%16s", columns[i].c_str());
+		header += cell;
+	}
+	Logger::logMessageFormatted("[benchmark] %s", title.c_str());
+	Logger::logMessageFormatted("%-24s%s", "", header.c_str());
+
+	for (const Row &row : rows)
+	{
+		std::string line = "";
+		for (size_t i = 0; i < row.values.size(); i++)
+		{
+			char cell[64];
+			snprintf(cell, sizeof(cell), "%16.4f", row.values[i]);
+			line += cell;
+		}
+		Logger::logMessageFormatted("%-24s%s", row.name.c_str(), line.c_str());
+	}
+}
+
+bool BenchmarkReport::writeCsv(const char *path) const
+{
+	std::string csv = "name";
+	for (const std::string &column : columns)
+	{
+		csv += "," + column;
+	}
+	csv += "\n";
+
+	for (const Row &row : rows)
+	{
+		csv += row.name;
+		for (double value : row.values)
+		{
+			csv += "," + std::to_string(value);
+		}
+		csv += "\n";
+	}
+
+	FileWriter writer = FileWriter(std::string(path));
+	return writer.write(csv.data(), csv.size());
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <chrono>
+
+//wall clock timer for host side measurements
+class Stopwatch
+{
+public:
+
+	Stopwatch() : start(std::chrono::high_resolution_clock::now()) {}
+
+	void restart()
+	{
+		start = std::chrono::high_resolution_clock::now();
+	}
+
+	double elapsedMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+private:
+
+	std::chrono::high_resolution_clock::time_point start;
+};
+
+//table of named rows, each holding one value per column
+class BenchmarkReport
+{
+public:
+
+	BenchmarkReport(const char *title, const std::vector<std::string> &columns);
+
+	void addRow(const std::string &name, const std::vector<double> &values);
+
+	void log() const;
+	bool writeCsv(const char *path) const;
+
+private:
+
+	struct Row
+	{
+		std::string name;
+		std::vector<double> values;
+	};
+
+	std::string title;
+	std::vector<std::string> columns;
+	std::vector<Row> rows;
+};
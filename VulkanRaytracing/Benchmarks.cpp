@@ -0,0 +1,993 @@
+#include "Benchmarks.h"
+#include "Raytracer.h"
+#include "Logger/Logger.h"
+#include "Benchmark.h"
+#include "CpuRaytracer.h"
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <bit>
+#include <numeric>
+#include <iterator>
+#include <thread>
+#include <string>
+#include <limits>
+#include <functional>
+
+namespace {
+
+	constexpr size_t benchmarkFrames = 64;
+
+	//average over benchmarkFrames frames
+	double measureTraceMilliseconds(Raytracer &raytracer)
+	{
+		double traceMilliseconds = 0.0;
+		for (size_t frame = 0; frame < benchmarkFrames; frame++)
+		{
+			//one sample per pixel as in a frame after the camera moved, a converged accumulation traces nothing
+			raytracer.restartAccumulation();
+			traceMilliseconds += raytracer.drawFrameAndWait();
+		}
+		return traceMilliseconds / static_cast<double>(benchmarkFrames);
+	}
+
+	void buildPolicies(Raytracer &raytracer)
+	{
+		const vkut::raytracing::BuildPolicy policies[] =
+		{
+			vkut::raytracing::BuildPolicy::FAST_TRACE,
+			vkut::raytracing::BuildPolicy::FAST_BUILD,
+			vkut::raytracing::BuildPolicy::LOW_MEMORY
+		};
+
+		BenchmarkReport report = BenchmarkReport("BLAS build policies", { "build ms", "trace ms", "BLAS KiB" });
+
+		for (vkut::raytracing::BuildPolicy policy : policies)
+		{
+			raytracer.setBuildPolicy(policy);
+			raytracer.rebuildAccelerationStructures();
+
+			double buildMilliseconds = 0.0;
+			double blasKibibytes = 0.0;
+			for (const vkut::raytracing::BottomLevelAccelerationStructure &blas : raytracer.getBottomLevelAccelerationStructures())
+			{
+				buildMilliseconds += blas.buildMilliseconds;
+				blasKibibytes += static_cast<double>(blas.size) / 1024.0;
+			}
+
+			double traceMilliseconds = measureTraceMilliseconds(raytracer);
+
+			report.addRow(vkut::raytracing::getBuildPolicyName(policy), { buildMilliseconds, traceMilliseconds, blasKibibytes });
+		}
+
+		report.log();
+		report.writeCsv("benchmark_build_policies.csv");
+	}
+
+	//input latency and frame time of every present policy with and without frame pacing
+	void framePacing(Raytracer &raytracer)
+	{
+		const vkut::PresentPolicy policies[] =
+		{
+			vkut::PresentPolicy::THROUGHPUT,
+			vkut::PresentPolicy::LATENCY,
+			vkut::PresentPolicy::VSYNC
+		};
+		const char *policyNames[] = { "throughput", "latency", "vsync" };
+
+		BenchmarkReport report = BenchmarkReport("Frame pacing", { "latency ms", "max latency ms", "frame ms" });
+
+		const vkut::PresentPolicy previousPolicy = vkut::presentPolicy;
+		const bool previousPacing = raytracer.getFramePacing();
+		for (size_t i = 0; i < std::size(policies); i++)
+		{
+			raytracer.setPresentPolicy(policies[i]);
+
+			for (bool pacing : { false, true })
+			{
+				raytracer.setFramePacing(pacing);
+				//lets the queue settle into the new configuration before measuring
+				raytracer.drawPacedFrames(raytracer.getFramesInFlight() * 2U);
+
+				raytracer.resetPacingStats();
+				raytracer.drawPacedFrames(benchmarkFrames);
+
+				const FramePacer::Stats stats = raytracer.getPacingStats();
+				report.addRow(std::string(policyNames[i]) + (pacing ? " paced" : ""), { stats.averageLatencyMilliseconds, stats.maxLatencyMilliseconds, stats.averageFrameMilliseconds });
+			}
+		}
+
+		raytracer.setPresentPolicy(previousPolicy);
+		raytracer.setFramePacing(previousPacing);
+
+		report.log();
+		report.writeCsv("benchmark_frame_pacing.csv");
+	}
+
+	//rays and time until convergence against uniform sampling with as many rays, both compared to a high sample count reference
+	void adaptiveSampling(Raytracer &raytracer)
+	{
+		constexpr uint32_t referenceSamples = 256;
+		constexpr size_t maxFrames = 1024;
+
+		const adaptive::Settings previousSettings = raytracer.getSamplingSettings();
+		const uint32_t imageWidth = vkut::swapChainExtent.width;
+		const uint32_t imageHeight = vkut::swapChainExtent.height;
+		const double pixelCount = static_cast<double>(imageWidth) * static_cast<double>(imageHeight);
+
+		//frames are waited for one by one so that the convergence is up to date after each of them
+		adaptive::Convergence convergence = {};
+		auto accumulate = [&](const adaptive::Settings &settings, const std::function<bool()> &done)
+		{
+			raytracer.setSamplingSettings(settings);
+			raytracer.restartAccumulation();
+			convergence = {};
+			for (size_t frame = 0; frame < maxFrames && !done(); frame++)
+			{
+				raytracer.drawFrameAndWait();
+				convergence = raytracer.collectConvergence();
+			}
+			return raytracer.readPresentedImage();
+		};
+
+		adaptive::Settings uniformSettings = previousSettings;
+		uniformSettings.adaptive = false;
+		uniformSettings.samplesPerFrame = 8;
+		uniformSettings.maxSamples = referenceSamples;
+		const std::vector<uint8_t> reference = accumulate(uniformSettings, [&]() { return convergence.converged; });
+
+		adaptive::Settings adaptiveSettings = previousSettings;
+		adaptiveSettings.adaptive = true;
+		adaptiveSettings.maxSamples = referenceSamples;
+		const std::vector<uint8_t> adaptiveImage = accumulate(adaptiveSettings, [&]() { return convergence.converged; });
+		const adaptive::Convergence adaptiveConvergence = convergence;
+
+		//one sample per pixel and frame until it traced as many rays as adaptive sampling needed
+		uniformSettings.samplesPerFrame = 1;
+		const std::vector<uint8_t> uniformImage = accumulate(uniformSettings, [&]() { return convergence.rays >= adaptiveConvergence.rays; });
+		const adaptive::Convergence uniformConvergence = convergence;
+
+		raytracer.setSamplingSettings(previousSettings);
+		raytracer.restartAccumulation();
+
+		BenchmarkReport report = BenchmarkReport("Adaptive sampling", { "rays per pixel", "frames", "GPU ms", "PSNR dB", "RMSE" });
+		auto addRow = [&](const char *name, const adaptive::Convergence &result, const std::vector<uint8_t> &image)
+		{
+			const ImageComparison comparison = compareImages(reference, image, imageWidth, imageHeight);
+			report.addRow(name, { static_cast<double>(result.rays) / pixelCount, static_cast<double>(result.frames), result.gpuMilliseconds, comparison.psnr, comparison.rmse });
+		};
+		addRow("uniform", uniformConvergence, uniformImage);
+		addRow("adaptive", adaptiveConvergence, adaptiveImage);
+
+		report.log();
+		report.writeCsv("benchmark_adaptive_sampling.csv");
+	}
+
+	//frames and GPU time to convergence launching every pixel against launching the tiles left to sample
+	void indirectTrace(Raytracer &raytracer)
+	{
+		if (!vkut::raytracing::indirectTraceRaysEnabled)
+		{
+			Logger::logMessage("The device can't trace rays indirectly, skipping the indirect trace benchmark! ");
+			return;
+		}
+
+		constexpr size_t maxFrames = 1024;
+
+		const bool previousIndirect = raytracer.getIndirectTrace();
+		const uint32_t imageWidth = vkut::swapChainExtent.width;
+		const uint32_t imageHeight = vkut::swapChainExtent.height;
+
+		BenchmarkReport report = BenchmarkReport("Direct and indirect trace launches", { "frames", "GPU ms", "last frame ms", "RMSE" });
+		std::vector<uint8_t> reference = {};
+		for (bool indirect : { false, true })
+		{
+			raytracer.setIndirectTrace(indirect);
+			raytracer.restartAccumulation();
+			adaptive::Convergence convergence = {};
+			//the last frames trace the few pixels that are still noisy, which is where skipping the other tiles pays off
+			double lastFrameMilliseconds = .0;
+			for (size_t frame = 0; frame < maxFrames && !convergence.converged; frame++)
+			{
+				lastFrameMilliseconds = raytracer.drawFrameAndWait();
+				convergence = raytracer.collectConvergence();
+			}
+			const std::vector<uint8_t> image = raytracer.readPresentedImage();
+			if (!indirect) reference = image;
+
+			const ImageComparison comparison = compareImages(reference, image, imageWidth, imageHeight);
+			report.addRow(indirect ? "indirect" : "direct", { static_cast<double>(convergence.frames), convergence.gpuMilliseconds, lastFrameMilliseconds, comparison.rmse });
+		}
+
+		raytracer.setIndirectTrace(previousIndirect);
+		raytracer.restartAccumulation();
+
+		report.log();
+		report.writeCsv("benchmark_indirect_trace.csv");
+	}
+
+	//how closely the resolution controller holds a frame time below what the full resolution takes
+	void dynamicResolution(Raytracer &raytracer)
+	{
+		const double previousTarget = raytracer.getTargetFrameTime();
+
+		raytracer.setTargetFrameTime(.0);
+		const double fullMilliseconds = measureTraceMilliseconds(raytracer);
+		const double fullPixels = static_cast<double>(vkut::swapChainExtent.width) * static_cast<double>(vkut::swapChainExtent.height);
+
+		BenchmarkReport report = BenchmarkReport("Dynamic resolution", { "target ms", "frame ms", "mean error %", "max error %", "scale" });
+		report.addRow("full resolution", { fullMilliseconds, fullMilliseconds, .0, .0, 1.0 });
+
+		for (double fraction : { .75, .5, .25 })
+		{
+			const double targetMilliseconds = fullMilliseconds * fraction;
+			raytracer.setTargetFrameTime(targetMilliseconds);
+
+			double frameMilliseconds = .0;
+			double errorSum = .0;
+			double maxError = .0;
+			double scaleSum = .0;
+			//the first half lets the controller settle
+			for (size_t frame = 0; frame < benchmarkFrames * 2U; frame++)
+			{
+				raytracer.restartAccumulation();
+				const double milliseconds = raytracer.drawFrameAndWait();
+				if (frame < benchmarkFrames) continue;
+
+				const VkExtent2D renderExtent = raytracer.getRenderExtent();
+				const double error = std::abs(milliseconds - targetMilliseconds) / targetMilliseconds;
+				frameMilliseconds += milliseconds;
+				errorSum += error;
+				maxError = std::max(maxError, error);
+				scaleSum += std::sqrt(static_cast<double>(renderExtent.width) * static_cast<double>(renderExtent.height) / fullPixels);
+			}
+
+			const double frames = static_cast<double>(benchmarkFrames);
+			report.addRow("target " + std::to_string(static_cast<int>(fraction * 100.0)) + "%", { targetMilliseconds, frameMilliseconds / frames, errorSum / frames * 100.0, maxError * 100.0, scaleSum / frames });
+		}
+
+		raytracer.setTargetFrameTime(previousTarget);
+		raytracer.restartAccumulation();
+
+		report.log();
+		report.writeCsv("benchmark_dynamic_resolution.csv");
+	}
+
+	//GPU time and PSNR against the full rate render of every trace pattern while the camera moves
+	void tracePatterns(Raytracer &raytracer)
+	{
+		constexpr size_t comparedFrames = 4;
+
+		const reconstruction::TracePattern previousPattern = raytracer.getTracePattern();
+		const double previousTarget = raytracer.getTargetFrameTime();
+		const glm::vec3 cameraPosition = raytracer.getCamera().position;
+		const uint32_t imageWidth = vkut::swapChainExtent.width;
+		const uint32_t imageHeight = vkut::swapChainExtent.height;
+
+		raytracer.setTargetFrameTime(.0);
+
+		//the camera pans so that the history has to be reprojected every frame, the same frame of every pattern sees the same camera
+		std::vector<std::vector<uint8_t>> images = {};
+		auto render = [&](reconstruction::TracePattern pattern)
+		{
+			raytracer.setTracePattern(pattern);
+			raytracer.restartAccumulation();
+			images.clear();
+			double traceMilliseconds = .0;
+			for (size_t frame = 0; frame < benchmarkFrames; frame++)
+			{
+				raytracer.setCameraPosition(cameraPosition + glm::vec3(std::sin(static_cast<float>(frame) * .1f) * .25f, .0f, .0f));
+				traceMilliseconds += raytracer.drawFrameAndWait();
+
+				if ((frame + 1U) % (benchmarkFrames / comparedFrames) == 0)
+				{
+					images.push_back(raytracer.readPresentedImage());
+				}
+			}
+			return traceMilliseconds / static_cast<double>(benchmarkFrames);
+		};
+
+		const double fullMilliseconds = render(reconstruction::TracePattern::FULL);
+		const std::vector<std::vector<uint8_t>> references = images;
+
+		BenchmarkReport report = BenchmarkReport("Trace patterns", { "GPU ms", "speedup", "traced %", "mean PSNR dB", "min PSNR dB" });
+		report.addRow("full", { fullMilliseconds, 1.0, 100.0, std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() });
+
+		const std::pair<const char *, reconstruction::TracePattern> patterns[] =
+		{
+			{ "checkerboard", reconstruction::TracePattern::CHECKERBOARD },
+			{ "interleaved 2x2", reconstruction::TracePattern::INTERLEAVED }
+		};
+		for (const auto &[name, pattern] : patterns)
+		{
+			const double milliseconds = render(pattern);
+
+			double psnrSum = .0;
+			double minPsnr = std::numeric_limits<double>::infinity();
+			for (size_t i = 0; i < images.size(); i++)
+			{
+				const double psnr = compareImages(references[i], images[i], imageWidth, imageHeight).psnr;
+				psnrSum += psnr;
+				minPsnr = std::min(minPsnr, psnr);
+			}
+
+			report.addRow(name, { milliseconds, fullMilliseconds / milliseconds, 100.0 / static_cast<double>(reconstruction::getPeriod(pattern)), psnrSum / static_cast<double>(images.size()), minPsnr });
+		}
+
+		raytracer.setCameraPosition(cameraPosition);
+		raytracer.setTracePattern(previousPattern);
+		raytracer.setTargetFrameTime(previousTarget);
+		raytracer.restartAccumulation();
+
+		report.log();
+		report.writeCsv("benchmark_trace_patterns.csv");
+	}
+
+	//one denoised sample per pixel against one sample and against as many frames accumulated, all compared to a high sample count reference
+	void denoising(Raytracer &raytracer)
+	{
+		constexpr uint32_t referenceSamples = 256;
+		constexpr size_t maxFrames = 1024;
+
+		const adaptive::Settings previousSettings = raytracer.getSamplingSettings();
+		const bool previousDenoise = raytracer.getDenoiser();
+		const uint32_t filterPasses = raytracer.getDenoiserSettings().filterPasses;
+		const uint32_t imageWidth = vkut::swapChainExtent.width;
+		const uint32_t imageHeight = vkut::swapChainExtent.height;
+
+		adaptive::Convergence convergence = {};
+		denoiser::PassMilliseconds passSums = {};
+		auto render = [&](size_t frames)
+		{
+			double traceMilliseconds = .0;
+			for (size_t frame = 0; frame < frames; frame++)
+			{
+				traceMilliseconds += raytracer.drawFrameAndWait();
+				convergence = raytracer.collectConvergence();
+				if (!raytracer.getDenoiser()) continue;
+
+				const denoiser::PassMilliseconds passes = raytracer.getDenoiserPassMilliseconds();
+				passSums.temporal += passes.temporal;
+				passSums.variance += passes.variance;
+				for (uint32_t pass = 0; pass < filterPasses; pass++)
+				{
+					passSums.filter[pass] += passes.filter[pass];
+				}
+				passSums.total += passes.total;
+			}
+			return traceMilliseconds / static_cast<double>(frames);
+		};
+		adaptive::Settings uniformSettings = previousSettings;
+		uniformSettings.adaptive = false;
+		uniformSettings.samplesPerFrame = 8;
+		uniformSettings.maxSamples = referenceSamples;
+		raytracer.setSamplingSettings(uniformSettings);
+		raytracer.setDenoiser(false);
+		for (size_t frame = 0; frame < maxFrames && !convergence.converged; frame++)
+		{
+			render(1);
+		}
+		const std::vector<uint8_t> reference = raytracer.readPresentedImage();
+
+		BenchmarkReport report = BenchmarkReport("Denoiser", { "frames", "GPU ms per frame", "PSNR dB", "RMSE" });
+		auto addRow = [&](const char *name, size_t frames, double milliseconds)
+		{
+			const ImageComparison comparison = compareImages(reference, raytracer.readPresentedImage(), imageWidth, imageHeight);
+			report.addRow(name, { static_cast<double>(frames), milliseconds, comparison.psnr, comparison.rmse });
+		};
+
+		//one sample per pixel and frame, the accumulation keeps them while the camera stands still
+		uniformSettings.samplesPerFrame = 1;
+		uniformSettings.maxSamples = 1024;
+		raytracer.setSamplingSettings(uniformSettings);
+		raytracer.restartAccumulation();
+		addRow("1 spp", 1, render(1));
+		const double accumulatedMilliseconds = render(benchmarkFrames - 1U);
+		addRow("accumulated", benchmarkFrames, accumulatedMilliseconds);
+
+		raytracer.setDenoiser(true);
+		addRow("denoised, first frame", 1, render(1));
+		passSums = {};
+		addRow("denoised", benchmarkFrames, render(benchmarkFrames));
+
+		raytracer.setSamplingSettings(previousSettings);
+		raytracer.setDenoiser(previousDenoise);
+
+		report.log();
+		report.writeCsv("benchmark_denoiser.csv");
+
+		const double frames = static_cast<double>(benchmarkFrames);
+		BenchmarkReport passReport = BenchmarkReport("Denoiser passes", { "GPU ms" });
+		passReport.addRow("temporal", { passSums.temporal / frames });
+		passReport.addRow("variance", { passSums.variance / frames });
+		for (uint32_t pass = 0; pass < filterPasses; pass++)
+		{
+			passReport.addRow("a-trous step " + std::to_string(1U << pass), { passSums.filter[pass] / frames });
+		}
+		passReport.addRow("total", { passSums.total / frames });
+		passReport.log();
+		passReport.writeCsv("benchmark_denoiser_passes.csv");
+	}
+
+	//rays per second of the wavefront kernels with and without sorting against the ray tracing pipeline, following the same paths
+	void wavefrontPaths(Raytracer &raytracer)
+	{
+		const uint32_t bounceCounts[] = { 0, 1, 2, wavefront::maxBounces };
+
+		const uint32_t previousBounces = raytracer.getPathBounces();
+		const bool previousWavefront = raytracer.getWavefront();
+		const wavefront::Settings previousSettings = raytracer.getWavefrontSettings();
+		const reconstruction::TracePattern previousPattern = raytracer.getTracePattern();
+		const bool previousDenoise = raytracer.getDenoiser();
+		const double previousTarget = raytracer.getTargetFrameTime();
+
+		raytracer.setTracePattern(reconstruction::TracePattern::FULL);
+		raytracer.setDenoiser(false);
+		raytracer.setTargetFrameTime(.0);
+
+		//every run starts over at the same frame, so both integrators follow the same paths and the rays counted by the wavefront kernels hold for the pipeline too
+		double raysPerFrame = .0;
+		wavefront::StageMilliseconds stageSums = {};
+		auto render = [&](bool useWavefront, bool sortRays, uint32_t bounces)
+		{
+			wavefront::Settings settings = previousSettings;
+			settings.sortRays = sortRays;
+			raytracer.setWavefront(useWavefront);
+			raytracer.setWavefrontSettings(settings);
+			raytracer.setPathBounces(bounces);
+			raytracer.restartTraceFrames();
+			raysPerFrame = .0;
+			stageSums = {};
+
+			double traceMilliseconds = .0;
+			for (size_t frame = 0; frame < benchmarkFrames; frame++)
+			{
+				//one sample per pixel every frame in the pipeline as well
+				raytracer.restartAccumulation();
+				traceMilliseconds += raytracer.drawFrameAndWait();
+				if (!useWavefront) continue;
+
+				const wavefront::Stats stats = raytracer.getWavefrontStats();
+				for (uint32_t depth = 0; depth <= bounces; depth++)
+				{
+					raysPerFrame += static_cast<double>(stats.rays[depth]);
+				}
+				const wavefront::StageMilliseconds stages = raytracer.getWavefrontStageMilliseconds();
+				stageSums.generate += stages.generate;
+				stageSums.intersect += stages.intersect;
+				stageSums.sort += stages.sort;
+				stageSums.shade += stages.shade;
+				stageSums.total += stages.total;
+			}
+
+			const double frames = static_cast<double>(benchmarkFrames);
+			raysPerFrame /= frames;
+			stageSums = { stageSums.generate / frames, stageSums.intersect / frames, stageSums.sort / frames, stageSums.shade / frames, stageSums.total / frames };
+			return traceMilliseconds / frames;
+		};
+
+		//the frame times include the upscale for every integrator and the sample budget for the pipeline
+		BenchmarkReport report = BenchmarkReport("Wavefront paths", { "bounces", "rays per frame", "GPU ms", "Mrays/s" });
+		BenchmarkReport stageReport = BenchmarkReport("Wavefront stages, sorted", { "generate ms", "intersect ms", "sort ms", "shade ms", "total ms" });
+		for (uint32_t bounces : bounceCounts)
+		{
+			const double sortedMilliseconds = render(true, true, bounces);
+			const double rays = raysPerFrame;
+			const std::string suffix = ", " + std::to_string(bounces) + " bounces";
+			stageReport.addRow(std::to_string(bounces) + " bounces", { stageSums.generate, stageSums.intersect, stageSums.sort, stageSums.shade, stageSums.total });
+
+			const double unsortedMilliseconds = render(true, false, bounces);
+			const double pipelineMilliseconds = render(false, false, bounces);
+
+			auto addRow = [&](const char *name, double milliseconds)
+			{
+				report.addRow(name + suffix, { static_cast<double>(bounces), rays, milliseconds, rays / (milliseconds * 1000.0) });
+			};
+			addRow("ray tracing pipeline", pipelineMilliseconds);
+			addRow("wavefront, sorted", sortedMilliseconds);
+			addRow("wavefront, unsorted", unsortedMilliseconds);
+		}
+
+		raytracer.setPathBounces(previousBounces);
+		raytracer.setWavefront(previousWavefront);
+		raytracer.setWavefrontSettings(previousSettings);
+		raytracer.setTracePattern(previousPattern);
+		raytracer.setDenoiser(previousDenoise);
+		raytracer.setTargetFrameTime(previousTarget);
+
+		report.log();
+		report.writeCsv("benchmark_wavefront.csv");
+		stageReport.log();
+		stageReport.writeCsv("benchmark_wavefront_stages.csv");
+	}
+
+	//GPU time of the shadow and ambient occlusion rays traced with ray queries from a compute shader against the same rays through the ray tracing pipeline
+	void rayQueries(Raytracer &raytracer)
+	{
+		const uint32_t aoSampleCounts[] = { 0, 1, 4, 16 };
+
+		const bool previousVisibilityQueries = raytracer.getVisibilityQueries();
+		const queries::Settings previousSettings = raytracer.getQuerySettings();
+		const double previousTarget = raytracer.getTargetFrameTime();
+
+		raytracer.setVisibilityQueries(true);
+		raytracer.setTargetFrameTime(.0);
+		const VkExtent2D renderExtent = raytracer.getRenderExtent();
+		const double pixels = static_cast<double>(renderExtent.width) * static_cast<double>(renderExtent.height);
+
+		//both paths trace the same rays, every run starts over at the same frame so the ambient occlusion directions match too
+		double frameMilliseconds = .0;
+		auto render = [&](bool usePipeline, uint32_t aoSamples)
+		{
+			queries::Settings settings = previousSettings;
+			settings.usePipeline = usePipeline;
+			settings.aoSamples = aoSamples;
+			raytracer.setQuerySettings(settings);
+			raytracer.restartTraceFrames();
+
+			double queryMilliseconds = .0;
+			frameMilliseconds = .0;
+			for (size_t frame = 0; frame < benchmarkFrames; frame++)
+			{
+				frameMilliseconds += raytracer.drawFrameAndWait();
+				queryMilliseconds += raytracer.getQueryMilliseconds();
+			}
+			frameMilliseconds /= static_cast<double>(benchmarkFrames);
+			return queryMilliseconds / static_cast<double>(benchmarkFrames);
+		};
+
+		//a primary ray, a shadow ray and the ambient occlusion rays per pixel hitting the scene, the frame time adds the upscale
+		BenchmarkReport report = BenchmarkReport("Visibility queries", { "AO samples", "visibility ms", "frame ms", "Mpixels/s" });
+		for (uint32_t aoSamples : aoSampleCounts)
+		{
+			const std::string suffix = ", " + std::to_string(aoSamples) + " AO samples";
+			for (bool usePipeline : { true, false })
+			{
+				const double milliseconds = render(usePipeline, aoSamples);
+				report.addRow((usePipeline ? "ray tracing pipeline" : "ray queries") + suffix,
+					{ static_cast<double>(aoSamples), milliseconds, frameMilliseconds, pixels / (milliseconds * 1000.0) });
+			}
+		}
+
+		raytracer.setVisibilityQueries(previousVisibilityQueries);
+		raytracer.setQuerySettings(previousSettings);
+		raytracer.setTargetFrameTime(previousTarget);
+
+		report.log();
+		report.writeCsv("benchmark_ray_queries.csv");
+	}
+
+	void geometryPlacement(Raytracer &raytracer)
+	{
+		const vkut::raytracing::MemoryPlacement placements[] =
+		{
+			vkut::raytracing::MemoryPlacement::HOST_VISIBLE,
+			vkut::raytracing::MemoryPlacement::DEVICE_LOCAL
+		};
+
+		BenchmarkReport report = BenchmarkReport("Geometry memory placement", { "build ms", "trace ms", "Mrays/s" });
+
+		//one primary ray per pixel
+		const double raysPerFrame = static_cast<double>(vkut::swapChainExtent.width) * static_cast<double>(vkut::swapChainExtent.height);
+
+		raytracer.setBuildPolicy(vkut::raytracing::BuildPolicy::FAST_TRACE);
+
+		for (vkut::raytracing::MemoryPlacement placement : placements)
+		{
+			raytracer.setGeometryPlacement(placement);
+			raytracer.rebuildAccelerationStructures();
+
+			double buildMilliseconds = 0.0;
+			for (const vkut::raytracing::BottomLevelAccelerationStructure &blas : raytracer.getBottomLevelAccelerationStructures())
+			{
+				buildMilliseconds += blas.buildMilliseconds;
+			}
+
+			double traceMilliseconds = measureTraceMilliseconds(raytracer);
+			double megaraysPerSecond = raysPerFrame / (traceMilliseconds * 1000.0);
+
+			report.addRow(vkut::raytracing::getMemoryPlacementName(placement), { buildMilliseconds, traceMilliseconds, megaraysPerSecond });
+		}
+
+		report.log();
+		report.writeCsv("benchmark_geometry_placement.csv");
+	}
+
+	//BLAS build time and throughput on the host against the device, and how long the whole rebuild took
+	void hostBuilds(Raytracer &raytracer)
+	{
+		if (!vkut::raytracing::hostCommandsEnabled)
+		{
+			Logger::logMessage("The device can't build acceleration structures on the host, skipping the host build benchmark! ");
+			return;
+		}
+
+		BenchmarkReport report = BenchmarkReport("BLAS builds on the host and the device", { "build ms", "Mtriangles/s", "rebuild ms", "BLAS KiB" });
+
+		raytracer.setBuildPolicy(vkut::raytracing::BuildPolicy::FAST_TRACE);
+
+		//host visible geometry is not uploaded through the queue, so the host builds never wait for it
+		const vkut::raytracing::MemoryPlacement previousPlacement = raytracer.getGeometryPlacement();
+		raytracer.setGeometryPlacement(vkut::raytracing::MemoryPlacement::HOST_VISIBLE);
+
+		for (bool host : { false, true })
+		{
+			raytracer.setHostBuilds(host);
+			Stopwatch stopwatch = Stopwatch();
+			raytracer.rebuildAccelerationStructures();
+			const double rebuildMilliseconds = stopwatch.elapsedMilliseconds();
+
+			double buildMilliseconds = 0.0;
+			double triangleCount = 0.0;
+			double kibibytes = 0.0;
+			for (const vkut::raytracing::BottomLevelAccelerationStructure &blas : raytracer.getBottomLevelAccelerationStructures())
+			{
+				buildMilliseconds += blas.buildMilliseconds;
+				triangleCount += static_cast<double>(blas.primitiveCount);
+				kibibytes += static_cast<double>(blas.size) / 1024.0;
+			}
+
+			report.addRow(host ? "host" : "device", { buildMilliseconds, triangleCount / (buildMilliseconds * 1000.0), rebuildMilliseconds, kibibytes });
+		}
+
+		raytracer.setHostBuilds(false);
+		raytracer.setGeometryPlacement(previousPlacement);
+		raytracer.rebuildAccelerationStructures();
+
+		report.log();
+		report.writeCsv("benchmark_host_builds.csv");
+	}
+
+	//host BVH builds of the same meshes next to what the driver built
+	void cpuBvh(Raytracer &raytracer)
+	{
+		BenchmarkReport report = BenchmarkReport("CPU BVH against driver BLAS", { "triangles", "CPU ms", "SAH cost", "CPU KiB", "driver ms", "driver KiB" });
+
+		const Scene &scene = raytracer.getScene();
+		const std::vector<vkut::raytracing::BottomLevelAccelerationStructure> &blases = raytracer.getBottomLevelAccelerationStructures();
+		CpuRaytracer cpuRaytracer = CpuRaytracer(scene, raytracer.getJobs());
+		const std::vector<Scene::Mesh> &meshes = scene.getMeshes();
+		for (Scene::MeshHandle mesh = 0; mesh < scene.getMeshCount(); mesh++)
+		{
+			const bvh::Statistics &statistics = cpuRaytracer.getMeshStatistics(mesh);
+			const double triangleCount = static_cast<double>(meshes[mesh].indices.size() / 3);
+			const double cpuKibibytes = (static_cast<double>(statistics.nodeCount) * sizeof(bvh::Node) + triangleCount * sizeof(uint32_t)) / 1024.0;
+
+			report.addRow("mesh " + std::to_string(mesh), 
+			{
+				triangleCount,
+				statistics.buildMilliseconds,
+				static_cast<double>(statistics.sahCost),
+				cpuKibibytes,
+				blases[mesh].buildMilliseconds,
+				static_cast<double>(blases[mesh].size) / 1024.0
+			});
+		}
+
+		report.log();
+		report.writeCsv("benchmark_cpu_bvh.csv");
+	}
+
+	//single threaded rays per second of every SIMD level the CPU supports
+	void cpuTraversal(Raytracer &raytracer)
+	{
+		constexpr uint32_t incoherentRayCount = 1 << 20;
+
+		CpuRaytracer cpuRaytracer = CpuRaytracer(raytracer.getScene(), raytracer.getJobs());
+
+		//coherent : the primary rays of one frame, incoherent : random origins inside the scene and random directions
+		std::vector<glm::vec3> coherentOrigins = {}, coherentDirections = {};
+		const VkExtent2D extent = raytracer.getWindowExtent();
+		const CameraData cameraData = raytracer.getCamera().getData(static_cast<float>(extent.width) / static_cast<float>(extent.height));
+		for (uint32_t y = 0; y < extent.height; y++)
+		{
+			for (uint32_t x = 0; x < extent.width; x++)
+			{
+				glm::vec3 origin, direction;
+				CpuRaytracer::generateRay(cameraData, x, y, extent.width, extent.height, origin, direction);
+				coherentOrigins.push_back(origin);
+				coherentDirections.push_back(direction);
+			}
+		}
+
+		std::vector<glm::vec3> incoherentOrigins = {}, incoherentDirections = {};
+		const bvh::Bounds bounds = cpuRaytracer.getBounds();
+		std::mt19937 generator = std::mt19937(1234);
+		std::uniform_real_distribution<float> unit = std::uniform_real_distribution<float>(.0f, 1.0f);
+		std::normal_distribution<float> normal = std::normal_distribution<float>();
+		for (uint32_t i = 0; i < incoherentRayCount; i++)
+		{
+			incoherentOrigins.push_back(glm::mix(bounds.min, bounds.max, glm::vec3(unit(generator), unit(generator), unit(generator))));
+			incoherentDirections.push_back(glm::normalize(glm::vec3(normal(generator), normal(generator), normal(generator))));
+		}
+
+		auto measureMegaraysPerSecond = [&](const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions)
+		{
+			uint32_t hitCount = 0;
+			Stopwatch stopwatch = Stopwatch();
+			for (size_t i = 0; i < origins.size(); i++)
+			{
+				CpuRaytracer::Hit hit;
+				if (cpuRaytracer.intersect(origins[i], directions[i], hit)) hitCount++;
+			}
+			double megaraysPerSecond = static_cast<double>(origins.size()) / (stopwatch.elapsedMilliseconds() * 1000.0);
+			LOG_TRIVIAL_FORMATTED("%u of %u rays hit! ", hitCount, static_cast<uint32_t>(origins.size()));
+			return megaraysPerSecond;
+		};
+
+		BenchmarkReport report = BenchmarkReport("CPU ray traversal", { "coherent Mrays/s", "incoherent Mrays/s", "coherent x", "incoherent x" });
+
+		double scalarCoherent = .0, scalarIncoherent = .0;
+		for (uint32_t level = 0; level <= static_cast<uint32_t>(bvh::getSupportedSimdLevel()); level++)
+		{
+			const bvh::SimdLevel simdLevel = static_cast<bvh::SimdLevel>(level);
+			cpuRaytracer.setSimdLevel(simdLevel);
+
+			double coherent = measureMegaraysPerSecond(coherentOrigins, coherentDirections);
+			double incoherent = measureMegaraysPerSecond(incoherentOrigins, incoherentDirections);
+			if (simdLevel == bvh::SimdLevel::SCALAR)
+			{
+				scalarCoherent = coherent;
+				scalarIncoherent = incoherent;
+			}
+
+			report.addRow(bvh::getSimdLevelName(simdLevel), { coherent, incoherent, coherent / scalarCoherent, incoherent / scalarIncoherent });
+		}
+
+		report.log();
+		report.writeCsv("benchmark_cpu_traversal.csv");
+	}
+
+	//single threaded packets of 8 and 16 rays and sorted ray streams against tracing the same rays one by one
+	void cpuPackets(Raytracer &raytracer)
+	{
+		//4x4 pixel blocks, the upper and lower halves of which are the 4x2 packets of 8
+		constexpr uint32_t blockSize = 4;
+		const glm::vec3 lightPosition = glm::vec3(2.0f, 6.0f, -2.0f);
+
+		CpuRaytracer cpuRaytracer = CpuRaytracer(raytracer.getScene(), raytracer.getJobs());
+		//packets traverse the binary hierarchies, so the rays traced one by one do too
+		cpuRaytracer.setSimdLevel(bvh::SimdLevel::SCALAR);
+
+		const VkExtent2D extent = raytracer.getWindowExtent();
+		const uint32_t imageWidth = extent.width / blockSize * blockSize;
+		const uint32_t imageHeight = extent.height / blockSize * blockSize;
+		const CameraData cameraData = raytracer.getCamera().getData(static_cast<float>(imageWidth) / static_cast<float>(imageHeight));
+
+		std::vector<glm::vec3> primaryOrigins = {}, primaryDirections = {};
+		for (uint32_t blockY = 0; blockY < imageHeight; blockY += blockSize)
+		{
+			for (uint32_t blockX = 0; blockX < imageWidth; blockX += blockSize)
+			{
+				for (uint32_t y = blockY; y < blockY + blockSize; y++)
+				{
+					for (uint32_t x = blockX; x < blockX + blockSize; x++)
+					{
+						glm::vec3 origin, direction;
+						CpuRaytracer::generateRay(cameraData, x, y, imageWidth, imageHeight, origin, direction);
+						primaryOrigins.push_back(origin);
+						primaryDirections.push_back(direction);
+					}
+				}
+			}
+		}
+
+		//shadow rays toward a point light from every primary hit, in block order
+		std::vector<glm::vec3> shadowOrigins = {}, shadowDirections = {};
+		std::vector<float> shadowDistances = {};
+		std::mt19937 generator = std::mt19937(1234);
+		std::normal_distribution<float> normal = std::normal_distribution<float>();
+		for (size_t i = 0; i < primaryOrigins.size(); i++)
+		{
+			CpuRaytracer::Hit hit;
+			if (!cpuRaytracer.intersect(primaryOrigins[i], primaryDirections[i], hit)) continue;
+
+			const glm::vec3 position = primaryOrigins[i] + primaryDirections[i] * hit.t;
+			shadowOrigins.push_back(position);
+			shadowDirections.push_back(glm::normalize(lightPosition - position));
+			shadowDistances.push_back(glm::length(lightPosition - position));
+		}
+		//whole packets only
+		const size_t shadowCount = shadowOrigins.size() / 16 * 16;
+		shadowOrigins.resize(shadowCount);
+		shadowDirections.resize(shadowCount);
+		shadowDistances.resize(shadowCount);
+
+		//diffuse-like bounces in random directions from the same points, shuffled the way a queue of secondary rays would hold them
+		std::vector<uint32_t> order = std::vector<uint32_t>(shadowCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), generator);
+		std::vector<glm::vec3> secondaryOrigins = std::vector<glm::vec3>(shadowCount), secondaryDirections = std::vector<glm::vec3>(shadowCount);
+		for (size_t i = 0; i < shadowCount; i++)
+		{
+			secondaryOrigins[i] = shadowOrigins[order[i]];
+			secondaryDirections[i] = glm::normalize(glm::vec3(normal(generator), normal(generator), normal(generator)));
+		}
+
+		auto measureMegaraysPerSecond = [](size_t rayCount, auto &&traceRays)
+		{
+			Stopwatch stopwatch = Stopwatch();
+			const uint32_t hitCount = traceRays();
+			double megaraysPerSecond = static_cast<double>(rayCount) / (stopwatch.elapsedMilliseconds() * 1000.0);
+			LOG_TRIVIAL_FORMATTED("%u of %u rays hit! ", hitCount, static_cast<uint32_t>(rayCount));
+			return megaraysPerSecond;
+		};
+
+		auto traceSingle = [&](const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions)
+		{
+			return measureMegaraysPerSecond(origins.size(), [&]()
+			{
+				uint32_t hitCount = 0;
+				for (size_t i = 0; i < origins.size(); i++)
+				{
+					CpuRaytracer::Hit hit;
+					if (cpuRaytracer.intersect(origins[i], directions[i], hit)) hitCount++;
+				}
+				return hitCount;
+			});
+		};
+
+		auto tracePackets = [&]<uint32_t Size>(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions)
+		{
+			return measureMegaraysPerSecond(origins.size(), [&]()
+			{
+				uint32_t hitCount = 0;
+				CpuRaytracer::Hit hits[Size];
+				for (size_t i = 0; i < origins.size(); i += Size)
+				{
+					cpuRaytracer.intersect<Size>(&origins[i], &directions[i], hits);
+					for (uint32_t ray = 0; ray < Size; ray++)
+					{
+						if (hits[ray].instance != CpuRaytracer::missed) hitCount++;
+					}
+				}
+				return hitCount;
+			});
+		};
+
+		auto traceShadowSingle = [&]()
+		{
+			return measureMegaraysPerSecond(shadowOrigins.size(), [&]()
+			{
+				uint32_t hitCount = 0;
+				for (size_t i = 0; i < shadowOrigins.size(); i++)
+				{
+					if (cpuRaytracer.occluded(shadowOrigins[i], shadowDirections[i], shadowDistances[i])) hitCount++;
+				}
+				return hitCount;
+			});
+		};
+
+		auto traceShadowPackets = [&]<uint32_t Size>()
+		{
+			return measureMegaraysPerSecond(shadowOrigins.size(), [&]()
+			{
+				uint32_t hitCount = 0;
+				for (size_t i = 0; i < shadowOrigins.size(); i += Size)
+				{
+					hitCount += static_cast<uint32_t>(std::popcount(cpuRaytracer.occluded<Size>(&shadowOrigins[i], &shadowDirections[i], &shadowDistances[i])));
+				}
+				return hitCount;
+			});
+		};
+
+		//includes the time spent sorting the rays
+		auto traceStream = [&]<uint32_t Size>(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions)
+		{
+			return measureMegaraysPerSecond(origins.size(), [&]()
+			{
+				std::vector<CpuRaytracer::Hit> hits = {};
+				cpuRaytracer.intersectStream<Size>(origins, directions, hits);
+				return static_cast<uint32_t>(std::count_if(hits.begin(), hits.end(), [](const CpuRaytracer::Hit &hit) { return hit.instance != CpuRaytracer::missed; }));
+			});
+		};
+
+		BenchmarkReport report = BenchmarkReport("CPU packet traversal", { "single Mrays/s", "8 wide Mrays/s", "16 wide Mrays/s", "8 wide x", "16 wide x" });
+		auto addRow = [&](const char *name, double single, double packets8, double packets16)
+		{
+			report.addRow(name, { single, packets8, packets16, packets8 / single, packets16 / single });
+		};
+
+		addRow("primary packets", 
+			traceSingle(primaryOrigins, primaryDirections), 
+			tracePackets.operator()<8>(primaryOrigins, primaryDirections), 
+			tracePackets.operator()<16>(primaryOrigins, primaryDirections));
+		addRow("shadow packets", 
+			traceShadowSingle(), 
+			traceShadowPackets.operator()<8>(), 
+			traceShadowPackets.operator()<16>());
+
+		const double secondarySingle = traceSingle(secondaryOrigins, secondaryDirections);
+		addRow("secondary packets", 
+			secondarySingle, 
+			tracePackets.operator()<8>(secondaryOrigins, secondaryDirections), 
+			tracePackets.operator()<16>(secondaryOrigins, secondaryDirections));
+		addRow("secondary stream", 
+			secondarySingle, 
+			traceStream.operator()<8>(secondaryOrigins, secondaryDirections), 
+			traceStream.operator()<16>(secondaryOrigins, secondaryDirections));
+
+		report.log();
+		report.writeCsv("benchmark_cpu_packets.csv");
+	}
+
+	//BVH build, CPU render and scheduling overhead from one thread up to every hardware thread
+	void jobSystem(Raytracer &raytracer)
+	{
+		constexpr uint32_t emptyJobCount = 1 << 16;
+
+		Scene::Mesh sphere = Scene::generateSphere(512, 1024, 1.0f);
+		std::vector<glm::vec3> positions = std::vector<glm::vec3>(sphere.vertices.size() / 3);
+		for (size_t vertex = 0; vertex < positions.size(); vertex++)
+		{
+			positions[vertex] = glm::vec3(sphere.vertices[vertex * 3], sphere.vertices[vertex * 3 + 1], sphere.vertices[vertex * 3 + 2]);
+		}
+		const VkExtent2D extent = raytracer.getWindowExtent();
+		const CameraData cameraData = raytracer.getCamera().getData(static_cast<float>(extent.width) / static_cast<float>(extent.height));
+
+		BenchmarkReport report = BenchmarkReport("Job system scaling", { "BVH build ms", "CPU render ms", "build x", "render x", "empty job us" });
+
+		double singleBuild = .0, singleRender = .0;
+		const uint32_t maxThreadCount = std::max(std::thread::hardware_concurrency(), 1U);
+		for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount++)
+		{
+			//the calling thread takes part in every wait, so one thread means no workers
+			JobSystem scalingJobs = JobSystem(threadCount - 1);
+
+			const bvh::Hierarchy hierarchy = bvh::buildTriangles(scalingJobs, positions, sphere.indices);
+			const double build = hierarchy.statistics.buildMilliseconds;
+
+			CpuRaytracer cpuRaytracer = CpuRaytracer(raytracer.getScene(), scalingJobs);
+			Stopwatch stopwatch = Stopwatch();
+			std::vector<uint8_t> image = cpuRaytracer.render(cameraData, extent.width, extent.height);
+			const double render = stopwatch.elapsedMilliseconds();
+
+			//scheduling overhead alone
+			JobSystem::Counter emptyCounter = {};
+			stopwatch.restart();
+			for (uint32_t job = 0; job < emptyJobCount; job++)
+			{
+				scalingJobs.run(emptyCounter, []() {});
+			}
+			scalingJobs.wait(emptyCounter);
+			const double emptyJob = stopwatch.elapsedMilliseconds() * 1000.0 / static_cast<double>(emptyJobCount);
+
+			if (threadCount == 1)
+			{
+				singleBuild = build;
+				singleRender = render;
+			}
+
+			report.addRow(std::to_string(threadCount) + (threadCount == 1 ? " thread" : " threads"), { build, render, singleBuild / build, singleRender / render, emptyJob });
+		}
+
+		report.log();
+		report.writeCsv("benchmark_job_system.csv");
+	}
+}
+
+namespace benchmarks {
+
+	void runRendering(Raytracer &raytracer)
+	{
+		buildPolicies(raytracer);
+		geometryPlacement(raytracer);
+		hostBuilds(raytracer);
+		cpuBvh(raytracer);
+		framePacing(raytracer);
+		adaptiveSampling(raytracer);
+		indirectTrace(raytracer);
+		dynamicResolution(raytracer);
+		tracePatterns(raytracer);
+		denoising(raytracer);
+		wavefrontPaths(raytracer);
+		rayQueries(raytracer);
+	}
+
+	void runCpu(Raytracer &raytracer)
+	{
+		cpuTraversal(raytracer);
+		cpuPackets(raytracer);
+		jobSystem(raytracer);
+	}
+}
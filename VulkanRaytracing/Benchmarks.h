@@ -0,0 +1,13 @@
+#pragma once
+
+class Raytracer;
+
+//the measurements behind --benchmark and --cpu-benchmark, which drive the renderer through the benchmark hooks of Raytracer only
+//every benchmark logs a report and writes it to a csv file
+namespace benchmarks {
+
+	//needs the benchmark scene and an initialized renderer
+	void runRendering(Raytracer &raytracer);
+	//host ray traversal and job system scaling over the benchmark scene, does not touch Vulkan
+	void runCpu(Raytracer &raytracer);
+}
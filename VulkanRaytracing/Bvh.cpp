@@ -0,0 +1,268 @@
+#include "Bvh.h"
+#include <assert.h>
+#include <atomic>
+#include "JobSystem.h"
+#include "Benchmark.h"
+
+namespace bvh
+{
+	namespace {
+
+		struct BuildNode
+		{
+			Bounds bounds;
+			uint32_t children[2];
+			uint32_t begin;
+			//zero for interior nodes
+			uint32_t primitiveCount;
+		};
+
+		struct Bin
+		{
+			Bounds bounds = {};
+			uint32_t count = 0;
+		};
+
+		struct Split
+		{
+			glm::length_t axis;
+			uint32_t bin;
+			float cost;
+		};
+
+		struct BuildContext
+		{
+			JobSystem &jobs;
+			const BuildSettings &settings;
+			const std::vector<Bounds> &primitiveBounds;
+			std::vector<glm::vec3> centroids;
+			std::vector<uint32_t> &primitives;
+			std::vector<BuildNode> nodes;
+			std::atomic<uint32_t> nodeCount;
+			JobSystem::Counter counter;
+		};
+
+		uint32_t getBin(float centroid, float boundsMin, float scale, uint32_t binCount)
+		{
+			uint32_t bin = static_cast<uint32_t>((centroid - boundsMin) * scale);
+			return std::min(bin, binCount - 1);
+		}
+
+		//cost of every bin boundary on every axis, relative to the cost of intersecting one primitive
+		Split findBestSplit(const BuildContext &context, uint32_t begin, uint32_t end, const Bounds &centroidBounds, float nodeArea)
+		{
+			const BuildSettings &settings = context.settings;
+			const uint32_t binCount = settings.binCount;
+			Split best = Split{ .axis = 0, .bin = 0, .cost = std::numeric_limits<float>::infinity() };
+
+			std::vector<Bin> bins = std::vector<Bin>(binCount);
+			std::vector<float> leftAreas = std::vector<float>(binCount);
+			std::vector<uint32_t> leftCounts = std::vector<uint32_t>(binCount);
+
+			for (glm::length_t axis = 0; axis < 3; axis++)
+			{
+				const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+				if (extent <= .0f) continue;
+				const float scale = static_cast<float>(binCount) / extent;
+
+				std::fill(bins.begin(), bins.end(), Bin{});
+				for (uint32_t i = begin; i < end; i++)
+				{
+					uint32_t primitive = context.primitives[i];
+					Bin &bin = bins[getBin(context.centroids[primitive][axis], centroidBounds.min[axis], scale, binCount)];
+					bin.bounds.grow(context.primitiveBounds[primitive]);
+					bin.count++;
+				}
+
+				Bounds left = {};
+				uint32_t leftCount = 0;
+				for (uint32_t bin = 0; bin < binCount - 1; bin++)
+				{
+					left.grow(bins[bin].bounds);
+					leftCount += bins[bin].count;
+					leftAreas[bin] = left.getSurfaceArea();
+					leftCounts[bin] = leftCount;
+				}
+
+				Bounds right = {};
+				uint32_t rightCount = 0;
+				for (uint32_t bin = binCount - 1; bin > 0; bin--)
+				{
+					right.grow(bins[bin].bounds);
+					rightCount += bins[bin].count;
+					if (leftCounts[bin - 1] == 0 || rightCount == 0) continue;
+
+					float cost = settings.traversalCost + settings.intersectionCost
+						* (leftAreas[bin - 1] * static_cast<float>(leftCounts[bin - 1]) + right.getSurfaceArea() * static_cast<float>(rightCount)) / nodeArea;
+					if (cost < best.cost)
+					{
+						best = Split{ .axis = axis, .bin = bin, .cost = cost };
+					}
+				}
+			}
+
+			return best;
+		}
+
+		void buildNode(BuildContext &context, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth)
+		{
+			const BuildSettings &settings = context.settings;
+			const uint32_t count = end - begin;
+
+			Bounds bounds = {};
+			Bounds centroidBounds = {};
+			for (uint32_t i = begin; i < end; i++)
+			{
+				uint32_t primitive = context.primitives[i];
+				bounds.grow(context.primitiveBounds[primitive]);
+				centroidBounds.grow(context.centroids[primitive]);
+			}
+
+			BuildNode &node = context.nodes[nodeIndex];
+			node.bounds = bounds;
+			node.begin = begin;
+			node.primitiveCount = count;
+
+			if (count <= settings.maxLeafSize || depth + 1 >= maxDepth) return;
+
+			const float nodeArea = bounds.getSurfaceArea();
+			Split split = findBestSplit(context, begin, end, centroidBounds, nodeArea > .0f ? nodeArea : 1.0f);
+
+			const float leafCost = settings.intersectionCost * static_cast<float>(count);
+			if (split.cost >= leafCost && count <= settings.maxLeafSizeAboveCost) return;
+
+			uint32_t middle = begin + count / 2;
+			if (split.cost != std::numeric_limits<float>::infinity())
+			{
+				const float scale = static_cast<float>(settings.binCount) / (centroidBounds.max[split.axis] - centroidBounds.min[split.axis]);
+				auto first = context.primitives.begin();
+				middle = static_cast<uint32_t>(std::partition(first + begin, first + end, [&](uint32_t primitive)
+				{
+					return getBin(context.centroids[primitive][split.axis], centroidBounds.min[split.axis], scale, settings.binCount) < split.bin;
+				}) - first);
+			}
+			//all centroids coincide or rounding emptied a side, fall back to a median split
+			if (middle == begin || middle == end)
+			{
+				middle = begin + count / 2;
+			}
+
+			const uint32_t left = context.nodeCount.fetch_add(2);
+			const uint32_t right = left + 1;
+			node.children[0] = left;
+			node.children[1] = right;
+			node.primitiveCount = 0;
+
+			if (count >= settings.parallelThreshold)
+			{
+				context.jobs.run(context.counter, [&context, left, begin, middle, depth]()
+				{
+					buildNode(context, left, begin, middle, depth + 1);
+				});
+			}
+			else
+			{
+				buildNode(context, left, begin, middle, depth + 1);
+			}
+			buildNode(context, right, middle, end, depth + 1);
+		}
+
+		//depth-first layout, accumulating the statistics on the way
+		uint32_t flatten(const std::vector<BuildNode> &buildNodes, uint32_t buildIndex, uint32_t depth, float rootArea, const BuildSettings &settings, Hierarchy &hierarchy)
+		{
+			const BuildNode &buildNode = buildNodes[buildIndex];
+			const uint32_t index = static_cast<uint32_t>(hierarchy.nodes.size());
+			hierarchy.nodes.push_back(Node
+			{
+				.boundsMin = buildNode.bounds.min,
+				.offset = buildNode.begin,
+				.boundsMax = buildNode.bounds.max,
+				.primitiveCount = buildNode.primitiveCount
+			});
+
+			Statistics &statistics = hierarchy.statistics;
+			const float relativeArea = buildNode.bounds.getSurfaceArea() / rootArea;
+			statistics.depth = std::max(statistics.depth, depth + 1);
+
+			if (buildNode.primitiveCount > 0)
+			{
+				statistics.leafCount++;
+				statistics.sahCost += relativeArea * settings.intersectionCost * static_cast<float>(buildNode.primitiveCount);
+				return index;
+			}
+
+			statistics.sahCost += relativeArea * settings.traversalCost;
+			flatten(buildNodes, buildNode.children[0], depth + 1, rootArea, settings, hierarchy);
+			hierarchy.nodes[index].offset = flatten(buildNodes, buildNode.children[1], depth + 1, rootArea, settings, hierarchy);
+			return index;
+		}
+	}
+
+	Hierarchy build(JobSystem &jobs, const std::vector<Bounds> &primitiveBounds, const BuildSettings &settings)
+	{
+		assert(settings.binCount >= 2 && settings.maxLeafSize >= 1);
+		Stopwatch stopwatch = Stopwatch();
+
+		Hierarchy hierarchy = {};
+		hierarchy.statistics = {};
+		const uint32_t primitiveCount = static_cast<uint32_t>(primitiveBounds.size());
+		if (primitiveCount == 0) return hierarchy;
+
+		hierarchy.primitives.resize(primitiveCount);
+		BuildContext context =
+		{
+			.jobs = jobs,
+			.settings = settings,
+			.primitiveBounds = primitiveBounds,
+			.centroids = std::vector<glm::vec3>(primitiveCount),
+			.primitives = hierarchy.primitives,
+			.nodes = std::vector<BuildNode>(static_cast<size_t>(primitiveCount) * 2 - 1),
+			.nodeCount = 1,
+			.counter = {}
+		};
+
+		jobs.parallelFor(primitiveCount, settings.parallelThreshold, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+			{
+				context.centroids[i] = primitiveBounds[i].getCentroid();
+				context.primitives[i] = i;
+			}
+		});
+
+		buildNode(context, 0, 0, primitiveCount, 0);
+		jobs.wait(context.counter);
+
+		const uint32_t nodeCount = context.nodeCount;
+		hierarchy.nodes.reserve(nodeCount);
+		const float rootArea = context.nodes[0].bounds.getSurfaceArea();
+		flatten(context.nodes, 0, 0, rootArea > .0f ? rootArea : 1.0f, settings, hierarchy);
+
+		hierarchy.statistics.nodeCount = nodeCount;
+		hierarchy.statistics.buildMilliseconds = stopwatch.elapsedMilliseconds();
+		return hierarchy;
+	}
+
+	Hierarchy buildTriangles(JobSystem &jobs, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const BuildSettings &settings)
+	{
+		assert(indices.size() % 3 == 0);
+		Stopwatch stopwatch = Stopwatch();
+
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		std::vector<Bounds> triangleBounds = std::vector<Bounds>(triangleCount);
+		jobs.parallelFor(triangleCount, settings.parallelThreshold, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t triangle = begin; triangle < end; triangle++)
+			{
+				Bounds &bounds = triangleBounds[triangle];
+				bounds.grow(positions[indices[triangle * 3]]);
+				bounds.grow(positions[indices[triangle * 3 + 1]]);
+				bounds.grow(positions[indices[triangle * 3 + 2]]);
+			}
+		});
+
+		Hierarchy hierarchy = build(jobs, triangleBounds, settings);
+		hierarchy.statistics.buildMilliseconds = stopwatch.elapsedMilliseconds();
+		return hierarchy;
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include "glm.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+class JobSystem;
+
+//bounding volume hierarchies built on the host with binned SAH
+//they back the CPU renderer, picking, culling and the analysis of what the driver builds
+namespace bvh
+{
+	constexpr uint32_t maxDepth = 64;
+
+	struct Bounds
+	{
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+		void grow(const glm::vec3 &point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void grow(const Bounds &bounds)
+		{
+			min = glm::min(min, bounds.min);
+			max = glm::max(max, bounds.max);
+		}
+
+		bool isEmpty() const { return min.x > max.x; }
+		glm::vec3 getCentroid() const { return (min + max) * .5f; }
+
+		float getSurfaceArea() const
+		{
+			if (isEmpty()) return .0f;
+			glm::vec3 extent = max - min;
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+	};
+
+	//nodes are stored depth-first : the first child of an interior node directly follows it
+	struct Node
+	{
+		glm::vec3 boundsMin;
+		//leaf : first entry in Hierarchy::primitives, interior : index of the second child
+		uint32_t offset;
+		glm::vec3 boundsMax;
+		//zero for interior nodes
+		uint32_t primitiveCount;
+
+		bool isLeaf() const { return primitiveCount > 0; }
+	};
+	static_assert(sizeof(Node) == 32, "two nodes per cache line");
+
+	struct BuildSettings
+	{
+		uint32_t binCount = 16;
+		uint32_t maxLeafSize = 4;
+		//leaves may grow up to this size when splitting costs more than intersecting everything
+		uint32_t maxLeafSizeAboveCost = 16;
+		//ranges smaller than this are built on the thread that split them
+		uint32_t parallelThreshold = 4096;
+		float traversalCost = 1.0f;
+		float intersectionCost = 1.0f;
+	};
+
+	struct Statistics
+	{
+		uint32_t nodeCount;
+		uint32_t leafCount;
+		uint32_t depth;
+		//expected cost of a random ray hitting the root, relative to one primitive intersection
+		float sahCost;
+		double buildMilliseconds;
+	};
+
+	struct Hierarchy
+	{
+		std::vector<Node> nodes;
+		//primitive indices, referenced by the leaves
+		std::vector<uint32_t> primitives;
+		Statistics statistics;
+	};
+
+	//primitives are only known through their bounds
+	[[nodiscard]]
+	Hierarchy build(JobSystem &jobs, const std::vector<Bounds> &primitiveBounds, const BuildSettings &settings = {});
+
+	//indexed triangle list, primitive i is made of indices 3i, 3i + 1 and 3i + 2
+	[[nodiscard]]
+	Hierarchy buildTriangles(JobSystem &jobs, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const BuildSettings &settings = {});
+
+	//entry distance of the ray into the node, infinity if it misses it within [tMin, tMax]
+	inline float intersectNode(const Node &node, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float tMin, float tMax)
+	{
+		glm::vec3 t0 = (node.boundsMin - origin) * inverseDirection;
+		glm::vec3 t1 = (node.boundsMax - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+
+		float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+		return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+	}
+
+	//visits the leaves the ray reaches, nearest child first
+	//intersectPrimitive(primitive, tMax) returns whether it hit and shrinks tMax to the hit distance
+	template<typename IntersectPrimitive>
+	bool traverse(const Hierarchy &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, IntersectPrimitive &&intersectPrimitive)
+	{
+		constexpr float miss = std::numeric_limits<float>::infinity();
+		if (hierarchy.nodes.empty()) return false;
+
+		const glm::vec3 inverseDirection = 1.0f / direction;
+		const std::vector<Node> &nodes = hierarchy.nodes;
+		if (intersectNode(nodes[0], origin, inverseDirection, tMin, tMax) == miss) return false;
+
+		uint32_t stack[maxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		bool hit = false;
+
+		while (true)
+		{
+			const Node &node = nodes[nodeIndex];
+			if (node.isLeaf())
+			{
+				for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; i++)
+				{
+					if (intersectPrimitive(hierarchy.primitives[i], tMax)) hit = true;
+				}
+
+				if (stackSize == 0) break;
+				nodeIndex = stack[--stackSize];
+				continue;
+			}
+
+			uint32_t nearChild = nodeIndex + 1;
+			uint32_t farChild = node.offset;
+			float nearDistance = intersectNode(nodes[nearChild], origin, inverseDirection, tMin, tMax);
+			float farDistance = intersectNode(nodes[farChild], origin, inverseDirection, tMin, tMax);
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+
+			if (nearDistance == miss)
+			{
+				if (stackSize == 0) break;
+				nodeIndex = stack[--stackSize];
+				continue;
+			}
+
+			nodeIndex = nearChild;
+			if (farDistance != miss) stack[stackSize++] = farChild;
+		}
+
+		return hit;
+	}
+}
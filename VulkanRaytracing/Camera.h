@@ -0,0 +1,36 @@
+#pragma once
+#include "glm.hpp"
+#include "gtc/matrix_transform.hpp"
+
+//matches the camera uniform block in raytrace.rgen
+struct CameraData
+{
+	glm::mat4 viewInverse;
+	glm::mat4 projectionInverse;
+	glm::mat4 viewProjection;
+	//of the previous frame, getData leaves the camera where it is
+	glm::mat4 previousViewProjection;
+};
+
+//looks down -z
+struct Camera
+{
+	glm::vec3 position;
+	float verticalFieldOfView;
+
+	CameraData getData(float aspectRatio) const
+	{
+		glm::mat4 view = glm::lookAt(position, position + glm::vec3(.0f, .0f, -1.0f), glm::vec3(.0f, 1.0f, .0f));
+		glm::mat4 projection = glm::perspective(glm::radians(verticalFieldOfView), aspectRatio, .1f, 1000.0f);
+		//vulkan clip space has y pointing down
+		projection[1][1] *= -1.0f;
+
+		return CameraData
+		{
+			.viewInverse = glm::inverse(view),
+			.projectionInverse = glm::inverse(projection),
+			.viewProjection = projection * view,
+			.previousViewProjection = projection * view
+		};
+	}
+};
@@ -0,0 +1,545 @@
+#include "CpuRaytracer.h"
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <bit>
+#include <emmintrin.h>
+#include "Files.h"
+#include "Logger/Logger.h"
+
+namespace {
+
+	glm::mat4 toMat4(const VkTransformMatrixKHR &transform)
+	{
+		glm::mat4 matrix = glm::mat4(1.0f);
+		for (glm::length_t row = 0; row < 3; row++)
+		{
+			for (glm::length_t column = 0; column < 4; column++)
+			{
+				matrix[column][row] = transform.matrix[row][column];
+			}
+		}
+		return matrix;
+	}
+
+	//Moller-Trumbore, double sided
+	bool intersectTriangle(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2, float &t, glm::vec2 &barycentrics)
+	{
+		glm::vec3 edge1 = v1 - v0;
+		glm::vec3 edge2 = v2 - v0;
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+		if (std::abs(determinant) < 1e-12f) return false;
+
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 s = origin - v0;
+		float u = glm::dot(s, p) * inverseDeterminant;
+		if (u < .0f || u > 1.0f) return false;
+
+		glm::vec3 q = glm::cross(s, edge1);
+		float v = glm::dot(direction, q) * inverseDeterminant;
+		if (v < .0f || u + v > 1.0f) return false;
+
+		t = glm::dot(edge2, q) * inverseDeterminant;
+		barycentrics = glm::vec2(u, v);
+		return true;
+	}
+
+	//Moller-Trumbore of one triangle against the rays of rayMask, four at a time with SSE2
+	//returns one bit per ray that hits within its interval, t, u and v are written for the groups of four tested
+	template<uint32_t Size>
+	uint32_t intersectTriangle(const bvh::RayPacket<Size> &packet, uint32_t rayMask, const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2, float *t, float *u, float *v)
+	{
+		const glm::vec3 edge1 = v1 - v0;
+		const glm::vec3 edge2 = v2 - v0;
+		const __m128 e1[3] = { _mm_set1_ps(edge1.x), _mm_set1_ps(edge1.y), _mm_set1_ps(edge1.z) };
+		const __m128 e2[3] = { _mm_set1_ps(edge2.x), _mm_set1_ps(edge2.y), _mm_set1_ps(edge2.z) };
+		const __m128 vertex[3] = { _mm_set1_ps(v0.x), _mm_set1_ps(v0.y), _mm_set1_ps(v0.z) };
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		uint32_t mask = 0;
+		for (uint32_t laneGroup = 0; laneGroup < Size / 4; laneGroup++)
+		{
+			if (bvh::getLaneGroupMask(rayMask, laneGroup) == 0) continue;
+
+			const uint32_t firstRay = laneGroup * 4;
+			const __m128 dx = _mm_load_ps(&packet.direction[0][firstRay]);
+			const __m128 dy = _mm_load_ps(&packet.direction[1][firstRay]);
+			const __m128 dz = _mm_load_ps(&packet.direction[2][firstRay]);
+
+			//p = cross(direction, edge2)
+			const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2[2]), _mm_mul_ps(dz, e2[1]));
+			const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2[0]), _mm_mul_ps(dx, e2[2]));
+			const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2[1]), _mm_mul_ps(dy, e2[0]));
+			const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1[0], px), _mm_mul_ps(e1[1], py)), _mm_mul_ps(e1[2], pz));
+			const __m128 inverseDeterminant = _mm_div_ps(one, determinant);
+
+			const __m128 sx = _mm_sub_ps(_mm_load_ps(&packet.origin[0][firstRay]), vertex[0]);
+			const __m128 sy = _mm_sub_ps(_mm_load_ps(&packet.origin[1][firstRay]), vertex[1]);
+			const __m128 sz = _mm_sub_ps(_mm_load_ps(&packet.origin[2][firstRay]), vertex[2]);
+			const __m128 rayU = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDeterminant);
+
+			//q = cross(s, edge1)
+			const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1[2]), _mm_mul_ps(sz, e1[1]));
+			const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1[0]), _mm_mul_ps(sx, e1[2]));
+			const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1[1]), _mm_mul_ps(sy, e1[0]));
+			const __m128 rayV = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDeterminant);
+			const __m128 rayT = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2[0], qx), _mm_mul_ps(e2[1], qy)), _mm_mul_ps(e2[2], qz)), inverseDeterminant);
+
+			__m128 valid = _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-.0f), determinant), _mm_set1_ps(1e-12f));
+			valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(rayU, zero), _mm_cmple_ps(rayU, one)));
+			valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(rayV, zero), _mm_cmple_ps(_mm_add_ps(rayU, rayV), one)));
+			valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(rayT, _mm_set1_ps(packet.tMin)), _mm_cmple_ps(rayT, _mm_load_ps(&packet.tMax[firstRay]))));
+
+			_mm_store_ps(&t[firstRay], rayT);
+			_mm_store_ps(&u[firstRay], rayU);
+			_mm_store_ps(&v[firstRay], rayV);
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(valid)) << firstRay;
+		}
+
+		return mask & rayMask;
+	}
+
+	//spreads the lower 10 bits of value two bits apart
+	uint32_t expandBits(uint32_t value)
+	{
+		value = (value | (value << 16)) & 0x030000FF;
+		value = (value | (value << 8)) & 0x0300F00F;
+		value = (value | (value << 4)) & 0x030C30C3;
+		value = (value | (value << 2)) & 0x09249249;
+		return value;
+	}
+
+	uint8_t toUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::lround(std::clamp(value, .0f, 1.0f) * 255.0f));
+	}
+}
+
+CpuRaytracer::CpuRaytracer(const Scene &scene, JobSystem &givenJobs, bvh::SimdLevel givenSimdLevel) : 
+	materials(scene.getMaterials()), 
+	jobs(givenJobs), 
+	builtSimdLevel(givenSimdLevel), 
+	simdLevel(givenSimdLevel)
+{
+	const std::vector<Scene::Mesh> &sceneMeshes = scene.getMeshes();
+	meshes.resize(sceneMeshes.size());
+	for (size_t i = 0; i < sceneMeshes.size(); i++)
+	{
+		MeshData &mesh = meshes[i];
+		const std::vector<float> &vertices = sceneMeshes[i].vertices;
+
+		mesh.indices = sceneMeshes[i].indices;
+		mesh.positions.resize(vertices.size() / 3);
+		for (size_t vertex = 0; vertex < mesh.positions.size(); vertex++)
+		{
+			mesh.positions[vertex] = glm::vec3(vertices[vertex * 3], vertices[vertex * 3 + 1], vertices[vertex * 3 + 2]);
+		}
+
+		mesh.hierarchy = bvh::buildTriangles(jobs, mesh.positions, mesh.indices);
+		mesh.wideMesh = bvh::createWideMesh(mesh.hierarchy, mesh.positions, mesh.indices, builtSimdLevel);
+		const bvh::Statistics &statistics = mesh.hierarchy.statistics;
+		LOG_TRIVIAL_FORMATTED(
+			"Built BVH for mesh %u : %u triangles, %u nodes, %u leaves, depth %u, SAH cost %.2f in %.3f ms! ",
+			static_cast<uint32_t>(i),
+			static_cast<uint32_t>(mesh.indices.size() / 3),
+			statistics.nodeCount,
+			statistics.leafCount,
+			statistics.depth,
+			statistics.sahCost,
+			statistics.buildMilliseconds);
+	}
+
+	const Scene::InstanceTable &table = scene.getInstances();
+	instances.resize(table.size());
+	std::vector<bvh::Bounds> instanceBounds = std::vector<bvh::Bounds>(table.size());
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		InstanceData &instance = instances[i];
+		const MeshData &mesh = meshes[table.meshes[i]];
+		glm::mat4 objectToWorld = toMat4(table.transforms[i]);
+
+		instance.worldToObject = glm::inverse(objectToWorld);
+		instance.mesh = table.meshes[i];
+		instance.material = table.customIndices[i];
+		instance.mask = table.masks[i];
+		assert(instance.material < materials.size());
+
+		if (mesh.hierarchy.nodes.empty()) continue;
+		const bvh::Node &root = mesh.hierarchy.nodes[0];
+		for (uint32_t corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 objectCorner = glm::vec3(
+				(corner & 1) ? root.boundsMax.x : root.boundsMin.x,
+				(corner & 2) ? root.boundsMax.y : root.boundsMin.y,
+				(corner & 4) ? root.boundsMax.z : root.boundsMin.z);
+			instanceBounds[i].grow(glm::vec3(objectToWorld * glm::vec4(objectCorner, 1.0f)));
+		}
+	}
+
+	//instances are few, leaves of one keep the culling exact
+	instanceHierarchy = bvh::build(jobs, instanceBounds, bvh::BuildSettings{ .maxLeafSize = 1, .maxLeafSizeAboveCost = 1 });
+}
+
+bvh::Bounds CpuRaytracer::getBounds() const
+{
+	if (instanceHierarchy.nodes.empty()) return bvh::Bounds{};
+	return bvh::Bounds{ .min = instanceHierarchy.nodes[0].boundsMin, .max = instanceHierarchy.nodes[0].boundsMax };
+}
+
+void CpuRaytracer::setSimdLevel(bvh::SimdLevel level)
+{
+	assert(level <= builtSimdLevel);
+	simdLevel = level;
+}
+
+void CpuRaytracer::generateRay(const CameraData &camera, uint32_t x, uint32_t y, uint32_t width, uint32_t height, glm::vec3 &origin, glm::vec3 &direction)
+{
+	glm::vec2 pixelCenter = glm::vec2(static_cast<float>(x), static_cast<float>(y)) + .5f;
+	glm::vec2 uv = pixelCenter / glm::vec2(static_cast<float>(width), static_cast<float>(height)) * 2.0f - 1.0f;
+
+	glm::vec4 target = camera.projectionInverse * glm::vec4(uv.x, uv.y, 1.0f, 1.0f);
+	origin = glm::vec3(camera.viewInverse * glm::vec4(.0f, .0f, .0f, 1.0f));
+	direction = glm::normalize(glm::vec3(camera.viewInverse * glm::vec4(glm::normalize(glm::vec3(target)), .0f)));
+}
+
+bool CpuRaytracer::intersect(const glm::vec3 &origin, const glm::vec3 &direction, Hit &hit) const
+{
+	hit.t = tMax;
+
+	return bvh::traverse(instanceHierarchy, origin, direction, tMin, hit.t, [&](uint32_t instanceIndex, float &instanceTMax)
+	{
+		const InstanceData &instance = instances[instanceIndex];
+		if ((instance.mask & cullMask) == 0) return false;
+
+		//the object space direction is not renormalized so that t stays comparable across instances
+		glm::vec3 objectOrigin = glm::vec3(instance.worldToObject * glm::vec4(origin, 1.0f));
+		glm::vec3 objectDirection = glm::vec3(instance.worldToObject * glm::vec4(direction, .0f));
+
+		const MeshData &mesh = meshes[instance.mesh];
+		if (simdLevel != bvh::SimdLevel::SCALAR)
+		{
+			bvh::TriangleHit triangleHit;
+			if (!bvh::intersect(mesh.wideMesh, simdLevel, objectOrigin, objectDirection, tMin, instanceTMax, triangleHit)) return false;
+
+			hit.instance = instanceIndex;
+			hit.primitive = triangleHit.primitive;
+			hit.barycentrics = triangleHit.barycentrics;
+			return true;
+		}
+
+		return bvh::traverse(mesh.hierarchy, objectOrigin, objectDirection, tMin, instanceTMax, [&](uint32_t primitive, float &primitiveTMax)
+		{
+			float t;
+			glm::vec2 barycentrics;
+			if (!intersectTriangle(
+				objectOrigin,
+				objectDirection,
+				mesh.positions[mesh.indices[primitive * 3]],
+				mesh.positions[mesh.indices[primitive * 3 + 1]],
+				mesh.positions[mesh.indices[primitive * 3 + 2]],
+				t,
+				barycentrics)
+				|| t < tMin || t > primitiveTMax)
+			{
+				return false;
+			}
+
+			primitiveTMax = t;
+			hit.instance = instanceIndex;
+			hit.primitive = primitive;
+			hit.barycentrics = barycentrics;
+			return true;
+		});
+	});
+}
+
+template<uint32_t Size, bool terminateOnHit>
+uint32_t CpuRaytracer::intersectPacket(bvh::RayPacket<Size> &packet, Hit *hits) const
+{
+	//below tMin, every remaining node and triangle test of the ray fails
+	constexpr float terminated = -std::numeric_limits<float>::infinity();
+	uint32_t hitMask = 0;
+
+	bvh::traversePacket(instanceHierarchy, packet, [&](uint32_t instanceIndex, uint32_t instanceRays)
+	{
+		const InstanceData &instance = instances[instanceIndex];
+		if ((instance.mask & cullMask) == 0) return;
+
+		//the rays that do not reach the instance are terminated so that they neither hit nor widen the frustum
+		bvh::RayPacket<Size> objectPacket;
+		objectPacket.tMin = packet.tMin;
+		for (uint32_t ray = 0; ray < Size; ray++)
+		{
+			glm::vec3 objectOrigin = glm::vec3(instance.worldToObject * glm::vec4(packet.getOrigin(ray), 1.0f));
+			glm::vec3 objectDirection = glm::vec3(instance.worldToObject * glm::vec4(packet.getDirection(ray), .0f));
+			objectPacket.setRay(ray, objectOrigin, objectDirection, (instanceRays >> ray & 1) ? packet.tMax[ray] : terminated);
+		}
+
+		const MeshData &mesh = meshes[instance.mesh];
+		bvh::traversePacket(mesh.hierarchy, objectPacket, [&](uint32_t primitive, uint32_t rayMask)
+		{
+			alignas(16) float t[Size], u[Size], v[Size];
+			uint32_t triangleHits = intersectTriangle(
+				objectPacket,
+				rayMask,
+				mesh.positions[mesh.indices[primitive * 3]],
+				mesh.positions[mesh.indices[primitive * 3 + 1]],
+				mesh.positions[mesh.indices[primitive * 3 + 2]],
+				t,
+				u,
+				v);
+			hitMask |= triangleHits;
+
+			while (triangleHits != 0)
+			{
+				const uint32_t ray = static_cast<uint32_t>(std::countr_zero(triangleHits));
+				triangleHits &= triangleHits - 1;
+				if constexpr (terminateOnHit)
+				{
+					objectPacket.tMax[ray] = terminated;
+				}
+				else
+				{
+					objectPacket.tMax[ray] = t[ray];
+					hits[ray] = Hit{ .t = t[ray], .instance = instanceIndex, .primitive = primitive, .barycentrics = glm::vec2(u[ray], v[ray]) };
+				}
+			}
+		});
+
+		while (instanceRays != 0)
+		{
+			const uint32_t ray = static_cast<uint32_t>(std::countr_zero(instanceRays));
+			instanceRays &= instanceRays - 1;
+			packet.tMax[ray] = objectPacket.tMax[ray];
+		}
+	});
+
+	return hitMask;
+}
+
+template<uint32_t Size>
+void CpuRaytracer::intersect(const glm::vec3 *origins, const glm::vec3 *directions, Hit *hits) const
+{
+	bvh::RayPacket<Size> packet;
+	packet.tMin = tMin;
+	for (uint32_t ray = 0; ray < Size; ray++)
+	{
+		packet.setRay(ray, origins[ray], directions[ray], tMax);
+		hits[ray].t = tMax;
+		hits[ray].instance = missed;
+	}
+
+	intersectPacket<Size, false>(packet, hits);
+}
+
+bool CpuRaytracer::occluded(const glm::vec3 &origin, const glm::vec3 &direction, float distance) const
+{
+	constexpr float terminated = -std::numeric_limits<float>::infinity();
+	float rayTMax = distance;
+
+	return bvh::traverse(instanceHierarchy, origin, direction, tMin, rayTMax, [&](uint32_t instanceIndex, float &instanceTMax)
+	{
+		const InstanceData &instance = instances[instanceIndex];
+		if ((instance.mask & cullMask) == 0 || instanceTMax < tMin) return false;
+
+		glm::vec3 objectOrigin = glm::vec3(instance.worldToObject * glm::vec4(origin, 1.0f));
+		glm::vec3 objectDirection = glm::vec3(instance.worldToObject * glm::vec4(direction, .0f));
+
+		const MeshData &mesh = meshes[instance.mesh];
+		return bvh::traverse(mesh.hierarchy, objectOrigin, objectDirection, tMin, instanceTMax, [&](uint32_t primitive, float &primitiveTMax)
+		{
+			//leaves already on the stack are still visited once the ray is terminated
+			if (primitiveTMax < tMin) return false;
+
+			float t;
+			glm::vec2 barycentrics;
+			if (!intersectTriangle(
+				objectOrigin,
+				objectDirection,
+				mesh.positions[mesh.indices[primitive * 3]],
+				mesh.positions[mesh.indices[primitive * 3 + 1]],
+				mesh.positions[mesh.indices[primitive * 3 + 2]],
+				t,
+				barycentrics)
+				|| t < tMin || t > primitiveTMax)
+			{
+				return false;
+			}
+
+			primitiveTMax = terminated;
+			return true;
+		});
+	});
+}
+
+template<uint32_t Size>
+uint32_t CpuRaytracer::occluded(const glm::vec3 *origins, const glm::vec3 *directions, const float *distances) const
+{
+	bvh::RayPacket<Size> packet;
+	packet.tMin = tMin;
+	for (uint32_t ray = 0; ray < Size; ray++)
+	{
+		packet.setRay(ray, origins[ray], directions[ray], distances[ray]);
+	}
+
+	return intersectPacket<Size, true>(packet, nullptr);
+}
+
+template<uint32_t Size>
+void CpuRaytracer::intersectStream(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions, std::vector<Hit> &hits) const
+{
+	assert(origins.size() == directions.size() && origins.size() <= std::numeric_limits<uint32_t>::max());
+	const size_t rayCount = origins.size();
+	hits.resize(rayCount);
+	if (rayCount == 0) return;
+
+	//octant in the upper bits, the Morton code of the origin on a 512^3 grid over the scene bounds below, the ray index in the lower half
+	const bvh::Bounds bounds = getBounds();
+	const glm::vec3 extent = glm::max(bounds.max - bounds.min, glm::vec3(1e-6f));
+	std::vector<uint64_t> keys = std::vector<uint64_t>(rayCount);
+	for (size_t i = 0; i < rayCount; i++)
+	{
+		const glm::vec3 &direction = directions[i];
+		const uint64_t octant = (direction.x < .0f ? 1U : 0U) | (direction.y < .0f ? 2U : 0U) | (direction.z < .0f ? 4U : 0U);
+		const glm::vec3 cell = glm::clamp((origins[i] - bounds.min) / extent, glm::vec3(.0f), glm::vec3(1.0f)) * 511.0f;
+		const uint64_t morton = 
+			(expandBits(static_cast<uint32_t>(cell.x)) << 2) | 
+			(expandBits(static_cast<uint32_t>(cell.y)) << 1) | 
+			expandBits(static_cast<uint32_t>(cell.z));
+		keys[i] = ((octant << 27 | morton) << 32) | static_cast<uint64_t>(i);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	uint32_t packetRays[Size];
+	glm::vec3 packetOrigins[Size], packetDirections[Size];
+	Hit packetHits[Size];
+	for (size_t first = 0; first < rayCount; first += Size)
+	{
+		//the last packet is padded with copies of its last ray, their hits are dropped
+		const uint32_t count = static_cast<uint32_t>(std::min<size_t>(Size, rayCount - first));
+		for (uint32_t ray = 0; ray < Size; ray++)
+		{
+			packetRays[ray] = static_cast<uint32_t>(keys[first + std::min(ray, count - 1)]);
+			packetOrigins[ray] = origins[packetRays[ray]];
+			packetDirections[ray] = directions[packetRays[ray]];
+		}
+
+		intersect<Size>(packetOrigins, packetDirections, packetHits);
+		for (uint32_t ray = 0; ray < count; ray++)
+		{
+			hits[packetRays[ray]] = packetHits[ray];
+		}
+	}
+}
+
+template void CpuRaytracer::intersect<8>(const glm::vec3 *origins, const glm::vec3 *directions, Hit *hits) const;
+template void CpuRaytracer::intersect<16>(const glm::vec3 *origins, const glm::vec3 *directions, Hit *hits) const;
+template uint32_t CpuRaytracer::occluded<8>(const glm::vec3 *origins, const glm::vec3 *directions, const float *distances) const;
+template uint32_t CpuRaytracer::occluded<16>(const glm::vec3 *origins, const glm::vec3 *directions, const float *distances) const;
+template void CpuRaytracer::intersectStream<8>(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions, std::vector<Hit> &hits) const;
+template void CpuRaytracer::intersectStream<16>(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions, std::vector<Hit> &hits) const;
+
+glm::vec3 CpuRaytracer::trace(const glm::vec3 &origin, const glm::vec3 &direction) const
+{
+	Hit hit;
+	if (intersect(origin, direction, hit))
+	{
+		//raytrace.rchit
+		return glm::vec3(materials[instances[hit.instance].material].albedo);
+	}
+
+	//raytrace.rmiss
+	return glm::vec3(.0f);
+}
+
+std::vector<uint8_t> CpuRaytracer::render(const CameraData &camera, uint32_t width, uint32_t height, uint32_t tileSize) const
+{
+	std::vector<uint8_t> pixels = std::vector<uint8_t>(static_cast<size_t>(width) * height * 4);
+
+	const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+	const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+	const uint32_t tileCount = tilesX * tilesY;
+
+	jobs.parallelFor(tileCount, 1, [&](uint32_t firstTile, uint32_t lastTile)
+	{
+		for (uint32_t tile = firstTile; tile < lastTile; tile++)
+		{
+			const uint32_t beginX = (tile % tilesX) * tileSize;
+			const uint32_t beginY = (tile / tilesX) * tileSize;
+			const uint32_t endX = std::min(beginX + tileSize, width);
+			const uint32_t endY = std::min(beginY + tileSize, height);
+
+			for (uint32_t y = beginY; y < endY; y++)
+			{
+				for (uint32_t x = beginX; x < endX; x++)
+				{
+					glm::vec3 origin, direction;
+					generateRay(camera, x, y, width, height, origin, direction);
+					glm::vec3 payload = trace(origin, direction);
+
+					//imageStore(image, ivec2(gl_LaunchIDEXT), vec4(payload, .0))
+					uint8_t *pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+					pixel[0] = toUnorm8(payload.r);
+					pixel[1] = toUnorm8(payload.g);
+					pixel[2] = toUnorm8(payload.b);
+					pixel[3] = 0;
+				}
+			}
+		}
+	});
+
+	return pixels;
+}
+
+ImageComparison compareImages(const std::vector<uint8_t> &reference, const std::vector<uint8_t> &image, uint32_t width, uint32_t height, uint8_t mismatchThreshold)
+{
+	assert(reference.size() == image.size() && reference.size() == static_cast<size_t>(width) * height * 4);
+
+	double squaredErrorSum = .0;
+	int maxDifference = 0;
+	size_t mismatchedPixels = 0;
+	const size_t pixelCount = static_cast<size_t>(width) * height;
+
+	for (size_t pixel = 0; pixel < pixelCount; pixel++)
+	{
+		int pixelMaxDifference = 0;
+		for (size_t channel = 0; channel < 3; channel++)
+		{
+			int difference = std::abs(static_cast<int>(reference[pixel * 4 + channel]) - static_cast<int>(image[pixel * 4 + channel]));
+			squaredErrorSum += static_cast<double>(difference * difference);
+			pixelMaxDifference = std::max(pixelMaxDifference, difference);
+		}
+		maxDifference = std::max(maxDifference, pixelMaxDifference);
+		if (pixelMaxDifference > mismatchThreshold) mismatchedPixels++;
+	}
+
+	const double meanSquaredError = squaredErrorSum / (static_cast<double>(pixelCount) * 3.0 * 255.0 * 255.0);
+
+	return ImageComparison
+	{
+		.rmse = std::sqrt(meanSquaredError),
+		.psnr = meanSquaredError > .0 ? -10.0 * std::log10(meanSquaredError) : std::numeric_limits<double>::infinity(),
+		.maxError = static_cast<double>(maxDifference) / 255.0,
+		.mismatchedPixelRatio = static_cast<double>(mismatchedPixels) / static_cast<double>(pixelCount)
+	};
+}
+
+bool writePpm(const char *path, const std::vector<uint8_t> &pixels, uint32_t width, uint32_t height)
+{
+	std::string ppm = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+	const size_t headerSize = ppm.size();
+	const size_t pixelCount = static_cast<size_t>(width) * height;
+	ppm.resize(headerSize + pixelCount * 3);
+	for (size_t pixel = 0; pixel < pixelCount; pixel++)
+	{
+		ppm[headerSize + pixel * 3] = static_cast<char>(pixels[pixel * 4]);
+		ppm[headerSize + pixel * 3 + 1] = static_cast<char>(pixels[pixel * 4 + 1]);
+		ppm[headerSize + pixel * 3 + 2] = static_cast<char>(pixels[pixel * 4 + 2]);
+	}
+
+	FileWriter writer = FileWriter(std::string(path));
+	return writer.write(ppm.data(), ppm.size());
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Scene.h"
+#include "Camera.h"
+#include "Bvh.h"
+#include "WideBvh.h"
+#include "RayPacket.h"
+#include "JobSystem.h"
+#include <vector>
+
+//software renderer mirroring raytrace.rgen, raytrace.rchit and raytrace.rmiss on the same scene description
+//serves as a reference for the GPU output and as a fallback on devices without ray tracing support
+class CpuRaytracer
+{
+public:
+
+	//the constants the shaders use
+	static constexpr float tMin = .0001f;
+	static constexpr float tMax = 10000.0f;
+	static constexpr uint8_t cullMask = 0xFF;
+	//instance of the hits of rays that missed, for the packet and stream queries
+	static constexpr uint32_t missed = std::numeric_limits<uint32_t>::max();
+
+	struct Hit
+	{
+		float t;
+		uint32_t instance;
+		uint32_t primitive;
+		glm::vec2 barycentrics;
+	};
+
+	//builds one BVH per mesh and one over the instances
+	//meshes are also collapsed into the wide layouts of every SIMD level up to simdLevel
+	CpuRaytracer(const Scene &scene, JobSystem &jobs, bvh::SimdLevel simdLevel = bvh::getSupportedSimdLevel());
+
+	//same ray as getUV and computeDir in raytrace.rgen
+	static void generateRay(const CameraData &camera, uint32_t x, uint32_t y, uint32_t width, uint32_t height, glm::vec3 &origin, glm::vec3 &direction);
+
+	//closest hit within [tMin, tMax], triangles are never culled since the shaders trace without cull flags
+	bool intersect(const glm::vec3 &origin, const glm::vec3 &direction, Hit &hit) const;
+
+	//Size rays traced together through the binary hierarchies, they should be coherent for the frustum culling to pay off
+	//hits[i].instance is missed for the rays that hit nothing
+	template<uint32_t Size>
+	void intersect(const glm::vec3 *origins, const glm::vec3 *directions, Hit *hits) const;
+
+	//any hit within [tMin, distance], stops at the first one found
+	bool occluded(const glm::vec3 &origin, const glm::vec3 &direction, float distance) const;
+
+	//one bit per blocked ray, for shadow rays sharing an origin or a light
+	template<uint32_t Size>
+	uint32_t occluded(const glm::vec3 *origins, const glm::vec3 *directions, const float *distances) const;
+
+	//secondary rays are too incoherent to be packed as they come
+	//they are sorted by direction octant then by origin along a Morton curve and traced in packets of Size, hits keep the order of the rays
+	template<uint32_t Size>
+	void intersectStream(const std::vector<glm::vec3> &origins, const std::vector<glm::vec3> &directions, std::vector<Hit> &hits) const;
+
+	//payload written by the closest hit or miss shader
+	glm::vec3 trace(const glm::vec3 &origin, const glm::vec3 &direction) const;
+
+	//tiles are distributed over the workers of the job system
+	//pixels are RGBA8, quantized the way imageStore writes them to a UNORM image
+	[[nodiscard]]
+	std::vector<uint8_t> render(const CameraData &camera, uint32_t width, uint32_t height, uint32_t tileSize = 16) const;
+
+	const bvh::Statistics &getMeshStatistics(Scene::MeshHandle mesh) const { return meshes[mesh].hierarchy.statistics; }
+	const bvh::Statistics &getInstanceStatistics() const { return instanceHierarchy.statistics; }
+	bvh::Bounds getBounds() const;
+
+	//any level up to the one given at construction
+	void setSimdLevel(bvh::SimdLevel level);
+	bvh::SimdLevel getSimdLevel() const { return simdLevel; }
+
+private:
+
+	//closest hit, or any hit when terminateOnHit is set, returns one bit per ray that hit
+	template<uint32_t Size, bool terminateOnHit>
+	uint32_t intersectPacket(bvh::RayPacket<Size> &packet, Hit *hits) const;
+
+	struct MeshData
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> indices;
+		bvh::Hierarchy hierarchy;
+		bvh::WideMesh wideMesh;
+	};
+
+	struct InstanceData
+	{
+		glm::mat4 worldToObject;
+		uint32_t mesh;
+		uint32_t material;
+		uint8_t mask;
+	};
+
+	std::vector<MeshData> meshes;
+	std::vector<InstanceData> instances;
+	bvh::Hierarchy instanceHierarchy;
+	std::vector<Scene::Material> materials;
+	JobSystem &jobs;
+	bvh::SimdLevel builtSimdLevel;
+	bvh::SimdLevel simdLevel;
+};
+
+//errors are measured per channel in [0, 1], alpha is ignored
+struct ImageComparison
+{
+	double rmse;
+	double psnr;
+	double maxError;
+	//pixels where any channel differs by more than the mismatch threshold
+	double mismatchedPixelRatio;
+};
+
+[[nodiscard]]
+ImageComparison compareImages(const std::vector<uint8_t> &reference, const std::vector<uint8_t> &image, uint32_t width, uint32_t height, uint8_t mismatchThreshold = 2);
+
+//binary PPM from RGBA8 pixels
+bool writePpm(const char *path, const std::vector<uint8_t> &pixels, uint32_t width, uint32_t height);
@@ -0,0 +1,277 @@
+#include "Denoiser.h"
+#include <assert.h>
+#include "Logger/Logger.h"
+
+namespace {
+
+	//match the push constant blocks in denoiseTemporal.comp, denoiseVariance.comp and denoiseFilter.comp
+	struct TemporalPushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t historyValid;
+		float colorAlpha;
+		float momentsAlpha;
+	};
+
+	struct VariancePushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		float phiNormal;
+		float phiDepth;
+	};
+
+	struct FilterPushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t stepSize;
+		uint32_t writeHistory;
+		float phiColor;
+		float phiNormal;
+		float phiDepth;
+		float phiAlbedo;
+	};
+
+	constexpr uint32_t temporalBindingCount = 9;
+	constexpr uint32_t varianceBindingCount = 4;
+	constexpr uint32_t filterBindingCount = 5;
+
+	//every binding of every pass is a storage image
+	denoiser::Pipeline createPassPipeline(uint32_t bindingCount, uint32_t pushConstantSize, const char *shaderPath)
+	{
+		denoiser::Pipeline pipeline = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(bindingCount);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipeline.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = pushConstantSize
+		};
+		pipeline.layout = vkut::common::createPipelineLayout({ pipeline.descriptorSetLayout }, { pushConstantRange });
+
+		VkShaderModule shaderModule = vkut::common::createShaderModule(shaderPath);
+		pipeline.pipeline = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		return pipeline;
+	}
+
+	void destroyPassPipeline(denoiser::Pipeline pipeline)
+	{
+		vkut::common::destroyPipeline(pipeline.pipeline);
+		vkut::common::destroyPipelineLayout(pipeline.layout);
+		vkut::common::destroyDescriptorSetLayout(pipeline.descriptorSetLayout);
+	}
+
+	//binds the views to the bindings in order
+	VkDescriptorSet createImageSet(const denoiser::Pipeline &pipeline, VkDescriptorPool descriptorPool, const std::vector<VkImageView> &views)
+	{
+		std::vector<VkDescriptorImageInfo> imageInfos = std::vector<VkDescriptorImageInfo>(views.size());
+		std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(views.size());
+		for (uint32_t binding = 0; binding < views.size(); binding++)
+		{
+			imageInfos[binding] = { .sampler = VK_NULL_HANDLE, .imageView = views[binding], .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+			descriptorSetInfos[binding] = vkut::DescriptorSetInfo
+			{
+				.pNext = nullptr,
+				.dstBinding = binding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.pImageInfo = &imageInfos[binding],
+				.pBufferInfo = nullptr,
+				.pTexelBufferView = nullptr
+			};
+		}
+
+		return vkut::common::createDescriptorSet(pipeline.descriptorSetLayout, descriptorPool, descriptorSetInfos);
+	}
+
+	void recordPass(VkCommandBuffer commandBuffer, const denoiser::Pipeline &pipeline, VkDescriptorSet descriptorSet, const void *pushConstants, uint32_t pushConstantSize, VkExtent2D extent)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pushConstants);
+		vkCmdDispatch(commandBuffer, (extent.width + denoiser::workgroupSize - 1) / denoiser::workgroupSize, (extent.height + denoiser::workgroupSize - 1) / denoiser::workgroupSize, 1);
+	}
+}
+
+namespace denoiser {
+
+	Pipelines createPipelines()
+	{
+		return Pipelines
+		{
+			.temporal = createPassPipeline(temporalBindingCount, sizeof(TemporalPushConstants), "../Assets/shaders/denoiseTemporal.comp.spv"),
+			.variance = createPassPipeline(varianceBindingCount, sizeof(VariancePushConstants), "../Assets/shaders/denoiseVariance.comp.spv"),
+			.filter = createPassPipeline(filterBindingCount, sizeof(FilterPushConstants), "../Assets/shaders/denoiseFilter.comp.spv")
+		};
+	}
+
+	void destroyPipelines(Pipelines pipelines)
+	{
+		destroyPassPipeline(pipelines.filter);
+		destroyPassPipeline(pipelines.variance);
+		destroyPassPipeline(pipelines.temporal);
+	}
+
+	Targets createTargets(VkCommandPool commandPool, const Pipelines &pipelines, VkExtent2D extent, const std::vector<VkImageView> &sourceViews, VkImageView motionView)
+	{
+		auto createImage = [&](VkFormat format) { return vkut::common::createStorageImage(commandPool, extent, format); };
+
+		Targets targets
+		{
+			.positions = createImage(positionFormat),
+			.albedo = createImage(albedoFormat),
+			.normalDepth = { createImage(colorFormat), createImage(colorFormat) },
+			.color = { createImage(colorFormat), createImage(colorFormat) },
+			.moments = { createImage(momentsFormat), createImage(momentsFormat) },
+			.integrated = createImage(colorFormat),
+			.filtered = { createImage(colorFormat), createImage(colorFormat) },
+			.sourceCount = sourceViews.size()
+		};
+
+		const uint32_t temporalSetCount = static_cast<uint32_t>(sourceViews.size() * 2U);
+		const uint32_t setCount = temporalSetCount + 2U + 4U;
+		const uint32_t imageCount = temporalSetCount * temporalBindingCount + 2U * varianceBindingCount + 4U * filterBindingCount;
+		targets.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }, imageCount, setCount);
+
+		targets.temporalSets.resize(temporalSetCount);
+		for (size_t history = 0; history < 2U; history++)
+		{
+			const size_t previous = 1U - history;
+			for (size_t source = 0; source < sourceViews.size(); source++)
+			{
+				targets.temporalSets[source * 2U + history] = createImageSet(pipelines.temporal, targets.descriptorPool,
+				{
+					sourceViews[source], targets.positions.view, motionView,
+					targets.normalDepth[previous].view, targets.color[previous].view, targets.moments[previous].view,
+					targets.normalDepth[history].view, targets.integrated.view, targets.moments[history].view
+				});
+			}
+
+			targets.varianceSets[history] = createImageSet(pipelines.variance, targets.descriptorPool,
+				{ targets.integrated.view, targets.moments[history].view, targets.normalDepth[history].view, targets.filtered[0].view });
+
+			for (size_t read = 0; read < 2U; read++)
+			{
+				targets.filterSets[read * 2U + history] = createImageSet(pipelines.filter, targets.descriptorPool,
+					{ targets.filtered[read].view, targets.filtered[1U - read].view, targets.normalDepth[history].view, targets.albedo.view, targets.color[history].view });
+			}
+		}
+
+		Logger::logMessageFormatted("Created denoiser targets of %ux%u! ", extent.width, extent.height);
+
+		return targets;
+	}
+
+	void destroyTargets(Targets targets)
+	{
+		vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		for (size_t i = 0; i < 2U; i++)
+		{
+			vkut::common::destroyStorageImage(targets.filtered[i]);
+			vkut::common::destroyStorageImage(targets.moments[i]);
+			vkut::common::destroyStorageImage(targets.color[i]);
+			vkut::common::destroyStorageImage(targets.normalDepth[i]);
+		}
+		vkut::common::destroyStorageImage(targets.integrated);
+		vkut::common::destroyStorageImage(targets.albedo);
+		vkut::common::destroyStorageImage(targets.positions);
+	}
+
+	size_t getResultIndex(const Settings &settings)
+	{
+		return settings.filterPasses % 2U;
+	}
+
+	void recordDenoise(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		size_t sourceIndex, size_t historyIndex, VkExtent2D extent, const Settings &settings, bool historyValid)
+	{
+		assert(settings.filterPasses >= 1 && settings.filterPasses <= maxFilterPasses);
+		assert(sourceIndex < targets.sourceCount && historyIndex < 2U);
+		assert(extent.width <= targets.integrated.extent.width && extent.height <= targets.integrated.extent.height);
+
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+		vkut::common::resetTimestamps(commandBuffer, timestamps, firstTimestamp, timestampsPerFrame);
+
+		//the previous frame wrote the history read here
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		TemporalPushConstants temporalPushConstants
+		{
+			.width = extent.width,
+			.height = extent.height,
+			.historyValid = historyValid ? 1U : 0U,
+			.colorAlpha = settings.colorAlpha,
+			.momentsAlpha = settings.momentsAlpha
+		};
+		recordPass(commandBuffer, pipelines.temporal, targets.temporalSets[sourceIndex * 2U + historyIndex], &temporalPushConstants, sizeof(TemporalPushConstants), extent);
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp + 1U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		VariancePushConstants variancePushConstants
+		{
+			.width = extent.width,
+			.height = extent.height,
+			.phiNormal = settings.phiNormal,
+			.phiDepth = settings.phiDepth
+		};
+		recordPass(commandBuffer, pipelines.variance, targets.varianceSets[historyIndex], &variancePushConstants, sizeof(VariancePushConstants), extent);
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp + 2U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		for (uint32_t pass = 0; pass < settings.filterPasses; pass++)
+		{
+			FilterPushConstants filterPushConstants
+			{
+				.width = extent.width,
+				.height = extent.height,
+				.stepSize = 1U << pass,
+				.writeHistory = pass == 0 ? 1U : 0U,
+				.phiColor = settings.phiColor,
+				.phiNormal = settings.phiNormal,
+				.phiDepth = settings.phiDepth,
+				.phiAlbedo = settings.phiAlbedo
+			};
+			recordPass(commandBuffer, pipelines.filter, targets.filterSets[(pass % 2U) * 2U + historyIndex], &filterPushConstants, sizeof(FilterPushConstants), extent);
+			vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp + 3U + pass, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		}
+	}
+
+	PassMilliseconds getPassMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame, const Settings &settings)
+	{
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+
+		PassMilliseconds milliseconds
+		{
+			.temporal = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp, firstTimestamp + 1U),
+			.variance = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp + 1U, firstTimestamp + 2U),
+			.filter = {},
+			.total = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp, firstTimestamp + 2U + settings.filterPasses)
+		};
+		for (uint32_t pass = 0; pass < settings.filterPasses; pass++)
+		{
+			milliseconds.filter[pass] = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp + 2U + pass, firstTimestamp + 3U + pass);
+		}
+		return milliseconds;
+	}
+}
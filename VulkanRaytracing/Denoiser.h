@@ -0,0 +1,96 @@
+#pragma once
+#include "vkutils.h"
+#include <vector>
+
+//spatiotemporal variance guided filtering of a low sample count trace
+//denoiseTemporal.comp reprojects and accumulates the previous frames, denoiseVariance.comp estimates the luminance variance
+//and denoiseFilter.comp runs the a-trous wavelet passes, each one twice as wide as the one before
+namespace denoiser {
+
+	constexpr uint32_t workgroupSize = 8;
+	constexpr uint32_t maxFilterPasses = 5;
+	//before the temporal pass and after every pass
+	constexpr uint32_t timestampsPerFrame = maxFilterPasses + 3;
+
+	constexpr VkFormat positionFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+	constexpr VkFormat albedoFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	constexpr VkFormat colorFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	constexpr VkFormat momentsFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+	struct Settings
+	{
+		//1 to maxFilterPasses
+		uint32_t filterPasses = 5;
+		//smallest weight of the current frame in the temporal accumulation of the color and of the luminance moments
+		float colorAlpha = .2f;
+		float momentsAlpha = .2f;
+		//edge stopping, larger values blur more across luminance, depth and albedo differences and less across normal ones
+		float phiColor = 4.0f;
+		float phiNormal = 128.0f;
+		float phiDepth = 1.0f;
+		float phiAlbedo = .1f;
+	};
+
+	struct Pipeline
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+	};
+
+	struct Pipelines
+	{
+		Pipeline temporal;
+		Pipeline variance;
+		Pipeline filter;
+	};
+
+	//the images with two entries hold the current frame at the history index and the previous one at the other
+	struct Targets
+	{
+		//G-buffer written by the trace
+		vkut::StorageImage positions;
+		vkut::StorageImage albedo;
+		vkut::StorageImage normalDepth[2];
+		vkut::StorageImage color[2];
+		vkut::StorageImage moments[2];
+		vkut::StorageImage integrated;
+		//the wavelet passes read one and write the other, the variance pass starts in the first
+		vkut::StorageImage filtered[2];
+		size_t sourceCount;
+		VkDescriptorPool descriptorPool;
+		//source * 2 + history index
+		std::vector<VkDescriptorSet> temporalSets;
+		VkDescriptorSet varianceSets[2];
+		//filtered image read * 2 + history index
+		VkDescriptorSet filterSets[4];
+	};
+
+	struct PassMilliseconds
+	{
+		double temporal;
+		double variance;
+		double filter[maxFilterPasses];
+		double total;
+	};
+
+	[[nodiscard]]
+	Pipelines createPipelines();
+	void destroyPipelines(Pipelines pipelines);
+
+	//the sources are the images the trace may finish in, the motion vectors are written by the trace
+	[[nodiscard]]
+	Targets createTargets(VkCommandPool commandPool, const Pipelines &pipelines, VkExtent2D extent, const std::vector<VkImageView> &sourceViews, VkImageView motionView);
+	void destroyTargets(Targets targets);
+
+	//index of the filtered image holding the result
+	size_t getResultIndex(const Settings &settings);
+
+	//denoises the top left extent of the source into the filtered image at getResultIndex, reprojecting the previous frame if historyValid
+	//the trace has to be behind a barrier to the compute stage, whatever reads the result behind another one
+	void recordDenoise(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		size_t sourceIndex, size_t historyIndex, VkExtent2D extent, const Settings &settings, bool historyValid);
+
+	//the frame has to be completed
+	PassMilliseconds getPassMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame, const Settings &settings);
+}
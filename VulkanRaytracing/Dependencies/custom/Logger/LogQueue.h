@@ -0,0 +1,105 @@
+#ifndef LOG_QUEUE_H_DEFINED
+#define LOG_QUEUE_H_DEFINED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//bounded queue with any number of producers and a single consumer, after Vyukov's bounded MPMC queue
+//the sequence number of a slot tells whether it is free, being written or ready to be read
+//producers never wait for each other, a full queue makes tryClaim fail instead of blocking
+template<typename T, size_t Capacity>
+class LogQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+
+	LogQueue() : slots(std::make_unique<Slot[]>(Capacity))
+	{
+		for (size_t i = 0; i < Capacity; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	LogQueue(const LogQueue &) = delete;
+	LogQueue &operator=(const LogQueue &) = delete;
+
+	//any thread, the returned item belongs to the caller until it publishes the ticket, nullptr when full
+	T *tryClaim(uint64_t &ticket)
+	{
+		uint64_t position = tail.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Slot &slot = slots[position & (Capacity - 1)];
+			const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			const int64_t difference = static_cast<int64_t>(sequence - position);
+			if (difference == 0)
+			{
+				if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					ticket = position;
+					return &slot.item;
+				}
+			}
+			else if (difference < 0)
+			{
+				//the consumer has not released this slot since the last lap
+				return nullptr;
+			}
+			else
+			{
+				position = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void publish(uint64_t ticket)
+	{
+		slots[ticket & (Capacity - 1)].sequence.store(ticket + 1, std::memory_order_release);
+	}
+
+	//number of items claimed so far, published or not
+	uint64_t getClaimedCount() const
+	{
+		return tail.load(std::memory_order_acquire);
+	}
+
+	//consumer only, items come out in the order they were claimed, nullptr until the next one is published
+	T *peek()
+	{
+		Slot &slot = slots[head & (Capacity - 1)];
+		return slot.sequence.load(std::memory_order_acquire) == head + 1 ? &slot.item : nullptr;
+	}
+
+	//consumer only, hands the slot returned by peek back to the producers
+	void pop()
+	{
+		slots[head & (Capacity - 1)].sequence.store(head + Capacity, std::memory_order_release);
+		head++;
+	}
+
+	//consumer only
+	uint64_t getPoppedCount() const
+	{
+		return head;
+	}
+
+private:
+
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence;
+		T item;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<uint64_t> tail = 0;
+	//keeps the tail, written by every producer, off the cache line of the head
+	char padding[64];
+	uint64_t head = 0;
+};
+
+#endif
@@ -0,0 +1,397 @@
+#include "LogRecord.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace logging {
+
+	namespace {
+
+		const char *const prefixes[] = { "error!!!", "warning!", "message", "trivial" };
+
+		enum class ArgumentType : uint8_t
+		{
+			INTEGER,
+			UNSIGNED,
+			CHARACTER,
+			FLOATING,
+			POINTER,
+			STRING,
+			//%n, consumed but never written to
+			NONE
+		};
+
+		//one printf conversion specification, without its leading '%'
+		struct Conversion
+		{
+			const char *flags;
+			size_t flagsLength;
+			const char *width;
+			size_t widthLength;
+			bool widthFromArgument;
+			bool hasPrecision;
+			const char *precision;
+			size_t precisionLength;
+			bool precisionFromArgument;
+			bool isLong;
+			bool isLongLong;
+			char lengthModifier;
+			char type;
+			//first character after the specification
+			const char *end;
+		};
+
+		size_t skipDigits(const char *text)
+		{
+			size_t length = 0;
+			while (text[length] >= '0' && text[length] <= '9') length++;
+			return length;
+		}
+
+		bool parseConversion(const char *begin, Conversion &conversion)
+		{
+			const char *c = begin;
+
+			conversion.flags = c;
+			while (*c != '\0' && std::strchr("-+ #0", *c) != nullptr) c++;
+			conversion.flagsLength = static_cast<size_t>(c - conversion.flags);
+
+			conversion.widthFromArgument = *c == '*';
+			conversion.width = c;
+			conversion.widthLength = conversion.widthFromArgument ? 0 : skipDigits(c);
+			c += conversion.widthFromArgument ? 1 : conversion.widthLength;
+
+			conversion.hasPrecision = *c == '.';
+			conversion.precisionFromArgument = false;
+			conversion.precision = c;
+			conversion.precisionLength = 0;
+			if (conversion.hasPrecision)
+			{
+				c++;
+				conversion.precisionFromArgument = *c == '*';
+				conversion.precision = c;
+				conversion.precisionLength = conversion.precisionFromArgument ? 0 : skipDigits(c);
+				c += conversion.precisionFromArgument ? 1 : conversion.precisionLength;
+			}
+
+			conversion.isLong = false;
+			conversion.isLongLong = false;
+			conversion.lengthModifier = '\0';
+			if (*c == 'h')
+			{
+				c += c[1] == 'h' ? 2 : 1;
+			}
+			else if (*c == 'l')
+			{
+				conversion.isLongLong = c[1] == 'l';
+				conversion.isLong = !conversion.isLongLong;
+				c += conversion.isLongLong ? 2 : 1;
+			}
+			else if (*c != '\0' && std::strchr("jztL", *c) != nullptr)
+			{
+				conversion.lengthModifier = *c;
+				c++;
+			}
+
+			if (*c == '\0' || std::strchr("diuoxXcfFeEgGaAspn", *c) == nullptr) return false;
+			conversion.type = *c;
+			conversion.end = c + 1;
+			return true;
+		}
+
+		ArgumentType getArgumentType(const Conversion &conversion)
+		{
+			switch (conversion.type)
+			{
+			case 'd': case 'i':
+				return ArgumentType::INTEGER;
+			case 'u': case 'o': case 'x': case 'X':
+				return ArgumentType::UNSIGNED;
+			case 'c':
+				return ArgumentType::CHARACTER;
+			case 's':
+				//wide strings are not copied, only their address is printed
+				return conversion.isLong ? ArgumentType::POINTER : ArgumentType::STRING;
+			case 'p':
+				return ArgumentType::POINTER;
+			case 'n':
+				return ArgumentType::NONE;
+			default:
+				return ArgumentType::FLOATING;
+			}
+		}
+
+		class PayloadWriter
+		{
+		public:
+
+			explicit PayloadWriter(Record &givenRecord) : record(givenRecord) {}
+
+			template<typename T>
+			bool write(ArgumentType type, T value)
+			{
+				if (record.size + 1 + sizeof(T) > payloadSize) return false;
+
+				record.payload[record.size] = static_cast<unsigned char>(type);
+				std::memcpy(record.payload + record.size + 1, &value, sizeof(T));
+				record.size = static_cast<uint16_t>(record.size + 1 + sizeof(T));
+				return true;
+			}
+
+			//truncated to what is left of the payload
+			bool writeString(const char *text)
+			{
+				if (text == nullptr) text = "(null)";
+				if (static_cast<size_t>(record.size) + 2 > payloadSize) return false;
+
+				const size_t available = payloadSize - record.size - 2;
+				const size_t length = strnlen(text, available);
+				record.payload[record.size] = static_cast<unsigned char>(ArgumentType::STRING);
+				std::memcpy(record.payload + record.size + 1, text, length);
+				record.payload[record.size + 1 + length] = '\0';
+				record.size = static_cast<uint16_t>(record.size + 2 + length);
+				return true;
+			}
+
+		private:
+
+			Record &record;
+		};
+
+		//copies the arguments format names off the list, false if they do not fit or the format is not understood
+		bool captureArguments(const char *format, va_list list, Record &record)
+		{
+			PayloadWriter writer = PayloadWriter(record);
+			for (const char *c = format; *c != '\0'; c++)
+			{
+				if (*c != '%') continue;
+				if (c[1] == '%')
+				{
+					c++;
+					continue;
+				}
+
+				Conversion conversion;
+				if (!parseConversion(c + 1, conversion)) return false;
+				if (conversion.widthFromArgument && !writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, int)))) return false;
+				if (conversion.precisionFromArgument && !writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, int)))) return false;
+
+				bool written = true;
+				switch (getArgumentType(conversion))
+				{
+				case ArgumentType::INTEGER:
+					if (conversion.isLongLong || conversion.lengthModifier == 'j') written = writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, long long)));
+					else if (conversion.isLong) written = writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, long)));
+					else if (conversion.lengthModifier == 'z' || conversion.lengthModifier == 't') written = writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, ptrdiff_t)));
+					else written = writer.write(ArgumentType::INTEGER, static_cast<int64_t>(va_arg(list, int)));
+					break;
+				case ArgumentType::UNSIGNED:
+					if (conversion.isLongLong || conversion.lengthModifier == 'j') written = writer.write(ArgumentType::UNSIGNED, static_cast<uint64_t>(va_arg(list, unsigned long long)));
+					else if (conversion.isLong) written = writer.write(ArgumentType::UNSIGNED, static_cast<uint64_t>(va_arg(list, unsigned long)));
+					else if (conversion.lengthModifier == 'z' || conversion.lengthModifier == 't') written = writer.write(ArgumentType::UNSIGNED, static_cast<uint64_t>(va_arg(list, size_t)));
+					else written = writer.write(ArgumentType::UNSIGNED, static_cast<uint64_t>(va_arg(list, unsigned int)));
+					break;
+				case ArgumentType::CHARACTER:
+					written = writer.write(ArgumentType::CHARACTER, static_cast<int64_t>(va_arg(list, int)));
+					break;
+				case ArgumentType::FLOATING:
+					if (conversion.lengthModifier == 'L') written = writer.write(ArgumentType::FLOATING, static_cast<double>(va_arg(list, long double)));
+					else written = writer.write(ArgumentType::FLOATING, va_arg(list, double));
+					break;
+				case ArgumentType::POINTER:
+					written = writer.write(ArgumentType::POINTER, va_arg(list, void *));
+					break;
+				case ArgumentType::STRING:
+					written = writer.writeString(va_arg(list, const char *));
+					break;
+				case ArgumentType::NONE:
+					static_cast<void>(va_arg(list, void *));
+					break;
+				}
+				if (!written) return false;
+
+				c = conversion.end - 1;
+			}
+			return true;
+		}
+
+		class LineWriter
+		{
+		public:
+
+			LineWriter(char *givenText, size_t givenCapacity) : text(givenText), capacity(givenCapacity) {}
+
+			void append(const char *appended, size_t length)
+			{
+				length = std::min(length, capacity - 1 - size);
+				std::memcpy(text + size, appended, length);
+				size += length;
+				text[size] = '\0';
+			}
+
+			template<typename T>
+			void appendFormatted(const char *specification, T value)
+			{
+				const int length = std::snprintf(text + size, capacity - size, specification, value);
+				if (length > 0) size = std::min(size + static_cast<size_t>(length), capacity - 1);
+			}
+
+			size_t getSize() const
+			{
+				return size;
+			}
+
+		private:
+
+			char *text;
+			size_t capacity;
+			size_t size = 0;
+		};
+
+		class PayloadReader
+		{
+		public:
+
+			explicit PayloadReader(const Record &givenRecord) : record(givenRecord) {}
+
+			template<typename T>
+			T read()
+			{
+				T value;
+				std::memcpy(&value, record.payload + offset + 1, sizeof(T));
+				offset += 1 + sizeof(T);
+				return value;
+			}
+
+			const char *readString()
+			{
+				const char *text = reinterpret_cast<const char *>(record.payload + offset + 1);
+				offset += 2 + std::strlen(text);
+				return text;
+			}
+
+		private:
+
+			const Record &record;
+			size_t offset = 0;
+		};
+	}
+
+	void captureRecord(Record &record, Logger::Verbosity verbosity, const char *format, va_list list)
+	{
+		record.format = format;
+		record.verbosity = verbosity;
+		record.kind = RecordKind::DEFERRED;
+		record.size = 0;
+
+		va_list copy;
+		va_copy(copy, list);
+		if (!captureArguments(format, list, record))
+		{
+			//does not fit the payload, formatted here and truncated instead
+			record.kind = RecordKind::TEXT;
+			int length = std::vsnprintf(reinterpret_cast<char *>(record.payload), payloadSize, format, copy);
+			if (length < 0)
+			{
+				length = static_cast<int>(strnlen(format, payloadSize));
+				std::memcpy(record.payload, format, static_cast<size_t>(length));
+			}
+			record.size = static_cast<uint16_t>(std::min(length, static_cast<int>(payloadSize) - 1));
+		}
+		va_end(copy);
+	}
+
+	void captureText(Record &record, Logger::Verbosity verbosity, const char *message)
+	{
+		const size_t length = strnlen(message, payloadSize);
+		record.format = nullptr;
+		record.verbosity = verbosity;
+		record.kind = RecordKind::TEXT;
+		record.size = static_cast<uint16_t>(length);
+		std::memcpy(record.payload, message, length);
+	}
+
+	size_t formatRecord(const Record &record, const char *format, char *text, size_t capacity)
+	{
+		LineWriter line = LineWriter(text, capacity);
+		if (record.kind == RecordKind::TEXT)
+		{
+			line.append(reinterpret_cast<const char *>(record.payload), record.size);
+			return line.getSize();
+		}
+
+		PayloadReader reader = PayloadReader(record);
+		const char *literal = format;
+		for (const char *c = format; *c != '\0'; c++)
+		{
+			if (*c != '%') continue;
+
+			line.append(literal, static_cast<size_t>(c - literal));
+			if (c[1] == '%')
+			{
+				line.append("%", 1);
+				literal = ++c + 1;
+				continue;
+			}
+
+			Conversion conversion;
+			parseConversion(c + 1, conversion);
+
+			//rebuilt with the stars resolved and the length modifier matching the captured type
+			char specification[64];
+			LineWriter specificationWriter = LineWriter(specification, sizeof(specification));
+			specificationWriter.append("%", 1);
+			specificationWriter.append(conversion.flags, conversion.flagsLength);
+			if (conversion.widthFromArgument) specificationWriter.appendFormatted("%lld", static_cast<long long>(reader.read<int64_t>()));
+			else specificationWriter.append(conversion.width, conversion.widthLength);
+
+			const int64_t precision = conversion.precisionFromArgument ? reader.read<int64_t>() : 0;
+			if (conversion.hasPrecision && precision >= 0)
+			{
+				specificationWriter.append(".", 1);
+				if (conversion.precisionFromArgument) specificationWriter.appendFormatted("%lld", static_cast<long long>(precision));
+				else specificationWriter.append(conversion.precision, conversion.precisionLength);
+			}
+
+			const ArgumentType type = getArgumentType(conversion);
+			if (type == ArgumentType::INTEGER || type == ArgumentType::UNSIGNED) specificationWriter.append("ll", 2);
+			const char conversionType = type == ArgumentType::POINTER ? 'p' : conversion.type;
+			specificationWriter.append(&conversionType, 1);
+
+			switch (type)
+			{
+			case ArgumentType::INTEGER:
+				line.appendFormatted(specification, static_cast<long long>(reader.read<int64_t>()));
+				break;
+			case ArgumentType::UNSIGNED:
+				line.appendFormatted(specification, static_cast<unsigned long long>(reader.read<uint64_t>()));
+				break;
+			case ArgumentType::CHARACTER:
+				line.appendFormatted(specification, static_cast<int>(reader.read<int64_t>()));
+				break;
+			case ArgumentType::FLOATING:
+				line.appendFormatted(specification, reader.read<double>());
+				break;
+			case ArgumentType::POINTER:
+				line.appendFormatted(specification, reader.read<void *>());
+				break;
+			case ArgumentType::STRING:
+				line.appendFormatted(specification, reader.readString());
+				break;
+			case ArgumentType::NONE:
+				break;
+			}
+
+			c = conversion.end - 1;
+			literal = conversion.end;
+		}
+
+		line.append(literal, std::strlen(literal));
+		return line.getSize();
+	}
+
+	const char *getVerbosityPrefix(Logger::Verbosity verbosity)
+	{
+		return prefixes[verbosity];
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef LOG_RECORD_H_DEFINED
+#define LOG_RECORD_H_DEFINED
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include "Logger.h"
+
+//what the Logger queues and what its binary log stores : the format and a copy of the arguments, formatted only when read
+//shared with the decoder of the binary log, so the layout of the payload is part of that format
+namespace logging {
+
+	//records are 512 bytes, longer strings and messages are truncated
+	constexpr size_t payloadSize = 496;
+
+	enum class RecordKind : uint8_t
+	{
+		//the payload is the finished text
+		TEXT,
+		//the payload holds the arguments of format, each a type byte followed by its value
+		DEFERRED
+	};
+
+	struct Record
+	{
+		//only valid within the process that logged it, the binary log refers to formats by id instead
+		const char *format;
+		Logger::Verbosity verbosity;
+		RecordKind kind;
+		uint16_t size;
+		unsigned char payload[payloadSize];
+	};
+
+	//format must outlive the record, list is only read before returning
+	void captureRecord(Record &record, Logger::Verbosity verbosity, const char *format, va_list list);
+	//message is copied, so it may be a temporary
+	void captureText(Record &record, Logger::Verbosity verbosity, const char *message);
+
+	//text of the record without prefix or line break, truncated to capacity including the terminator
+	size_t formatRecord(const Record &record, const char *format, char *text, size_t capacity);
+
+	const char *getVerbosityPrefix(Logger::Verbosity verbosity);
+
+	//binary log : the magic, then entries that each start with a BinaryEntry byte, integers are little endian
+	//FORMAT : uint32 id, uint16 length and the format without terminator, written before the first record that uses it
+	//RECORD : uint8 verbosity, uint8 kind, uint32 format id, uint16 size and size bytes of payload
+	constexpr char binaryLogMagic[8] = { 'V', 'K', 'U', 'T', 'L', 'O', 'G', '1' };
+	//format id of TEXT records
+	constexpr uint32_t noFormat = 0xFFFFFFFF;
+
+	enum class BinaryEntry : uint8_t
+	{
+		FORMAT,
+		RECORD
+	};
+}
+
+#endif
@@ -1,6 +1,15 @@
 #include "Logger.h"
+#include "LogQueue.h"
+#include "LogRecord.h"
 #include <iostream>
+#include <fstream>
 #include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #ifdef NDEBUG
 Logger::Verbosity Logger::verbosity = Logger::Verbosity::WARNING;
@@ -10,37 +19,327 @@ Logger::Verbosity Logger::verbosity = Logger::Verbosity::TRIVIAL;
 
 #ifdef _WIN64
 
-#define COLOR_ERROR {std::cout << "\033[1;31m";}
-#define COLOR_WARNING {std::cout << "\033[1;33m";}
-#define COLOR_MESSAGE {std::cout << "\033[1;35m";}
-#define COLOR_TRIVIAL {std::cout << "\033[1;33m";}
-#define RESET_COLOR {std::cout << "\033[0m";}
+#define COLOR_ERROR "\033[1;31m"
+#define COLOR_WARNING "\033[1;33m"
+#define COLOR_MESSAGE "\033[1;35m"
+#define COLOR_TRIVIAL "\033[1;33m"
+#define RESET_COLOR "\033[0m"
 
-#elif
+#else
 
-#define COLOR_ERROR
-#define COLOR_WARNING
-#define COLOR_MESSAGE
-#define COLOR_TRIVIAL
-#define RESET_COLOR
+#define COLOR_ERROR ""
+#define COLOR_WARNING ""
+#define COLOR_MESSAGE ""
+#define COLOR_TRIVIAL ""
+#define RESET_COLOR ""
 
 #endif
 
 
-#define CHECK_VERBOSITY(against) if(verbosity < against) return;
+#define CHECK_VERBOSITY(against) if(!isEnabled(against)) return;
+
+
+namespace {
+
+	const char *const colors[] = { COLOR_ERROR, COLOR_WARNING, COLOR_MESSAGE, COLOR_TRIVIAL };
+
+	constexpr size_t queueCapacity = 4096;
+	constexpr size_t maxLineLength = 1024;
+
+	template<typename T>
+	void writeBinary(std::ofstream &stream, T value)
+	{
+		stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	//set once the backend is gone, records logged from later static destructors are written right away
+	bool backendDestroyed = false;
+
+	class Backend
+	{
+	public:
+
+		Backend() : consumer(&Backend::consume, this) {}
+
+		~Backend()
+		{
+			running = false;
+			wakeConsumer(true);
+			consumer.join();
+			backendDestroyed = true;
+		}
+
+		void log(Logger::Verbosity verbosity, const char *format, va_list list)
+		{
+			uint64_t ticket;
+			logging::Record *record = claim(verbosity, ticket);
+			if (record == nullptr) return;
+
+			logging::captureRecord(*record, verbosity, format, list);
+			publish(verbosity, ticket);
+		}
+
+		void log(Logger::Verbosity verbosity, const char *message)
+		{
+			uint64_t ticket;
+			logging::Record *record = claim(verbosity, ticket);
+			if (record == nullptr) return;
+
+			logging::captureText(*record, verbosity, message);
+			publish(verbosity, ticket);
+		}
+
+		void flush()
+		{
+			const uint64_t target = queue.getClaimedCount();
+			wakeConsumer(false);
+
+			uint64_t current = writtenCount.load();
+			while (current < target)
+			{
+				writtenCount.wait(current);
+				current = writtenCount.load();
+			}
+		}
+
+		void setConsoleOutput(bool enabled)
+		{
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			consoleOutput = enabled;
+		}
+
+		bool openFile(const char *path)
+		{
+			flush();
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			file.close();
+			file.open(path, std::ios::out | std::ios::trunc);
+			return file.is_open();
+		}
+
+		void closeFile()
+		{
+			flush();
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			file.close();
+		}
+
+		bool openBinaryFile(const char *path)
+		{
+			flush();
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			binaryFile.close();
+			binaryFile.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+			formatIds.clear();
+			if (!binaryFile.is_open()) return false;
+
+			binaryFile.write(logging::binaryLogMagic, sizeof(logging::binaryLogMagic));
+			return true;
+		}
+
+		void closeBinaryFile()
+		{
+			flush();
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			binaryFile.close();
+		}
+
+		uint64_t getDroppedCount(Logger::Verbosity verbosity) const
+		{
+			return droppedCounts[verbosity].load(std::memory_order_relaxed);
+		}
+
+	private:
+
+		LogQueue<logging::Record, queueCapacity> queue;
+		std::atomic<uint64_t> droppedCounts[4] = {};
+		//drops the consumer has already reported
+		uint64_t reportedDropCount = 0;
+		//records the consumer is done with, flush waits on it
+		std::atomic<uint64_t> writtenCount = 0;
+		std::atomic<bool> running = true;
+		std::atomic<bool> consumerSleeping = false;
+
+		std::mutex sinkMutex;
+		bool consoleOutput = true;
+		std::ofstream file;
+		std::ofstream binaryFile;
+		//formats already written to the binary file
+		std::unordered_map<const char *, uint32_t> formatIds;
+
+		std::thread consumer;
+
+		logging::Record *claim(Logger::Verbosity verbosity, uint64_t &ticket)
+		{
+			logging::Record *record = queue.tryClaim(ticket);
+			//errors are never dropped, the caller waits for the consumer to make room
+			while (record == nullptr && verbosity == Logger::Verbosity::ERROR)
+			{
+				flush();
+				record = queue.tryClaim(ticket);
+			}
+
+			if (record == nullptr) droppedCounts[verbosity].fetch_add(1, std::memory_order_relaxed);
+			return record;
+		}
+
+		void publish(Logger::Verbosity verbosity, uint64_t ticket)
+		{
+			queue.publish(ticket);
+			wakeConsumer(false);
+			if (verbosity == Logger::Verbosity::ERROR) flush();
+		}
+
+		//the consumer announces it is going to sleep before checking the queue one last time, so with the fences one of the two sees the other
+		void wakeConsumer(bool always)
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (always || consumerSleeping.load(std::memory_order_relaxed))
+			{
+				consumerSleeping.store(false);
+				consumerSleeping.notify_one();
+			}
+		}
+
+		uint32_t getFormatId(const char *format)
+		{
+			auto it = formatIds.find(format);
+			if (it != formatIds.end()) return it->second;
+
+			const uint32_t id = static_cast<uint32_t>(formatIds.size());
+			const uint16_t length = static_cast<uint16_t>(strnlen(format, UINT16_MAX));
+			writeBinary(binaryFile, logging::BinaryEntry::FORMAT);
+			writeBinary(binaryFile, id);
+			writeBinary(binaryFile, length);
+			binaryFile.write(format, length);
+
+			formatIds.emplace(format, id);
+			return id;
+		}
 
+		//only the text sinks pay for formatting
+		void write(const logging::Record &record, char *text)
+		{
+			if (binaryFile.is_open())
+			{
+				const uint32_t formatId = record.kind == logging::RecordKind::DEFERRED ? getFormatId(record.format) : logging::noFormat;
+				writeBinary(binaryFile, logging::BinaryEntry::RECORD);
+				writeBinary(binaryFile, static_cast<uint8_t>(record.verbosity));
+				writeBinary(binaryFile, record.kind);
+				writeBinary(binaryFile, formatId);
+				writeBinary(binaryFile, record.size);
+				binaryFile.write(reinterpret_cast<const char *>(record.payload), record.size);
+			}
 
+			if (!consoleOutput && !file.is_open()) return;
 
-#define LOG(prefix, message) std::cout << "[" << prefix << "] " << message << '\n'; RESET_COLOR
+			const size_t length = logging::formatRecord(record, record.format, text, maxLineLength);
+			const char *prefix = logging::getVerbosityPrefix(record.verbosity);
+			if (consoleOutput)
+			{
+				std::cout << colors[record.verbosity] << "[" << prefix << "] ";
+				std::cout.write(text, static_cast<std::streamsize>(length));
+				std::cout << '\n' << RESET_COLOR;
+			}
+			if (file.is_open())
+			{
+				file << "[" << prefix << "] ";
+				file.write(text, static_cast<std::streamsize>(length));
+				file << '\n';
+			}
+		}
 
-#define LOG_FORMATTED(prefix, format)	\
-std::cout << "[" << prefix << "] ";		\
-va_list list;							\
-va_start(list, format);					\
-vprintf(format, list);					\
-va_end(list);							\
-std::cout << '\n';						\
-RESET_COLOR
+		void reportDrops(char *text)
+		{
+			uint64_t dropCount = 0;
+			for (const std::atomic<uint64_t> &droppedCount : droppedCounts)
+			{
+				dropCount += droppedCount.load(std::memory_order_relaxed);
+			}
+			if (dropCount == reportedDropCount) return;
+
+			char message[96];
+			std::snprintf(message, sizeof(message), "Log queue was full, dropped %llu records! ", static_cast<unsigned long long>(dropCount - reportedDropCount));
+			logging::Record record;
+			logging::captureText(record, Logger::Verbosity::WARNING, message);
+			write(record, text);
+			reportedDropCount = dropCount;
+		}
+
+		void consume()
+		{
+			char text[maxLineLength];
+			while (true)
+			{
+				{
+					std::lock_guard<std::mutex> lock(sinkMutex);
+					bool wroteAny = false;
+					while (const logging::Record *record = queue.peek())
+					{
+						write(*record, text);
+						queue.pop();
+						wroteAny = true;
+					}
+					reportDrops(text);
+
+					if (wroteAny)
+					{
+						if (consoleOutput) std::cout.flush();
+						if (file.is_open()) file.flush();
+						if (binaryFile.is_open()) binaryFile.flush();
+					}
+				}
+
+				writtenCount.store(queue.getPoppedCount());
+				writtenCount.notify_all();
+
+				consumerSleeping.store(true);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (queue.peek() == nullptr)
+				{
+					if (!running) break;
+					consumerSleeping.wait(true);
+				}
+				consumerSleeping.store(false);
+			}
+		}
+	};
+
+	Backend &getBackend()
+	{
+		static Backend backend;
+		return backend;
+	}
+
+	void logFormatted(Logger::Verbosity verbosity, const char *format, va_list list)
+	{
+		if (backendDestroyed)
+		{
+			std::cout << colors[verbosity] << "[" << logging::getVerbosityPrefix(verbosity) << "] ";
+			std::vprintf(format, list);
+			std::cout << '\n' << RESET_COLOR;
+			return;
+		}
+		getBackend().log(verbosity, format, list);
+	}
+
+	void logText(Logger::Verbosity verbosity, const char *message)
+	{
+		if (backendDestroyed)
+		{
+			std::cout << colors[verbosity] << "[" << logging::getVerbosityPrefix(verbosity) << "] " << message << '\n' << RESET_COLOR;
+			return;
+		}
+		getBackend().log(verbosity, message);
+	}
+}
+
+
+#define LOG_FORMATTED(verbosity, format)	\
+va_list list;								\
+va_start(list, format);						\
+logFormatted(verbosity, format, list);		\
+va_end(list);
 
 
 void Logger::setVerbosity(Verbosity givenVerbosity)
@@ -51,45 +350,80 @@ void Logger::setVerbosity(Verbosity givenVerbosity)
 void Logger::logMessage(const char *message)
 {
 	CHECK_VERBOSITY(Logger::Verbosity::MESSAGE);
-	COLOR_MESSAGE LOG("message", message);
+	logText(Logger::Verbosity::MESSAGE, message);
 }
 
 void Logger::logMessageFormatted(const char * const format, ...)
 {
 	CHECK_VERBOSITY(Logger::Verbosity::MESSAGE);
-	COLOR_MESSAGE LOG_FORMATTED("message", format);
+	LOG_FORMATTED(Logger::Verbosity::MESSAGE, format);
 }
 
 void Logger::logError(const char *error)
 {
-	COLOR_ERROR LOG("error!!!", error);
+	logText(Logger::Verbosity::ERROR, error);
 }
 
 void Logger::logErrorFormatted(const char *format, ...)
 {
-	COLOR_ERROR LOG_FORMATTED("error!!!", format);
+	LOG_FORMATTED(Logger::Verbosity::ERROR, format);
 }
 void Logger::logWarning(const char *message)
 {
 	CHECK_VERBOSITY(Logger::Verbosity::WARNING);
 
-	COLOR_WARNING LOG("warning!", message);
+	logText(Logger::Verbosity::WARNING, message);
 }
 
 void Logger::logWarningFormatted(const char *format, ...)
 {
-	CHECK_VERBOSITY(Logger::Verbosity::WARNING); 
-	COLOR_WARNING LOG_FORMATTED("warning!", format);
+	CHECK_VERBOSITY(Logger::Verbosity::WARNING);
+	LOG_FORMATTED(Logger::Verbosity::WARNING, format);
 }
 
 void Logger::logTrivial(const char *message)
 {
 	CHECK_VERBOSITY(Logger::Verbosity::TRIVIAL);
-	COLOR_TRIVIAL LOG("trivial", message);
+	logText(Logger::Verbosity::TRIVIAL, message);
 }
 
 void Logger::logTrivialFormatted(const char *format, ...)
 {
 	CHECK_VERBOSITY(Logger::Verbosity::TRIVIAL);
-	COLOR_TRIVIAL LOG_FORMATTED("trivial", format);
-}
\ No newline at end of file
+	LOG_FORMATTED(Logger::Verbosity::TRIVIAL, format);
+}
+
+void Logger::setConsoleOutput(bool enabled)
+{
+	getBackend().setConsoleOutput(enabled);
+}
+
+bool Logger::openLogFile(const char *path)
+{
+	return getBackend().openFile(path);
+}
+
+void Logger::closeLogFile()
+{
+	getBackend().closeFile();
+}
+
+bool Logger::openBinaryLogFile(const char *path)
+{
+	return getBackend().openBinaryFile(path);
+}
+
+void Logger::closeBinaryLogFile()
+{
+	getBackend().closeBinaryFile();
+}
+
+void Logger::flush()
+{
+	if (!backendDestroyed) getBackend().flush();
+}
+
+uint64_t Logger::getDroppedCount(Verbosity givenVerbosity)
+{
+	return getBackend().getDroppedCount(givenVerbosity);
+}
@@ -1,6 +1,28 @@
 #ifndef LOGGER_H_DEFINED
 #define LOGGER_H_DEFINED
 
+#include <cstdint>
+
+//verbosities above this are compiled out of the LOG_ macros and make the functions return right away
+//everything is kept in debug builds and trivial records are dropped from release builds, define it in the project to change that
+#ifndef LOGGER_COMPILED_VERBOSITY
+#ifdef NDEBUG
+#define LOGGER_COMPILED_VERBOSITY 2
+#else
+#define LOGGER_COMPILED_VERBOSITY 3
+#endif
+#endif
+
+//unlike calling the functions directly, arguments are not evaluated when the verbosity is compiled out or disabled
+#define LOGGER_LOG_IF_ENABLED(verbosity, call) do { if constexpr (verbosity <= LOGGER_COMPILED_VERBOSITY) { if (Logger::isEnabled(verbosity)) call; } } while (false)
+#define LOG_ERROR_FORMATTED(...) LOGGER_LOG_IF_ENABLED(Logger::Verbosity::ERROR, Logger::logErrorFormatted(__VA_ARGS__))
+#define LOG_WARNING_FORMATTED(...) LOGGER_LOG_IF_ENABLED(Logger::Verbosity::WARNING, Logger::logWarningFormatted(__VA_ARGS__))
+#define LOG_MESSAGE_FORMATTED(...) LOGGER_LOG_IF_ENABLED(Logger::Verbosity::MESSAGE, Logger::logMessageFormatted(__VA_ARGS__))
+#define LOG_TRIVIAL_FORMATTED(...) LOGGER_LOG_IF_ENABLED(Logger::Verbosity::TRIVIAL, Logger::logTrivialFormatted(__VA_ARGS__))
+
+//records go through a bounded lock-free queue and are formatted and written by a background thread
+//formats are only read on that thread, so they have to outlive the call, which string literals do
+//when the queue is full records are dropped and counted instead of blocking the caller, errors wait for room and are written before the call returns
 class Logger
 {
 public:
@@ -15,9 +37,14 @@ public:
 
 	static void setVerbosity(Verbosity verbosity);
 
+	static bool isEnabled(Verbosity given)
+	{
+		return given <= LOGGER_COMPILED_VERBOSITY && given <= verbosity;
+	}
+
 	static void logMessage(const char *message);
 	static void logMessageFormatted(const char *format, ...);
-	
+
 	static void logError(const char *error);
 	static void logErrorFormatted(const char *format, ...);
 
@@ -27,6 +54,19 @@ public:
 	static void logTrivial(const char *message);
 	static void logTrivialFormatted(const char *format, ...);
 
+	//console output is on by default, the file sinks are off until a file is opened
+	static void setConsoleOutput(bool enabled);
+	static bool openLogFile(const char *path);
+	static void closeLogFile();
+	//records the format id and the copied arguments instead of text, read it back with LogDecoder
+	static bool openBinaryLogFile(const char *path);
+	static void closeBinaryLogFile();
+
+	//blocks until everything logged so far has been written
+	static void flush();
+
+	static uint64_t getDroppedCount(Verbosity verbosity);
+
 private:
 
 	static Verbosity verbosity;
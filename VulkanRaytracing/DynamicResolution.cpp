@@ -0,0 +1,165 @@
+#include "DynamicResolution.h"
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	//matches the push constant block in upscale.comp
+	struct PushConstants
+	{
+		uint32_t sourceWidth;
+		uint32_t sourceHeight;
+		uint32_t destinationWidth;
+		uint32_t destinationHeight;
+	};
+}
+
+namespace resolution {
+
+	float Controller::update(double frameMilliseconds)
+	{
+		//positive while there is time left
+		const double error = (settings.targetMilliseconds - frameMilliseconds) / settings.targetMilliseconds;
+		const double controlledError = std::abs(error) < settings.deadband ? .0 : error;
+
+		//velocity form : the change of the output from the change of the error, the error itself and its second difference
+		const double delta = controlledError - previousError;
+		double change = settings.integral * controlledError;
+		if (samples > 0)
+		{
+			change += settings.proportional * delta + settings.derivative * (delta - previousDelta);
+		}
+		previousDelta = samples > 0 ? delta : .0;
+		previousError = controlledError;
+		samples++;
+
+		const double minRatio = static_cast<double>(settings.minScale) * settings.minScale;
+		const double maxRatio = static_cast<double>(settings.maxScale) * settings.maxScale;
+		pixelRatio = std::clamp(pixelRatio * (1.0 + change), minRatio, maxRatio);
+		scale = static_cast<float>(std::sqrt(pixelRatio));
+		return scale;
+	}
+
+	void Controller::reset()
+	{
+		pixelRatio = static_cast<double>(settings.maxScale) * settings.maxScale;
+		scale = settings.maxScale;
+		previousError = .0;
+		previousDelta = .0;
+		samples = 0;
+	}
+
+	Pipeline createPipeline()
+	{
+		Pipeline pipeline = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(2);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipeline.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipeline.layout = vkut::common::createPipelineLayout({ pipeline.descriptorSetLayout }, { pushConstantRange });
+
+		VkShaderModule shaderModule = vkut::common::createShaderModule("../Assets/shaders/upscale.comp.spv");
+		pipeline.pipeline = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		return pipeline;
+	}
+
+	void destroyPipeline(Pipeline pipeline)
+	{
+		vkut::common::destroyPipeline(pipeline.pipeline);
+		vkut::common::destroyPipelineLayout(pipeline.layout);
+		vkut::common::destroyDescriptorSetLayout(pipeline.descriptorSetLayout);
+	}
+
+	Upscaler createUpscaler(const Pipeline &pipeline, const std::vector<VkImageView> &sourceViews, const std::vector<VkImageView> &destinationViews)
+	{
+		Upscaler upscaler = { .sourceCount = sourceViews.size() };
+
+		const uint32_t setCount = static_cast<uint32_t>(sourceViews.size() * destinationViews.size());
+		upscaler.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }, setCount * 2U, setCount);
+		upscaler.descriptorSets.resize(setCount);
+
+		//the sets of a source are next to each other
+		for (size_t i = 0; i < setCount; i++)
+		{
+			VkDescriptorImageInfo imageInfos[2] =
+			{
+				{ .sampler = VK_NULL_HANDLE, .imageView = sourceViews[i / destinationViews.size()], .imageLayout = VK_IMAGE_LAYOUT_GENERAL },
+				{ .sampler = VK_NULL_HANDLE, .imageView = destinationViews[i % destinationViews.size()], .imageLayout = VK_IMAGE_LAYOUT_GENERAL },
+			};
+
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(2);
+			for (uint32_t binding = 0; binding < 2; binding++)
+			{
+				descriptorSetInfos[binding] = vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = binding,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+					.pImageInfo = &imageInfos[binding],
+					.pBufferInfo = nullptr,
+					.pTexelBufferView = nullptr
+				};
+			}
+
+			upscaler.descriptorSets[i] = vkut::common::createDescriptorSet(pipeline.descriptorSetLayout, upscaler.descriptorPool, descriptorSetInfos);
+		}
+
+		return upscaler;
+	}
+
+	void destroyUpscaler(Upscaler upscaler)
+	{
+		vkut::common::destroyDescriptorPool(upscaler.descriptorPool);
+	}
+
+	VkExtent2D getRenderExtent(VkExtent2D fullExtent, float scale)
+	{
+		auto scaleDimension = [scale](uint32_t dimension)
+		{
+			const uint32_t steps = static_cast<uint32_t>(std::lround(static_cast<float>(dimension) * scale / static_cast<float>(extentGranularity)));
+			return std::clamp(steps * extentGranularity, std::min(extentGranularity, dimension), dimension);
+		};
+		return VkExtent2D{ scaleDimension(fullExtent.width), scaleDimension(fullExtent.height) };
+	}
+
+	void recordUpscale(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Upscaler &upscaler, size_t sourceIndex, uint32_t destinationIndex, VkExtent2D sourceExtent, VkExtent2D destinationExtent)
+	{
+		const size_t destinationCount = upscaler.descriptorSets.size() / upscaler.sourceCount;
+		assert(sourceIndex < upscaler.sourceCount && destinationIndex < destinationCount);
+
+		PushConstants pushConstants
+		{
+			.sourceWidth = sourceExtent.width,
+			.sourceHeight = sourceExtent.height,
+			.destinationWidth = destinationExtent.width,
+			.destinationHeight = destinationExtent.height
+		};
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &upscaler.descriptorSets[sourceIndex * destinationCount + destinationIndex], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (destinationExtent.width + workgroupSize - 1) / workgroupSize, (destinationExtent.height + workgroupSize - 1) / workgroupSize, 1);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "vkutils.h"
+#include <vector>
+
+//traces at a fraction of the swapchain resolution chosen to hold a frame time, then upscales into the swapchain image
+namespace resolution {
+
+	constexpr uint32_t workgroupSize = 8;
+	//render extents are multiples of this, so that the resolution does not change for every small correction
+	constexpr uint32_t extentGranularity = 8;
+
+	constexpr VkFormat traceFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+	struct ControllerSettings
+	{
+		double targetMilliseconds = 1000.0 / 60.0;
+		//of the swapchain width and height
+		float minScale = .25f;
+		float maxScale = 1.0f;
+		//gains on the error relative to the target, the output is the fraction of the swapchain pixels traced
+		double proportional = .3;
+		double integral = .15;
+		double derivative = .05;
+		//relative errors below it leave the resolution alone
+		double deadband = .05;
+	};
+
+	//incremental PID on the traced pixel count, whose cost the frame time roughly follows
+	//the output is clamped instead of the integral, so it never winds up while the scale sits at a limit
+	class Controller
+	{
+	public:
+
+		ControllerSettings settings = {};
+
+		//frameMilliseconds is the GPU time of a recent frame, returns the scale of the next one
+		float update(double frameMilliseconds);
+		void reset();
+
+		float getScale() const { return scale; }
+
+	private:
+
+		float scale = 1.0f;
+		double pixelRatio = 1.0;
+		double previousError = .0;
+		double previousDelta = .0;
+		uint32_t samples = 0;
+	};
+
+	struct Pipeline
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+	};
+
+	//one descriptor set per source and swapchain image
+	struct Upscaler
+	{
+		size_t sourceCount;
+		VkDescriptorPool descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+	};
+
+	[[nodiscard]]
+	Pipeline createPipeline();
+	void destroyPipeline(Pipeline pipeline);
+
+	//the sources are the images that may hold the finished trace, such as the trace itself and the reconstruction histories
+	[[nodiscard]]
+	Upscaler createUpscaler(const Pipeline &pipeline, const std::vector<VkImageView> &sourceViews, const std::vector<VkImageView> &destinationViews);
+	void destroyUpscaler(Upscaler upscaler);
+
+	//scale times the full extent, rounded to extentGranularity
+	VkExtent2D getRenderExtent(VkExtent2D fullExtent, float scale);
+
+	//Catmull-Rom filter from the top left sourceExtent of the traced image onto the whole destination
+	//the destination has to be in VK_IMAGE_LAYOUT_GENERAL and the trace behind a barrier to the compute stage
+	void recordUpscale(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Upscaler &upscaler, size_t sourceIndex, uint32_t destinationIndex, VkExtent2D sourceExtent, VkExtent2D destinationExtent);
+}
@@ -0,0 +1,73 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+	double toMilliseconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	double smooth(double average, double sample, double weight)
+	{
+		return average == .0 ? sample : average + weight * (sample - average);
+	}
+}
+
+void FramePacer::sleepBeforeInput(double gpuFrameMilliseconds)
+{
+	gpuMilliseconds = smooth(gpuMilliseconds, gpuFrameMilliseconds, smoothing);
+
+	const double sleepMilliseconds = gpuMilliseconds - hostMilliseconds - safetyMilliseconds;
+	if (sleepMilliseconds <= .0) return;
+
+	std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleepMilliseconds));
+}
+
+void FramePacer::inputSampled()
+{
+	inputTime = Clock::now();
+}
+
+void FramePacer::frameSubmitted(uint64_t value)
+{
+	hostMilliseconds = smooth(hostMilliseconds, toMilliseconds(Clock::now() - inputTime), smoothing);
+	pendingFrames.push_back({ value, inputTime });
+}
+
+void FramePacer::framesCompleted(uint64_t value)
+{
+	const Clock::time_point now = Clock::now();
+	while (!pendingFrames.empty() && pendingFrames.front().value <= value)
+	{
+		lastLatency = toMilliseconds(now - pendingFrames.front().inputTime);
+		latencySum += lastLatency;
+		maxLatency = std::max(maxLatency, lastLatency);
+		pendingFrames.pop_front();
+
+		if (frameCount == 0) firstCompletion = now;
+		lastCompletion = now;
+		frameCount++;
+	}
+}
+
+FramePacer::Stats FramePacer::getStats() const
+{
+	return Stats
+	{
+		.frameCount = frameCount,
+		.averageLatencyMilliseconds = frameCount == 0 ? .0 : latencySum / static_cast<double>(frameCount),
+		.maxLatencyMilliseconds = maxLatency,
+		.lastLatencyMilliseconds = lastLatency,
+		.averageFrameMilliseconds = frameCount < 2 ? .0 : toMilliseconds(lastCompletion - firstCompletion) / static_cast<double>(frameCount - 1U)
+	};
+}
+
+void FramePacer::resetStats()
+{
+	frameCount = 0;
+	latencySum = .0;
+	maxLatency = .0;
+	lastLatency = .0;
+}
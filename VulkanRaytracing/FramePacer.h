@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+//host side frame pacing and input latency tracking
+//latency runs from sampling the input of a frame until the host saw the frame complete on the GPU, presentation adds the time until scanout on top
+class FramePacer
+{
+public:
+
+	struct Stats
+	{
+		uint64_t frameCount;
+		double averageLatencyMilliseconds;
+		double maxLatencyMilliseconds;
+		double lastLatencyMilliseconds;
+		//between consecutive completions
+		double averageFrameMilliseconds;
+	};
+
+	//call right after the frame ahead of the GPU's current one completed, gpuFrameMilliseconds is how long the GPU took for a recent frame
+	//sleeps for the time the GPU still needs for its current frame, minus what the host needs to sample input, record and submit
+	void sleepBeforeInput(double gpuFrameMilliseconds);
+
+	void inputSampled();
+	//the frame whose input was sampled last signals value once done
+	void frameSubmitted(uint64_t value);
+	//the host learnt the timeline reached value
+	void framesCompleted(uint64_t value);
+
+	Stats getStats() const;
+	void resetStats();
+
+private:
+
+	using Clock = std::chrono::steady_clock;
+
+	struct PendingFrame
+	{
+		uint64_t value;
+		Clock::time_point inputTime;
+	};
+
+	//weight of the newest sample in the running averages used for the prediction
+	static constexpr double smoothing = .1;
+	//sleeping is coarse, this much earlier is better than a GPU waiting for the host
+	static constexpr double safetyMilliseconds = 1.0;
+
+	std::deque<PendingFrame> pendingFrames;
+	Clock::time_point inputTime = {};
+	double hostMilliseconds = .0;
+	double gpuMilliseconds = .0;
+
+	uint64_t frameCount = 0;
+	double latencySum = .0;
+	double maxLatency = .0;
+	double lastLatency = .0;
+	Clock::time_point firstCompletion = {};
+	Clock::time_point lastCompletion = {};
+};
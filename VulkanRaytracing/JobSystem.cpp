@@ -0,0 +1,294 @@
+#include "JobSystem.h"
+#include <assert.h>
+#include <algorithm>
+#include "Logger/Logger.h"
+
+namespace {
+	//identifies the pool and deque a worker thread belongs to
+	thread_local const JobSystem *currentSystem = nullptr;
+	thread_local uint32_t currentWorker = 0;
+
+	template<typename T>
+	T *popFront(std::mutex &mutex, std::deque<T *> &tasks)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (tasks.empty()) return nullptr;
+
+		T *task = tasks.front();
+		tasks.pop_front();
+		return task;
+	}
+}
+
+JobSystem::JobSystem(uint32_t workerCount) : mainThread(std::this_thread::get_id())
+{
+	deques.resize(workerCount);
+	for (std::unique_ptr<WorkStealingDeque<Task>> &deque : deques)
+	{
+		deque = std::make_unique<WorkStealingDeque<Task>>();
+	}
+
+	workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+
+	LOG_TRIVIAL_FORMATTED("Created job system with %u workers! ", workerCount);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	wake.notify_all();
+
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+
+	assert(sharedTasks.empty() && mainThreadTasks.empty());
+}
+
+uint32_t JobSystem::getDefaultWorkerCount()
+{
+	uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void JobSystem::push(Task *task)
+{
+	//counted before it becomes visible so that a thief never sees the count go below zero
+	queuedTasks++;
+
+	if (currentSystem == this)
+	{
+		deques[currentWorker]->push(task);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(sharedMutex);
+		sharedTasks.push_back(task);
+	}
+
+	//a worker going to sleep counts itself before checking queuedTasks, so one of the two sees the other
+	if (sleepingWorkers > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wake.notify_one();
+	}
+}
+
+void JobSystem::run(Counter &counter, Job job)
+{
+	counter.pending++;
+	push(new Task{ .job = std::move(job), .counter = &counter });
+}
+
+void JobSystem::runAfter(Counter &dependency, Counter &counter, Job job)
+{
+	counter.pending++;
+	Task *task = new Task{ .job = std::move(job), .counter = &counter };
+
+	{
+		std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+		if (dependency.pending > 0)
+		{
+			dependency.continuations.push_back([this, task]() { push(task); });
+			return;
+		}
+	}
+	push(task);
+}
+
+void JobSystem::runAfter(std::initializer_list<Counter *> dependencies, Counter &counter, Job job)
+{
+	//one extra count so that the job cannot start before every dependency has been registered
+	struct Join
+	{
+		std::atomic<uint32_t> remaining;
+		Task *task;
+	};
+
+	counter.pending++;
+	Join *join = new Join{ .remaining = static_cast<uint32_t>(dependencies.size()) + 1, .task = new Task{ .job = std::move(job), .counter = &counter } };
+	auto arrive = [this, join]()
+	{
+		if (join->remaining.fetch_sub(1) != 1) return;
+		push(join->task);
+		delete join;
+	};
+
+	for (Counter *dependency : dependencies)
+	{
+		std::unique_lock<std::mutex> lock(dependency->continuationMutex);
+		if (dependency->pending > 0)
+		{
+			dependency->continuations.push_back(arrive);
+			continue;
+		}
+		lock.unlock();
+		arrive();
+	}
+	arrive();
+}
+
+void JobSystem::runOnMainThread(Counter &counter, Job job)
+{
+	counter.pending++;
+	std::lock_guard<std::mutex> lock(mainThreadMutex);
+	mainThreadTasks.push_back(new Task{ .job = std::move(job), .counter = &counter });
+}
+
+void JobSystem::runMainThreadJobs()
+{
+	assert(isMainThread());
+	while (Task *task = popFront(mainThreadMutex, mainThreadTasks))
+	{
+		execute(task);
+	}
+}
+
+void JobSystem::finish(Counter &counter)
+{
+	uint32_t pending = counter.pending.load();
+	while (pending > 1)
+	{
+		if (counter.pending.compare_exchange_weak(pending, pending - 1)) return;
+	}
+
+	//possibly the last job, which takes the continuations under the lock so that a waiter that saw zero cannot destroy the counter before
+	std::vector<Job> continuations = {};
+	{
+		std::lock_guard<std::mutex> lock(counter.continuationMutex);
+		if (counter.pending.fetch_sub(1) != 1) return;
+		continuations.swap(counter.continuations);
+	}
+
+	for (Job &continuation : continuations)
+	{
+		continuation();
+	}
+}
+
+void JobSystem::execute(Task *task)
+{
+	task->job();
+	Counter &counter = *task->counter;
+	delete task;
+	finish(counter);
+}
+
+JobSystem::Task *JobSystem::takeTask()
+{
+	const bool isWorker = currentSystem == this;
+	const uint32_t dequeCount = static_cast<uint32_t>(deques.size());
+
+	//newest job of our own deque first, it is the most likely to still be in cache
+	Task *task = isWorker ? deques[currentWorker]->pop() : nullptr;
+	if (task == nullptr) task = popFront(sharedMutex, sharedTasks);
+
+	//otherwise steal the oldest job of another worker, which tends to be the largest
+	const uint32_t firstVictim = isWorker ? currentWorker + 1 : 0;
+	for (uint32_t offset = 0; task == nullptr && offset < dequeCount; offset++)
+	{
+		const uint32_t victim = (firstVictim + offset) % dequeCount;
+		if (isWorker && victim == currentWorker) continue;
+		task = deques[victim]->steal();
+	}
+
+	if (task != nullptr) queuedTasks--;
+	return task;
+}
+
+bool JobSystem::tryRunTask()
+{
+	if (isMainThread())
+	{
+		if (Task *task = popFront(mainThreadMutex, mainThreadTasks))
+		{
+			execute(task);
+			return true;
+		}
+	}
+
+	Task *task = takeTask();
+	if (task == nullptr) return false;
+
+	execute(task);
+	return true;
+}
+
+void JobSystem::wait(Counter &counter)
+{
+	while (counter.pending > 0)
+	{
+		if (!tryRunTask())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	//the last job may still be handing out the continuations
+	std::lock_guard<std::mutex> lock(counter.continuationMutex);
+}
+
+bool JobSystem::hasQueuedWork()
+{
+	if (currentSystem == this) return !deques[currentWorker]->isEmpty();
+
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	return !sharedTasks.empty();
+}
+
+//lazy binary splitting : half of what is left is handed out whenever the previous half was taken
+void JobSystem::runRange(Counter &counter, uint32_t begin, uint32_t end, uint32_t grainSize, const RangeBody &body)
+{
+	while (begin < end)
+	{
+		if (end - begin > grainSize && !hasQueuedWork())
+		{
+			const uint32_t middle = begin + (end - begin) / 2;
+			run(counter, [this, &counter, middle, end, grainSize, &body]() { runRange(counter, middle, end, grainSize, body); });
+			end = middle;
+		}
+
+		const uint32_t chunkEnd = std::min(begin + grainSize, end);
+		body(begin, chunkEnd);
+		begin = chunkEnd;
+	}
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &body)
+{
+	if (grainSize == 0)
+	{
+		const uint32_t threadCount = getWorkerCount() + 1;
+		grainSize = std::max(count / (threadCount * 8), 1U);
+	}
+
+	Counter counter = {};
+	runRange(counter, 0, count, grainSize, body);
+	wait(counter);
+}
+
+void JobSystem::workerLoop(uint32_t worker)
+{
+	currentSystem = this;
+	currentWorker = worker;
+
+	while (running)
+	{
+		if (tryRunTask()) continue;
+
+		sleepingWorkers++;
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [this]() { return queuedTasks > 0 || !running; });
+		}
+		sleepingWorkers--;
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "WorkStealingDeque.h"
+
+//pool of worker threads, each owning a Chase-Lev deque of jobs
+//owners pop from the bottom of their own deque, idle workers steal from the top of the others
+//threads outside the pool submit through a shared queue, and the thread that created the pool has a queue of its own for jobs only it may run
+class JobSystem
+{
+public:
+
+	using Job = std::function<void()>;
+
+	//number of jobs of a group that have not finished yet, and the jobs to start once it reaches zero
+	struct Counter
+	{
+		std::atomic<uint32_t> pending = 0;
+		std::mutex continuationMutex;
+		std::vector<Job> continuations;
+	};
+
+	explicit JobSystem(uint32_t workerCount = getDefaultWorkerCount());
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	//jobs may themselves run and wait on other jobs
+	void run(Counter &counter, Job job);
+
+	//starts job once dependency reaches zero, job counts in counter from now on
+	void runAfter(Counter &dependency, Counter &counter, Job job);
+
+	//starts job once every dependency reached zero
+	void runAfter(std::initializer_list<Counter *> dependencies, Counter &counter, Job job);
+
+	//for GLFW and anything else that must only be called from the thread that created the job system
+	//these jobs run in runMainThreadJobs or while that thread waits
+	void runOnMainThread(Counter &counter, Job job);
+	void runMainThreadJobs();
+	bool isMainThread() const { return std::this_thread::get_id() == mainThread; }
+
+	//the calling thread executes pending jobs until the counter reaches zero
+	void wait(Counter &counter);
+
+	//calls body on ranges of [0, count) no smaller than grainSize, or about an eighth of a thread's share if grainSize is zero
+	//the range is only split when the thread running it has no queued work left, which means other threads took it, so the split adapts to the load
+	void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &body);
+
+	uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+	//one worker per hardware thread besides the calling one
+	static uint32_t getDefaultWorkerCount();
+
+private:
+
+	struct Task
+	{
+		Job job;
+		Counter *counter;
+	};
+
+	using RangeBody = std::function<void(uint32_t begin, uint32_t end)>;
+
+	//one per worker, only pushed to and popped from by its worker
+	std::vector<std::unique_ptr<WorkStealingDeque<Task>>> deques;
+	//jobs run from threads outside the pool
+	std::mutex sharedMutex;
+	std::deque<Task *> sharedTasks;
+	std::mutex mainThreadMutex;
+	std::deque<Task *> mainThreadTasks;
+	std::thread::id mainThread;
+	std::vector<std::thread> workers;
+
+	std::atomic<bool> running = true;
+	//jobs any worker may take, so that idle ones know when to wake up
+	std::atomic<uint32_t> queuedTasks = 0;
+	std::atomic<uint32_t> sleepingWorkers = 0;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+
+	void push(Task *task);
+	Task *takeTask();
+	bool tryRunTask();
+	void execute(Task *task);
+	void finish(Counter &counter);
+	bool hasQueuedWork();
+	void runRange(Counter &counter, uint32_t begin, uint32_t end, uint32_t grainSize, const RangeBody &body);
+	void workerLoop(uint32_t worker);
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include "Bvh.h"
+#include <bit>
+#include <cmath>
+#include <emmintrin.h>
+
+//coherent rays traversing a hierarchy together
+namespace bvh
+{
+	//stored structure-of-arrays so that the rays are tested four at a time with SSE2, which every x64 CPU has
+	template<uint32_t Size>
+	struct alignas(16) RayPacket
+	{
+		static_assert(Size % 4 == 0 && Size <= 32, "whole SSE lanes, one bit per ray in a mask");
+		static constexpr uint32_t allRays = static_cast<uint32_t>((uint64_t(1) << Size) - 1);
+
+		float origin[3][Size];
+		float direction[3][Size];
+		float inverseDirection[3][Size];
+		//origin * inverseDirection, so that a plane distance is a multiply and a subtract
+		float scaledOrigin[3][Size];
+		//shrinks as hits are found, a ray is terminated by moving it below tMin
+		float tMax[Size];
+		float tMin;
+
+		void setRay(uint32_t ray, const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection, float rayTMax)
+		{
+			for (glm::length_t axis = 0; axis < 3; axis++)
+			{
+				origin[axis][ray] = rayOrigin[axis];
+				direction[axis][ray] = rayDirection[axis];
+				inverseDirection[axis][ray] = 1.0f / rayDirection[axis];
+				scaledOrigin[axis][ray] = rayOrigin[axis] * inverseDirection[axis][ray];
+			}
+			tMax[ray] = rayTMax;
+		}
+
+		glm::vec3 getOrigin(uint32_t ray) const { return glm::vec3(origin[0][ray], origin[1][ray], origin[2][ray]); }
+		glm::vec3 getDirection(uint32_t ray) const { return glm::vec3(direction[0][ray], direction[1][ray], direction[2][ray]); }
+		bool isActive(uint32_t ray) const { return tMax[ray] >= tMin; }
+	};
+
+	//rays [4 * lane group, 4 * lane group + 4) of a mask
+	inline uint32_t getLaneGroupMask(uint32_t rayMask, uint32_t laneGroup)
+	{
+		return (rayMask >> (laneGroup * 4)) & 0xF;
+	}
+
+	//interval bounds of the origins and inverse directions of the active rays of a packet, one axis per SSE lane
+	//only usable when they all point into the same octant, the near plane of each axis is then shared
+	template<uint32_t Size>
+	struct PacketFrustum
+	{
+		bool valid;
+		//all ones on the axes the rays enter through the lower plane
+		__m128 nearIsLower;
+		__m128 originMin, originMax;
+		__m128 inverseDirectionMin, inverseDirectionMax;
+		//the padding lane holds tMin in entries and tMax in exits so that it never decides the result
+		__m128 entryPadding, exitPadding;
+
+		explicit PacketFrustum(const RayPacket<Size> &packet)
+		{
+			uint32_t firstRay = 0;
+			while (firstRay < Size && !packet.isActive(firstRay)) firstRay++;
+			valid = firstRay < Size;
+			if (!valid) return;
+
+			float tMax = packet.tMax[firstRay];
+			bool lower[3];
+			float bounds[4][3];
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				lower[axis] = packet.inverseDirection[axis][firstRay] >= .0f;
+				bounds[0][axis] = bounds[1][axis] = packet.origin[axis][firstRay];
+				bounds[2][axis] = bounds[3][axis] = packet.inverseDirection[axis][firstRay];
+			}
+
+			for (uint32_t ray = firstRay; ray < Size; ray++)
+			{
+				if (!packet.isActive(ray)) continue;
+
+				tMax = std::max(tMax, packet.tMax[ray]);
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					//an infinite inverse direction would turn the interval products into NaN
+					const float inverseDirection = packet.inverseDirection[axis][ray];
+					if ((inverseDirection >= .0f) != lower[axis] || std::abs(inverseDirection) == std::numeric_limits<float>::infinity()) valid = false;
+					bounds[0][axis] = std::min(bounds[0][axis], packet.origin[axis][ray]);
+					bounds[1][axis] = std::max(bounds[1][axis], packet.origin[axis][ray]);
+					bounds[2][axis] = std::min(bounds[2][axis], inverseDirection);
+					bounds[3][axis] = std::max(bounds[3][axis], inverseDirection);
+				}
+			}
+
+			nearIsLower = _mm_castsi128_ps(_mm_setr_epi32(lower[0] ? -1 : 0, lower[1] ? -1 : 0, lower[2] ? -1 : 0, 0));
+			originMin = _mm_setr_ps(bounds[0][0], bounds[0][1], bounds[0][2], .0f);
+			originMax = _mm_setr_ps(bounds[1][0], bounds[1][1], bounds[1][2], .0f);
+			inverseDirectionMin = _mm_setr_ps(bounds[2][0], bounds[2][1], bounds[2][2], .0f);
+			inverseDirectionMax = _mm_setr_ps(bounds[3][0], bounds[3][1], bounds[3][2], .0f);
+			entryPadding = _mm_setr_ps(.0f, .0f, .0f, packet.tMin);
+			exitPadding = _mm_setr_ps(.0f, .0f, .0f, tMax);
+		}
+
+		//true only if no ray of the packet can reach the node
+		bool misses(const Node &node) const
+		{
+			if (!valid) return false;
+
+			//the fourth lanes hold offset and primitiveCount, cleared by the zero inverse directions there
+			const __m128 lowerPlanes = _mm_loadu_ps(&node.boundsMin.x);
+			const __m128 upperPlanes = _mm_loadu_ps(&node.boundsMax.x);
+			const __m128 nearPlanes = _mm_or_ps(_mm_and_ps(nearIsLower, lowerPlanes), _mm_andnot_ps(nearIsLower, upperPlanes));
+			const __m128 farPlanes = _mm_or_ps(_mm_andnot_ps(nearIsLower, lowerPlanes), _mm_and_ps(nearIsLower, upperPlanes));
+
+			//interval products of (plane - origin) and inverseDirection
+			const __m128 nearFromMin = _mm_sub_ps(nearPlanes, originMin);
+			const __m128 nearFromMax = _mm_sub_ps(nearPlanes, originMax);
+			const __m128 farFromMin = _mm_sub_ps(farPlanes, originMin);
+			const __m128 farFromMax = _mm_sub_ps(farPlanes, originMax);
+			__m128 entry = _mm_min_ps(
+				_mm_min_ps(_mm_mul_ps(nearFromMin, inverseDirectionMin), _mm_mul_ps(nearFromMin, inverseDirectionMax)),
+				_mm_min_ps(_mm_mul_ps(nearFromMax, inverseDirectionMin), _mm_mul_ps(nearFromMax, inverseDirectionMax)));
+			__m128 exit = _mm_max_ps(
+				_mm_max_ps(_mm_mul_ps(farFromMin, inverseDirectionMin), _mm_mul_ps(farFromMin, inverseDirectionMax)),
+				_mm_max_ps(_mm_mul_ps(farFromMax, inverseDirectionMin), _mm_mul_ps(farFromMax, inverseDirectionMax)));
+
+			//the padding lane is zero after the products, adding the padding puts tMin and tMax there
+			entry = _mm_add_ps(entry, entryPadding);
+			exit = _mm_add_ps(exit, exitPadding);
+			entry = _mm_max_ps(entry, _mm_shuffle_ps(entry, entry, _MM_SHUFFLE(2, 3, 0, 1)));
+			entry = _mm_max_ps(entry, _mm_shuffle_ps(entry, entry, _MM_SHUFFLE(1, 0, 3, 2)));
+			exit = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(2, 3, 0, 1)));
+			exit = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(1, 0, 3, 2)));
+			return _mm_comigt_ss(entry, exit) != 0;
+		}
+	};
+
+	//slab test of the rays of rayMask, four at a time, skipping the groups of four none of which is in the mask
+	//returns one bit per ray that enters the node within its interval and writes the entry distances of the groups tested
+	template<uint32_t Size>
+	uint32_t intersectNode(const Node &node, const RayPacket<Size> &packet, uint32_t rayMask, float *entries)
+	{
+		const __m128 boundsMin[3] = { _mm_set1_ps(node.boundsMin.x), _mm_set1_ps(node.boundsMin.y), _mm_set1_ps(node.boundsMin.z) };
+		const __m128 boundsMax[3] = { _mm_set1_ps(node.boundsMax.x), _mm_set1_ps(node.boundsMax.y), _mm_set1_ps(node.boundsMax.z) };
+
+		uint32_t mask = 0;
+		for (uint32_t laneGroup = 0; laneGroup < Size / 4; laneGroup++)
+		{
+			if (getLaneGroupMask(rayMask, laneGroup) == 0) continue;
+
+			const uint32_t firstRay = laneGroup * 4;
+			__m128 entry = _mm_set1_ps(packet.tMin);
+			__m128 exit = _mm_load_ps(&packet.tMax[firstRay]);
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const __m128 inverseDirection = _mm_load_ps(&packet.inverseDirection[axis][firstRay]);
+				const __m128 scaledOrigin = _mm_load_ps(&packet.scaledOrigin[axis][firstRay]);
+				const __m128 t0 = _mm_sub_ps(_mm_mul_ps(boundsMin[axis], inverseDirection), scaledOrigin);
+				const __m128 t1 = _mm_sub_ps(_mm_mul_ps(boundsMax[axis], inverseDirection), scaledOrigin);
+				entry = _mm_max_ps(_mm_min_ps(t0, t1), entry);
+				exit = _mm_min_ps(_mm_max_ps(t0, t1), exit);
+			}
+
+			_mm_store_ps(&entries[firstRay], entry);
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry, exit))) << firstRay;
+		}
+
+		return mask & rayMask;
+	}
+
+	//visits the leaves any ray of the packet reaches, culling whole subtrees with the packet frustum first
+	//intersectPrimitive(primitive, rayMask) tests the rays of the mask and shrinks their tMax
+	template<uint32_t Size, typename IntersectPrimitive>
+	void traversePacket(const Hierarchy &hierarchy, RayPacket<Size> &packet, IntersectPrimitive &&intersectPrimitive)
+	{
+		struct StackEntry
+		{
+			uint32_t node;
+			uint32_t rayMask;
+		};
+
+		if (hierarchy.nodes.empty()) return;
+
+		const PacketFrustum<Size> frustum = PacketFrustum<Size>(packet);
+		const std::vector<Node> &nodes = hierarchy.nodes;
+
+		alignas(16) float entries[2][Size];
+		auto intersectChild = [&](uint32_t child, uint32_t parentMask, float *childEntries)
+		{
+			if (frustum.misses(nodes[child])) return 0U;
+			return intersectNode(nodes[child], packet, parentMask, childEntries);
+		};
+
+		StackEntry stack[maxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		uint32_t rayMask = intersectChild(0, RayPacket<Size>::allRays, entries[0]);
+		if (rayMask == 0) return;
+
+		while (true)
+		{
+			const Node &node = nodes[nodeIndex];
+			if (!node.isLeaf())
+			{
+				uint32_t nearChild = nodeIndex + 1;
+				uint32_t farChild = node.offset;
+				//rays missing a node miss its children, so only the ones that reached it are tested
+				uint32_t nearMask = intersectChild(nearChild, rayMask, entries[0]);
+				uint32_t farMask = intersectChild(farChild, rayMask, entries[1]);
+
+				//the lowest ray reaching either child decides which one is visited first
+				if ((nearMask | farMask) != 0)
+				{
+					const uint32_t ray = static_cast<uint32_t>(std::countr_zero(nearMask | farMask));
+					const bool farFirst = (farMask >> ray & 1) && (!(nearMask >> ray & 1) || entries[1][ray] < entries[0][ray]);
+					if (farFirst)
+					{
+						std::swap(nearChild, farChild);
+						std::swap(nearMask, farMask);
+					}
+
+					if (farMask != 0) stack[stackSize++] = StackEntry{ .node = farChild, .rayMask = farMask };
+					nodeIndex = nearChild;
+					rayMask = nearMask;
+					continue;
+				}
+			}
+			else
+			{
+				for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; i++)
+				{
+					intersectPrimitive(hierarchy.primitives[i], rayMask);
+				}
+			}
+
+			if (stackSize == 0) break;
+			const StackEntry &entry = stack[--stackSize];
+			nodeIndex = entry.node;
+			rayMask = entry.rayMask;
+		}
+	}
+}
@@ -0,0 +1,289 @@
+#include "RayQueries.h"
+#include <assert.h>
+#include "Logger/Logger.h"
+#include <cstring>
+
+namespace {
+
+	//matches the push constant block in visibilityQuery.glsl
+	struct PushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t aoSamples;
+		float aoRadius;
+		float sunX;
+		float sunY;
+		float sunZ;
+		uint32_t seed;
+		uint32_t cursorX;
+		uint32_t cursorY;
+	};
+
+	//the raygen, visibility and pick kernels all read the push constants
+	constexpr VkShaderStageFlags pushConstantStages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+
+	//shader and group indices of the ray tracing pipeline, the first hit goes through the shaders of raytrace.rgen
+	constexpr uint32_t raygenShaderIndex = 0;
+	constexpr uint32_t missShaderIndex = 1;
+	constexpr uint32_t visibilityMissShaderIndex = 2;
+	constexpr uint32_t closestHitShaderIndex = 3;
+	constexpr uint32_t shaderCount = 4;
+
+	VkPipeline createKernel(VkPipelineLayout layout, const char *shaderPath)
+	{
+		VkShaderModule shaderModule = vkut::common::createShaderModule(shaderPath);
+		VkPipeline pipeline = vkut::common::createComputePipeline(layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+		return pipeline;
+	}
+
+	VkPipeline createTracePipeline(VkPipelineLayout layout)
+	{
+		const char *shaderPaths[shaderCount] =
+		{
+			"../Assets/shaders/visibilityQuery.rgen.spv",
+			"../Assets/shaders/raytrace.rmiss.spv",
+			"../Assets/shaders/visibilityQuery.rmiss.spv",
+			"../Assets/shaders/raytrace.rchit.spv"
+		};
+		const VkShaderStageFlagBits stages[shaderCount] =
+		{
+			VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_SHADER_STAGE_MISS_BIT_KHR, VK_SHADER_STAGE_MISS_BIT_KHR, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR
+		};
+
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = std::vector<VkPipelineShaderStageCreateInfo>(shaderCount);
+		for (uint32_t i = 0; i < shaderCount; i++)
+		{
+			shaderStages[i] = vkut::raytracing::getShaderStageCreateInfo(vkut::common::createShaderModule(shaderPaths[i]), stages[i]);
+		}
+
+		std::vector<VkRayTracingShaderGroupCreateInfoKHR> shaderGroups =
+		{
+			vkut::raytracing::getShaderGroupCreateInfo(vkut::raytracing::ShaderGroupType::RAY_GENERATION, raygenShaderIndex),
+			vkut::raytracing::getShaderGroupCreateInfo(vkut::raytracing::ShaderGroupType::MISS, missShaderIndex),
+			vkut::raytracing::getShaderGroupCreateInfo(vkut::raytracing::ShaderGroupType::MISS, visibilityMissShaderIndex),
+			vkut::raytracing::getShaderGroupCreateInfo(vkut::raytracing::ShaderGroupType::CLOSEST_HIT, closestHitShaderIndex),
+		};
+
+		VkPipeline pipeline = vkut::raytracing::createPipeline(layout, shaderStages, shaderGroups);
+
+		for (const VkPipelineShaderStageCreateInfo &shaderStage : shaderStages)
+		{
+			vkut::common::destroyShaderModule(shaderStage.module);
+		}
+		return pipeline;
+	}
+
+	PushConstants getPushConstants(VkExtent2D extent, uint32_t seed, const queries::Settings &settings, VkOffset2D cursor)
+	{
+		return PushConstants
+		{
+			.width = extent.width,
+			.height = extent.height,
+			.aoSamples = settings.aoSamples,
+			.aoRadius = settings.aoRadius,
+			.sunX = settings.sunDirection.x,
+			.sunY = settings.sunDirection.y,
+			.sunZ = settings.sunDirection.z,
+			.seed = seed,
+			.cursorX = static_cast<uint32_t>(cursor.x),
+			.cursorY = static_cast<uint32_t>(cursor.y)
+		};
+	}
+
+	//the scene set is set 0, as in raytrace.rgen
+	void bindSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, const queries::Pipelines &pipelines, VkDescriptorSet sceneSet, VkDescriptorSet querySet,
+		uint32_t cameraOffset)
+	{
+		const VkDescriptorSet sets[] = { sceneSet, querySet };
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelines.layout, 0, 2, sets, 1, &cameraOffset);
+	}
+}
+
+namespace queries {
+
+	Pipelines createPipelines(VkCommandPool commandPool, VkDescriptorSetLayout sceneLayout)
+	{
+		Pipelines pipelines = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings =
+		{
+			VkDescriptorSetLayoutBinding
+			{
+				.binding = 0,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+				.pImmutableSamplers = nullptr,
+			},
+			VkDescriptorSetLayoutBinding
+			{
+				.binding = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			}
+		};
+		pipelines.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = pushConstantStages,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipelines.layout = vkut::common::createPipelineLayout({ sceneLayout, pipelines.descriptorSetLayout }, { pushConstantRange });
+
+		pipelines.visibility = createKernel(pipelines.layout, "../Assets/shaders/visibilityQuery.comp.spv");
+		pipelines.pick = createKernel(pipelines.layout, "../Assets/shaders/pickQuery.comp.spv");
+		pipelines.tracePipeline = createTracePipeline(pipelines.layout);
+		pipelines.shaderBindingTable = vkut::raytracing::createShaderBindingTable(commandPool, pipelines.tracePipeline,
+			{ raygenShaderIndex, missShaderIndex, visibilityMissShaderIndex, closestHitShaderIndex });
+
+		return pipelines;
+	}
+
+	void destroyPipelines(Pipelines pipelines)
+	{
+		vkut::raytracing::destroyShaderBindingTable(pipelines.shaderBindingTable);
+		vkut::common::destroyPipeline(pipelines.tracePipeline);
+		vkut::common::destroyPipeline(pipelines.pick);
+		vkut::common::destroyPipeline(pipelines.visibility);
+		vkut::common::destroyPipelineLayout(pipelines.layout);
+		vkut::common::destroyDescriptorSetLayout(pipelines.descriptorSetLayout);
+	}
+
+	Targets createTargets(VkCommandPool commandPool, const Pipelines &pipelines, VkExtent2D extent, size_t framesInFlight)
+	{
+		const uint32_t setCount = static_cast<uint32_t>(framesInFlight);
+		Targets targets
+		{
+			.result = vkut::common::createStorageImage(commandPool, extent, resultFormat),
+			.pickBuffer = vkut::common::createPersistentBuffer(sizeof(PickResult), setCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+			.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }, setCount, setCount),
+			.descriptorSets = std::vector<VkDescriptorSet>(framesInFlight)
+		};
+
+		VkDescriptorImageInfo resultInfo
+		{
+			.sampler = VK_NULL_HANDLE,
+			.imageView = targets.result.view,
+			.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+		};
+
+		for (uint32_t i = 0; i < setCount; i++)
+		{
+			VkDescriptorBufferInfo pickInfo
+			{
+				.buffer = targets.pickBuffer.buffer.buffer,
+				.offset = vkut::common::getRegionOffset(targets.pickBuffer, i),
+				.range = targets.pickBuffer.regionSize
+			};
+
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos =
+			{
+				vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = 0,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+					.pImageInfo = &resultInfo,
+					.pBufferInfo = nullptr,
+					.pTexelBufferView = nullptr
+				},
+				vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = 1,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+					.pImageInfo = nullptr,
+					.pBufferInfo = &pickInfo,
+					.pTexelBufferView = nullptr
+				}
+			};
+			targets.descriptorSets[i] = vkut::common::createDescriptorSet(pipelines.descriptorSetLayout, targets.descriptorPool, descriptorSetInfos);
+		}
+
+		Logger::logMessageFormatted("Created ray query targets of %ux%u! ", extent.width, extent.height);
+
+		return targets;
+	}
+
+	void destroyTargets(Targets targets)
+	{
+		vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		vkut::common::destroyPersistentBuffer(targets.pickBuffer);
+		vkut::common::destroyStorageImage(targets.result);
+	}
+
+	void recordVisibility(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		VkDescriptorSet sceneSet, uint32_t cameraOffset, VkExtent2D extent, uint32_t seed, const Settings &settings)
+	{
+		assert(extent.width <= targets.result.extent.width && extent.height <= targets.result.extent.height);
+
+		const VkPipelineStageFlagBits stage = settings.usePipeline ? VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		const VkPipelineBindPoint bindPoint = settings.usePipeline ? VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR : VK_PIPELINE_BIND_POINT_COMPUTE;
+
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+		vkut::common::resetTimestamps(commandBuffer, timestamps, firstTimestamp, timestampsPerFrame);
+
+		//the previous frame may still be reading the result
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, stage);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp, stage);
+
+		vkCmdBindPipeline(commandBuffer, bindPoint, settings.usePipeline ? pipelines.tracePipeline : pipelines.visibility);
+		bindSets(commandBuffer, bindPoint, pipelines, sceneSet, targets.descriptorSets[frame], cameraOffset);
+		const PushConstants pushConstants = getPushConstants(extent, seed, settings, {});
+		vkCmdPushConstants(commandBuffer, pipelines.layout, pushConstantStages, 0, sizeof(PushConstants), &pushConstants);
+
+		if (settings.usePipeline)
+		{
+			const vkut::raytracing::ShaderBindingTableRegion raygenBufferRegion = vkut::raytracing::getShaderBindingTableRegion(pipelines.shaderBindingTable, raygenShaderIndex, 1);
+			const vkut::raytracing::ShaderBindingTableRegion missBufferRegion = vkut::raytracing::getShaderBindingTableRegion(pipelines.shaderBindingTable, missShaderIndex, 2);
+			const vkut::raytracing::ShaderBindingTableRegion hitGroupBufferRegion = vkut::raytracing::getShaderBindingTableRegion(pipelines.shaderBindingTable, closestHitShaderIndex, 1);
+			const vkut::raytracing::ShaderBindingTableRegion callableBufferRegion = vkut::raytracing::getShaderBindingTableRegion(pipelines.shaderBindingTable, 0, 0);
+			vkut::raytracing::vkCmdTraceRaysKHR(commandBuffer, &raygenBufferRegion, &missBufferRegion, &hitGroupBufferRegion, &callableBufferRegion, extent.width, extent.height, 1);
+		}
+		else
+		{
+			vkCmdDispatch(commandBuffer, (extent.width + workgroupSize - 1) / workgroupSize, (extent.height + workgroupSize - 1) / workgroupSize, 1);
+		}
+
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp + 1U, stage);
+		vkut::common::recordShaderBarrier(commandBuffer, stage, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	}
+
+	void recordPick(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, size_t frame,
+		VkDescriptorSet sceneSet, uint32_t cameraOffset, VkExtent2D extent, VkOffset2D pixel)
+	{
+		assert(pixel.x >= 0 && pixel.y >= 0 && static_cast<uint32_t>(pixel.x) < extent.width && static_cast<uint32_t>(pixel.y) < extent.height);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.pick);
+		bindSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines, sceneSet, targets.descriptorSets[frame], cameraOffset);
+		const PushConstants pushConstants = getPushConstants(extent, 0, Settings{}, pixel);
+		vkCmdPushConstants(commandBuffer, pipelines.layout, pushConstantStages, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, 1, 1, 1);
+	}
+
+	PickResult getPick(const Targets &targets, size_t frame)
+	{
+		const uint32_t region = static_cast<uint32_t>(frame);
+		vkut::common::invalidateRegion(targets.pickBuffer, region, 0, sizeof(PickResult));
+
+		PickResult pick = {};
+		memcpy(&pick, vkut::common::getRegionPointer(targets.pickBuffer, region), sizeof(PickResult));
+		return pick;
+	}
+
+	double getMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame)
+	{
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+		return vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp, firstTimestamp + 1U);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "vkutils.h"
+#include "glm.hpp"
+#include <vector>
+
+//shadow, ambient occlusion and picking rays traced inline with ray queries from compute shaders, without a shader binding table
+//they read the TLAS, the camera and the scene buffers through the descriptor set of raytrace.rgen, bound as set 0 next to their own set 1,
+//so they need no descriptors of their own for the scene and can be recorded between the other compute passes
+//visibilityQuery.rgen traces the same rays through a ray tracing pipeline to compare against
+namespace queries {
+
+	constexpr uint32_t workgroupSize = 8;
+	constexpr VkFormat resultFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	//before and after the visibility pass
+	constexpr uint32_t timestampsPerFrame = 2;
+
+	struct Settings
+	{
+		//towards the sun, does not have to be normalized
+		glm::vec3 sunDirection = glm::vec3(.4f, 1.0f, .6f);
+		//rays per pixel, 0 leaves the first hit unoccluded
+		uint32_t aoSamples = 4;
+		//occluders further away than this do not darken the first hit
+		float aoRadius = .5f;
+		//traces the visibility pass through visibilityQuery.rgen instead of visibilityQuery.comp
+		bool usePipeline = false;
+	};
+
+	//both kernels and the ray tracing pipeline share the pipeline layout
+	struct Pipelines
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline visibility;
+		VkPipeline pick;
+		VkPipeline tracePipeline;
+		vkut::raytracing::ShaderBindingTable shaderBindingTable;
+	};
+
+	//matches the Pick block in pickQuery.comp
+	struct PickResult
+	{
+		uint32_t instance;
+		uint32_t primitive;
+		float distance;
+		uint32_t hit;
+	};
+
+	struct Targets
+	{
+		vkut::StorageImage result;
+		//one region per frame in flight
+		vkut::PersistentBuffer pickBuffer;
+		VkDescriptorPool descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+	};
+
+	//sceneLayout is the descriptor set layout of raytrace.rgen, its TLAS, camera, material and geometry bindings have to be visible to compute shaders
+	[[nodiscard]]
+	Pipelines createPipelines(VkCommandPool commandPool, VkDescriptorSetLayout sceneLayout);
+	void destroyPipelines(Pipelines pipelines);
+
+	[[nodiscard]]
+	Targets createTargets(VkCommandPool commandPool, const Pipelines &pipelines, VkExtent2D extent, size_t framesInFlight);
+	void destroyTargets(Targets targets);
+
+	//shades the first hit of every pixel of the top left extent of the result by the sun, its shadow and the ambient occlusion
+	//the camera region of the frame in flight is selected through the dynamic offset into sceneSet, seed picks the ambient occlusion directions
+	//the TLAS has to be behind a barrier to the compute and ray tracing stages, the result is behind one to the compute stage when this returns
+	void recordVisibility(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		VkDescriptorSet sceneSet, uint32_t cameraOffset, VkExtent2D extent, uint32_t seed, const Settings &settings);
+
+	//traces the ray through the pixel of the extent, the result is read with getPick once the frame completed
+	void recordPick(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, size_t frame,
+		VkDescriptorSet sceneSet, uint32_t cameraOffset, VkExtent2D extent, VkOffset2D pixel);
+
+	//the frame has to be completed
+	PickResult getPick(const Targets &targets, size_t frame);
+	double getMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame);
+}
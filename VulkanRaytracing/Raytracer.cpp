@@ -2,6 +2,13 @@
 #include <assert.h>
 #include "Logger/Logger.h"
 #include "Files.h"
+#include "Benchmark.h"
+#include "Benchmarks.h"
+#include "CpuRaytracer.h"
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 
 namespace {
@@ -36,6 +43,47 @@ namespace {
 				.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
 		};
 	}
+
+	//matches the push constant block in raytrace.rgen
+	struct TracePushConstants
+	{
+		uint32_t debugView;
+		uint32_t heatmapSamples;
+		uint32_t pattern;
+		uint32_t phase;
+		uint32_t width;
+		uint32_t height;
+		uint32_t jitterOffset;
+		uint32_t bounces;
+		uint32_t tiled;
+	};
+
+	//matches Geometry in pathTracing.glsl
+	struct InstanceGeometry
+	{
+		uint64_t vertexAddress;
+		uint64_t indexAddress;
+	};
+
+	//makes the refit TLAS visible to the trace that follows it, in the pipeline or in the wavefront kernels
+	void recordTraceBarrier(VkCommandBuffer commandBuffer)
+	{
+		VkMemoryBarrier barrier
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+			.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR,
+		};
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr);
+	}
 }
 
 
@@ -46,21 +94,10 @@ void Raytracer::recreateSwapchainDependents()
 		glfwWaitEvents();
 	}
 
-	vkDeviceWaitIdle(vkut::device);
-
-	//destruction
-	vkut::common::destroyCommandBuffers(commandPool, commandBuffers);
-
+	//the frames in flight keep the old descriptor sets and swapchain until they completed
 	vkut::common::destroyDescriptorPool(descriptorPool);
 
-	vkut::setup::destroySwapchainImageViews();
-	vkut::setup::destroySwapChain();
-
-	
-
-	//recreation	
-	vkut::setup::createSwapChain(width, height, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
-	vkut::setup::createSwapchainImageViews();
+	vkut::setup::recreateSwapChain(width, height, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
 
 	VkImageSubresourceRange subresourceRange
 	{
@@ -82,14 +119,40 @@ void Raytracer::recreateSwapchainDependents()
 			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 	}
 
+	//everything traced is sized for the full resolution, lower ones only use part of it
+	vkut::common::destroyStorageImage(traceImage);
+	traceImage = vkut::common::createStorageImage(commandPool, vkut::swapChainExtent, resolution::traceFormat);
+	adaptive::destroyTargets(samplingTargets);
+	samplingTargets = adaptive::createTargets(commandPool, samplingPipeline, vkut::swapChainExtent, framesInFlight);
+	resetAccumulation = true;
+	renderExtent = resolution::getRenderExtent(vkut::swapChainExtent, resolutionController.getScale());
+	reconstruction::destroyTargets(reconstructionTargets);
+	reconstructionTargets = reconstruction::createTargets(commandPool, reconstructionPipeline, vkut::swapChainExtent, traceImage.view, samplingTargets.accumulation.view);
+	historyValid = false;
+	denoiser::destroyTargets(denoiserTargets);
+	denoiserTargets = denoiser::createTargets(commandPool, denoiserPipelines, vkut::swapChainExtent,
+		{ traceImage.view, reconstructionTargets.history[0].view, reconstructionTargets.history[1].view }, reconstructionTargets.motion.view);
+	denoiserHistoryValid = false;
+	queries::destroyTargets(queryTargets);
+	queryTargets = queries::createTargets(commandPool, queryPipelines, vkut::swapChainExtent, framesInFlight);
+	//the pick buffer of the frames in flight is gone, and the pixel clicked may be outside the new extent
+	std::fill(std::begin(pickRecorded), std::end(pickRecorded), false);
+	pickPending = false;
+
+	resolution::destroyUpscaler(upscaler);
+	upscaler = resolution::createUpscaler(upscalePipeline,
+		{ traceImage.view, reconstructionTargets.history[0].view, reconstructionTargets.history[1].view, denoiserTargets.filtered[0].view, denoiserTargets.filtered[1].view,
+		queryTargets.result.view },
+		vkut::swapChainImageViews);
+	wavefront::destroyTargets(wavefrontTargets);
+	wavefrontTargets = wavefront::createTargets(commandPool, vkut::swapChainExtent, framesInFlight);
+	createWavefrontDescriptorSets();
+
 	createDescriptorPool();
-	createDescriptorSets();
-	
-	commandBuffers = vkut::common::createCommandBuffers(commandPool, vkut::swapChainImages.size());
-	recordCommandBuffers();
+	createDescriptorSet();
 }
 
-void Raytracer::recordCommandBuffers()
+void Raytracer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
 	VkImageSubresourceRange subresourceRange
 	{
@@ -100,104 +163,415 @@ void Raytracer::recordCommandBuffers()
 		.layerCount = 1 
 	};
 
-	for (size_t i = 0; i < commandBuffers.size(); i++) {
-		vkut::common::startRecordCommandBuffer(commandBuffers[i]);
+	vkut::common::startRecordCommandBuffer(commandBuffer);
 
-		vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
-		vkut::common::transitionImageLayout(
-			commandBuffers[i], 
-			vkut::swapChainImages[i], 
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
-			VK_IMAGE_LAYOUT_GENERAL,
-			subresourceRange,
-			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
-			);
-		
-		vkCmdBindDescriptorSets(commandBuffers[i], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipelineLayout, 0, 1, &descriptorSets[i], 0, nullptr);
-		
-		size_t handleSize = vkut::raytracing::physicalDeviceRaytracingProperties.shaderGroupHandleSize;
-		size_t bindingTableSize = handleSize * 3U;
-		size_t rayGenOffset = 0U * handleSize;
-		size_t missOffset = 1U * handleSize;
-		size_t hitGroupOffset = 2U * handleSize;
-		
-		VkStridedBufferRegionKHR raygenBufferRegion
+	if (characterMesh != noMesh)
+	{
+		animateCharacter(commandBuffer);
+	}
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
+	//only the upscale pass writes the swapchain image, the acquire is waited for at the compute stage
+	vkut::common::transitionImageLayout(
+		commandBuffer, 
+		vkut::swapChainImages[imageIndex], 
+		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
+		VK_IMAGE_LAYOUT_GENERAL,
+		subresourceRange,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+		);
+	
+	//the camera of this frame in flight is selected through the dynamic offset
+	uint32_t cameraOffset = static_cast<uint32_t>(vkut::common::getRegionOffset(cameraBuffer, static_cast<uint32_t>(currentFrame)));
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipelineLayout, 0, 1, &descriptorSet, 1, &cameraOffset);
+	
+	//one record per group, raygen, miss and hit group in pipeline order
+	const vkut::raytracing::ShaderBindingTableRegion raygenBufferRegion = vkut::raytracing::getShaderBindingTableRegion(shaderBindingTable, 0, 1);
+	const vkut::raytracing::ShaderBindingTableRegion missBufferRegion = vkut::raytracing::getShaderBindingTableRegion(shaderBindingTable, 1, 1);
+	const vkut::raytracing::ShaderBindingTableRegion hitGroupBufferRegion = vkut::raytracing::getShaderBindingTableRegion(shaderBindingTable, 2, 1);
+	const vkut::raytracing::ShaderBindingTableRegion callableBufferRegion = vkut::raytracing::getShaderBindingTableRegion(shaderBindingTable, 0, 0);
+
+	uint32_t timestampIndex = static_cast<uint32_t>(currentFrame * 2U);
+	vkut::common::resetTimestamps(commandBuffer, traceTimestamps, timestampIndex, 2);
+	vkut::common::writeTimestamp(commandBuffer, traceTimestamps, timestampIndex, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+	//the budget, reconstruction, denoiser and upscale passes are part of the cost of a frame, so they are timed with the trace
+	//the denoiser accumulates over time on its own, it gets one fresh sample per pixel every frame
+	const bool reset = resetAccumulation || denoise;
+	if (reset)
+	{
+		accumulationEpoch++;
+		convergence = {};
+		resetAccumulation = false;
+	}
+	frameEpochs[currentFrame] = accumulationEpoch;
+	const uint32_t phase = traceFrame % reconstruction::getPeriod(tracePattern);
+	traceFrame++;
+
+	//a single ray, too little to be worth a ray tracing pipeline launch
+	pickRecorded[currentFrame] = pickPending;
+	if (pickPending)
+	{
+		queries::recordPick(commandBuffer, queryPipelines, queryTargets, currentFrame, descriptorSet, cameraOffset, renderExtent, pickPixel);
+		pickPending = false;
+	}
+
+	//the upscale reads the trace itself when every pixel was traced, otherwise the history just reconstructed
+	size_t upscaleSource = 0;
+	if (visibilityQueries)
+	{
+		frameEpochs[currentFrame] = 0;
+		queries::recordVisibility(commandBuffer, queryPipelines, queryTargets, queryTimestamps, currentFrame, descriptorSet, cameraOffset, renderExtent, traceFrame, querySettings);
+		upscaleSource = 5;
+		historyValid = false;
+		denoiserHistoryValid = false;
+	}
+	else if (wavefrontPaths)
+	{
+		//one fresh path per pixel straight into the trace image, past the accumulation, the reconstruction and the denoiser
+		frameEpochs[currentFrame] = 0;
+		wavefront::recordPaths(commandBuffer, wavefrontPipelines, wavefrontTargets, wavefrontTimestamps, currentFrame, cameraOffset, renderExtent, traceFrame, pathBounces, wavefrontSettings);
+		historyValid = false;
+		denoiserHistoryValid = false;
+	}
+	else
+	{
+		adaptive::recordBudget(commandBuffer, samplingPipeline, samplingTargets, currentFrame, renderExtent, tracePattern, phase, samplingSettings, reset);
+
+		//the tiles left out keep what the trace image showed before, which has to be written everywhere after a reset or a new debug view
+		const bool tiled = indirectTrace && vkut::raytracing::indirectTraceRaysEnabled && !reset && !redrawTraceImage;
+		redrawTraceImage = false;
+		if (tiled)
 		{
-			.buffer = shaderBindingTable.buffer,
-			.offset = rayGenOffset,
-			.stride = handleSize,
-			.size = bindingTableSize
-		};
+			adaptive::recordTiles(commandBuffer, samplingPipeline, samplingTargets, currentFrame, renderExtent, tracePattern, phase);
+			vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+		}
+		else
+		{
+			vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+		}
 
-		VkStridedBufferRegionKHR missBufferRegion
+		TracePushConstants pushConstants
 		{
-			.buffer = shaderBindingTable.buffer,
-			.offset = missOffset,
-			.stride = handleSize,
-			.size = bindingTableSize
+			.debugView = showSampleHeatmap ? 1U : 0U,
+			.heatmapSamples = samplingSettings.maxSamples,
+			.pattern = static_cast<uint32_t>(tracePattern),
+			.phase = phase,
+			.width = renderExtent.width,
+			.height = renderExtent.height,
+			//the bounces get new random directions every frame, which the wavefront kernels pick the same way
+			.jitterOffset = denoise || pathBounces > 0 ? traceFrame : 0U,
+			.bounces = pathBounces,
+			.tiled = tiled ? 1U : 0U
 		};
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_RAYGEN_BIT_KHR, 0, sizeof(TracePushConstants), &pushConstants);
 
-		VkStridedBufferRegionKHR hitGroupBufferRegion
+		if (tiled)
 		{
-			.buffer = shaderBindingTable.buffer,
-			.offset = hitGroupOffset,
-			.stride = handleSize,
-			.size = bindingTableSize
-		};
+			//the launch size was written by the tiles pass, there is nothing to read back
+			vkut::raytracing::recordTraceRaysIndirect(commandBuffer, raygenBufferRegion, missBufferRegion, hitGroupBufferRegion, callableBufferRegion, samplingTargets.tiles, 0);
+		}
+		else
+		{
+			//only the pixels of the pattern are launched
+			const VkExtent2D launchExtent = reconstruction::getLaunchExtent(renderExtent, tracePattern);
+
+			vkut::raytracing::vkCmdTraceRaysKHR(
+				commandBuffer,
+				&raygenBufferRegion,
+				&missBufferRegion,
+				&hitGroupBufferRegion,
+				&callableBufferRegion,
+				launchExtent.width,
+				launchExtent.height,
+				1
+			);
+		}
+
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
-		VkStridedBufferRegionKHR callableBufferRegion
+		if (tracePattern != reconstruction::TracePattern::FULL)
 		{
-			.buffer = shaderBindingTable.buffer,
-			.offset = 0,
-			.stride = 0,
-			.size = 0
-		};
+			reconstruction::recordReconstruction(commandBuffer, reconstructionPipeline, reconstructionTargets, historyIndex, renderExtent, historyValid);
+			vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			upscaleSource = 1U + historyIndex;
+			historyIndex = 1U - historyIndex;
+		}
+		historyValid = tracePattern != reconstruction::TracePattern::FULL;
 
-		vkut::raytracing::vkCmdTraceRaysKHR(
-			commandBuffers[i],
-			&raygenBufferRegion,
-			&missBufferRegion,
-			&hitGroupBufferRegion,
-			&callableBufferRegion,
-			vkut::swapChainExtent.width,
-			vkut::swapChainExtent.height,
-			1
-		);
+		//the denoiser takes over whatever the upscale would have read
+		if (denoise)
+		{
+			denoiser::recordDenoise(commandBuffer, denoiserPipelines, denoiserTargets, denoiserTimestamps, currentFrame, upscaleSource, denoiserHistoryIndex, renderExtent, denoiserSettings, denoiserHistoryValid);
+			upscaleSource = 3U + denoiser::getResultIndex(denoiserSettings);
+			denoiserHistoryIndex = 1U - denoiserHistoryIndex;
+		}
+		denoiserHistoryValid = denoise;
+	}
+	resolution::recordUpscale(commandBuffer, upscalePipeline, upscaler, upscaleSource, imageIndex, renderExtent, vkut::swapChainExtent);
 
+	vkut::common::writeTimestamp(commandBuffer, traceTimestamps, timestampIndex + 1U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
-		vkut::common::transitionImageLayout(
-			commandBuffers[i], 
-			vkut::swapChainImages[i], 
-			VK_IMAGE_LAYOUT_GENERAL, 
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
-			subresourceRange,
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 
-		vkut::common::endRecordCommandBuffer(commandBuffers[i]);
+	vkut::common::transitionImageLayout(
+		commandBuffer, 
+		vkut::swapChainImages[imageIndex], 
+		VK_IMAGE_LAYOUT_GENERAL, 
+		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 
+		subresourceRange,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+	vkut::common::endRecordCommandBuffer(commandBuffer);
+}
+
+void Raytracer::updateCamera()
+{
+	const float aspectRatio = static_cast<float>(vkut::swapChainExtent.width) / static_cast<float>(vkut::swapChainExtent.height);
+	CameraData cameraData = camera.getData(aspectRatio);
+
+	//the animated character invalidates the accumulation every frame
+	if (characterMesh != noMesh || memcmp(&cameraData, &lastCameraData, sizeof(CameraData)) != 0)
+	{
+		resetAccumulation = true;
 	}
+	const CameraData previousCameraData = lastCameraData;
+	lastCameraData = cameraData;
+	//the motion vectors reproject onto the camera of the previous frame
+	cameraData.previousViewProjection = previousCameraData.viewProjection;
 
+	vkut::common::writeRegion(cameraBuffer, static_cast<uint32_t>(currentFrame), &cameraData, sizeof(CameraData));
 }
 
-void Raytracer::createAccelerationStructures()
+void Raytracer::createScene()
 {
-	blas = vkut::raytracing::createBLAS(commandPool, vertices, indices);
+	Scene::MaterialHandle green = scene.addMaterial({ .albedo = glm::vec4(.0f, 1.0f, .0f, 1.0f) });
+	Scene::MeshHandle triangle = scene.addMesh(vertices, indices);
+	scene.addInstance(triangle, Scene::identityTransform, green);
+
+	createCharacter();
+}
 
-	std::vector<VkAccelerationStructureInstanceKHR> instances =
+//a ribbon bending along a chain of joints, with a ripple morph target
+void Raytracer::createCharacter()
+{
+	constexpr uint32_t segments = 64;
+	constexpr float length = 2.0f;
+	constexpr float width = .5f;
+	constexpr float pi = 3.14159265358979f;
+	constexpr float jointLength = length / characterJointCount;
+
+	characterDescription = {};
+	characterDescription.jointCount = characterJointCount;
+	characterDescription.morphTargets.resize(1);
+
+	std::vector<float> restPositions = {};
+	for (uint32_t segment = 0; segment <= segments; segment++)
 	{
-		VkAccelerationStructureInstanceKHR
+		float x = length * static_cast<float>(segment) / static_cast<float>(segments) - length * .5f;
+		float jointPosition = std::min((x + length * .5f) / jointLength, static_cast<float>(characterJointCount) - 1.0f);
+		uint32_t joint = static_cast<uint32_t>(jointPosition);
+		uint32_t nextJoint = std::min(joint + 1, characterJointCount - 1);
+		float blend = jointPosition - static_cast<float>(joint);
+
+		for (float y : { -width * .5f, width * .5f })
 		{
-			.transform = {1.0f, 0.0f, 0.0, 0.0f, 0.0f, 1.0f, 0.0, 0.0f, 0.0f, 0.0f, 1.0, 0.0f},
-			.instanceCustomIndex = 0,
-			.mask = 0xFF,
-			.instanceShaderBindingTableRecordOffset = 0x0,
-			.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
-			.accelerationStructureReference = blas.address
+			characterDescription.vertices.push_back(skinning::Vertex
+			{
+				.position = glm::vec4(x, y, .0f, 1.0f),
+				.joints = glm::uvec4(joint, nextJoint, 0, 0),
+				.weights = glm::vec4(1.0f - blend, blend, .0f, .0f)
+			});
+			characterDescription.morphTargets[0].push_back(glm::vec4(.0f, .0f, .15f * std::sin(x * 2.0f * pi), .0f));
+			restPositions.insert(restPositions.end(), { x, y, .0f });
 		}
+	}
+
+	for (uint32_t segment = 0; segment < segments; segment++)
+	{
+		uint32_t current = segment * 2;
+		characterDescription.indices.insert(characterDescription.indices.end(), { current, current + 2, current + 1, current + 1, current + 2, current + 3 });
+	}
+
+	characterMesh = scene.addDeformableMesh(restPositions, characterDescription.indices);
+
+	VkTransformMatrixKHR transform = Scene::identityTransform;
+	transform.matrix[1][3] = -.5f;
+	transform.matrix[2][3] = -3.0f;
+	Scene::MaterialHandle orange = scene.addMaterial({ .albedo = glm::vec4(1.0f, .5f, .1f, 1.0f) });
+	scene.addInstance(characterMesh, transform, orange);
+}
+
+void Raytracer::animateCharacter(VkCommandBuffer commandBuffer)
+{
+	constexpr float length = 2.0f;
+	constexpr float jointLength = length / characterJointCount;
+	const float time = static_cast<float>(glfwGetTime());
+
+	std::vector<glm::mat4> jointMatrices = std::vector<glm::mat4>(characterJointCount);
+	glm::mat4 parent = glm::mat4(1.0f);
+	for (uint32_t joint = 0; joint < characterJointCount; joint++)
+	{
+		glm::vec3 pivot = glm::vec3(static_cast<float>(joint) * jointLength - length * .5f, .0f, .0f);
+		float angle = .35f * std::sin(time * 2.0f + static_cast<float>(joint) * .6f);
+		parent = parent * glm::translate(glm::mat4(1.0f), pivot) * glm::rotate(glm::mat4(1.0f), angle, glm::vec3(.0f, 1.0f, .0f)) * glm::translate(glm::mat4(1.0f), -pivot);
+		jointMatrices[joint] = parent;
+	}
+	std::vector<float> morphWeights = { std::sin(time * 3.0f) };
+
+	bool rebuild = skinning::setPose(character, currentFrame, jointMatrices, morphWeights);
+
+	skinning::recordDeformation(commandBuffer, skinningPipeline, character, currentFrame, rebuild);
+	vkut::raytracing::recordTLASUpdate(commandBuffer, tlas);
+	recordTraceBarrier(commandBuffer);
+}
+
+void Raytracer::createBenchmarkScene()
+{
+	constexpr uint32_t gridSize = 8;
+	constexpr float spacing = 1.0f;
+	constexpr float depth = -8.0f;
+
+	Scene::Mesh sphere = Scene::generateSphere(64, 128, .4f);
+	Scene::MeshHandle sphereMesh = scene.addMesh(sphere.vertices, sphere.indices);
+	//neighbouring spheres differ, so that the hits of every bounce spread over the materials
+	const glm::vec4 albedos[] =
+	{
+		glm::vec4(.0f, 1.0f, .0f, 1.0f), glm::vec4(.9f, .2f, .2f, 1.0f), glm::vec4(.2f, .3f, .9f, 1.0f), glm::vec4(.8f, .8f, .8f, 1.0f),
+		glm::vec4(.9f, .8f, .1f, 1.0f), glm::vec4(.1f, .8f, .8f, 1.0f), glm::vec4(.7f, .2f, .8f, 1.0f), glm::vec4(.5f, .3f, .1f, 1.0f)
 	};
+	Scene::MaterialHandle materials[std::size(albedos)] = {};
+	for (size_t i = 0; i < std::size(albedos); i++)
+	{
+		materials[i] = scene.addMaterial({ .albedo = albedos[i] });
+	}
 
-	tlas = vkut::raytracing::createTLAS(commandPool, instances);
+	scene.reserveInstances(gridSize * gridSize);
+	for (uint32_t y = 0; y < gridSize; y++)
+	{
+		for (uint32_t x = 0; x < gridSize; x++)
+		{
+			VkTransformMatrixKHR transform = Scene::identityTransform;
+			transform.matrix[0][3] = (static_cast<float>(x) - (gridSize - 1) * .5f) * spacing;
+			transform.matrix[1][3] = (static_cast<float>(y) - (gridSize - 1) * .5f) * spacing;
+			transform.matrix[2][3] = depth;
+			scene.addInstance(sphereMesh, transform, materials[(x + y * 3U) % std::size(materials)]);
+		}
+	}
+}
+
+//static geometry only, so that both renderers see exactly the same scene
+void Raytracer::createValidationScene()
+{
+	const Scene::MaterialHandle materials[] =
+	{
+		scene.addMaterial({ .albedo = glm::vec4(.0f, 1.0f, .0f, 1.0f) }),
+		scene.addMaterial({ .albedo = glm::vec4(.9f, .2f, .2f, 1.0f) }),
+		scene.addMaterial({ .albedo = glm::vec4(.2f, .3f, .9f, 1.0f) }),
+		scene.addMaterial({ .albedo = glm::vec4(.8f, .8f, .8f, 1.0f) })
+	};
+
+	Scene::MeshHandle triangle = scene.addMesh(vertices, indices);
+	scene.addInstance(triangle, Scene::identityTransform, materials[0]);
+
+	Scene::Mesh sphere = Scene::generateSphere(16, 32, .6f);
+	Scene::MeshHandle sphereMesh = scene.addMesh(sphere.vertices, sphere.indices);
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		VkTransformMatrixKHR transform = Scene::identityTransform;
+		transform.matrix[0][3] = static_cast<float>(i) * 1.4f - 2.1f;
+		transform.matrix[1][3] = (i % 2 == 0) ? .8f : -.8f;
+		transform.matrix[2][3] = -3.0f;
+		//the last sphere is masked out and must not show up in either image
+		uint8_t mask = (i == 3) ? 0x00 : 0xFF;
+		scene.addInstance(sphereMesh, transform, materials[std::min(i + 1U, 3U)], mask);
+	}
+}
+
+void Raytracer::createAccelerationStructures()
+{
+	//everything below lives until the next rebuild
+	vkut::setup::resourceQueue.beginScope();
+
+	const std::vector<Scene::Mesh> &meshes = scene.getMeshes();
+	std::vector<uint64_t> meshAddresses(meshes.size());
+	blases.resize(meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		if (meshes[i].deformable)
+		{
+			assert(i == characterMesh);
+			character = skinning::createSkinnedMesh(commandPool, skinningPipeline, characterDescription, framesInFlight);
+			vkut::setup::resourceQueue.push(character.restVertices);
+			vkut::setup::resourceQueue.push(character.morphDeltas);
+			vkut::setup::resourceQueue.push(character.deformedVertices);
+			vkut::setup::resourceQueue.push(character.poseBuffer);
+			vkut::setup::resourceQueue.push(vkut::ResourceType::DESCRIPTOR_POOL, character.descriptorPool);
+			vkut::setup::resourceQueue.push(character.blas);
+			meshAddresses[i] = character.blas.address;
+			continue;
+		}
+
+		if (hostBuilds && vkut::raytracing::hostCommandsEnabled)
+		{
+			blases[i] = vkut::raytracing::createHostBLAS(commandPool, meshes[i].vertices, meshes[i].indices, [this](uint32_t concurrency, const std::function<void()> &join)
+			{
+				joinOnWorkers(concurrency, join);
+			}, meshes[i].buildPolicy, geometryPlacement);
+		}
+		else
+		{
+			blases[i] = vkut::raytracing::createBLAS(commandPool, meshes[i].vertices, meshes[i].indices, meshes[i].buildPolicy, geometryPlacement);
+		}
+		vkut::setup::resourceQueue.push(blases[i]);
+		meshAddresses[i] = blases[i].address;
+	}
+
+	//the TLAS is refit every frame once a deformable mesh is part of the scene
+	tlas = vkut::raytracing::createTLAS(commandPool, scene.getInstanceCount(), [&](VkAccelerationStructureInstanceKHR *instances)
+	{
+		scene.writeInstances(instances, meshAddresses);
+	}, characterMesh != noMesh, geometryPlacement);
+	vkut::setup::resourceQueue.push(tlas);
+
+	//indexed like the TLAS instances, the deformable mesh is read where the skinning writes it
+	const Scene::InstanceTable &instances = scene.getInstances();
+	std::vector<InstanceGeometry> geometries = std::vector<InstanceGeometry>(std::max<size_t>(instances.size(), 1U));
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		const vkut::raytracing::BottomLevelAccelerationStructure &blas = instances.meshes[i] == characterMesh ? character.blas : blases[instances.meshes[i]];
+		geometries[i] = { .vertexAddress = blas.vertexAddress, .indexAddress = blas.indexAddress };
+	}
+	const VkDeviceSize geometrySize = sizeof(InstanceGeometry) * geometries.size();
+	geometryBuffer = vkut::common::createDeviceLocalBuffer(
+		commandPool,
+		geometrySize,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		[&](void *destination) { memcpy(destination, geometries.data(), static_cast<size_t>(geometrySize)); });
+	vkut::setup::resourceQueue.push(geometryBuffer);
+}
+
+void Raytracer::destroyAccelerationStructures()
+{
+	vkut::setup::resourceQueue.endScope();
+	blases.clear();
+}
+
+void Raytracer::createMaterialBuffer()
+{
+	std::vector<Scene::Material> materials = scene.getMaterials();
+	if (materials.empty())
+	{
+		materials.push_back({ .albedo = glm::vec4(1.0f) });
+	}
+
+	const VkDeviceSize size = sizeof(Scene::Material) * materials.size();
+	materialBuffer = vkut::common::createDeviceLocalBuffer(
+		commandPool,
+		size,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		[&](void *destination) { memcpy(destination, materials.data(), static_cast<size_t>(size)); });
 }
 
 std::vector<VkDescriptorType> Raytracer::createDescriptorSetLayout()
@@ -207,7 +581,8 @@ std::vector<VkDescriptorType> Raytracer::createDescriptorSetLayout()
 		.binding = 0,
 		.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
 		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+		//the ray query kernels bind this set too
+		.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
 		.pImmutableSamplers = nullptr,
 	};
 
@@ -220,7 +595,56 @@ std::vector<VkDescriptorType> Raytracer::createDescriptorSetLayout()
 		.pImmutableSamplers = nullptr,
 	};
 
-	std::vector<VkDescriptorSetLayoutBinding> bindings = { accelerationStructureLayoutBinding, storageImageLayoutBinding };
+	VkDescriptorSetLayoutBinding cameraLayoutBinding
+	{
+		.binding = 2,
+		.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+		.pImmutableSamplers = nullptr,
+	};
+
+	VkDescriptorSetLayoutBinding materialLayoutBinding
+	{
+		.binding = 3,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+		.pImmutableSamplers = nullptr,
+	};
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings = { accelerationStructureLayoutBinding, storageImageLayoutBinding, cameraLayoutBinding, materialLayoutBinding };
+
+	//accumulation, moments, sample budget, motion vectors and the G-buffer of the denoiser
+	for (uint32_t binding = 4; binding < 10; binding++)
+	{
+		bindings.push_back(VkDescriptorSetLayoutBinding
+		{
+			.binding = binding,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.descriptorCount = 1,
+			.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+			.pImmutableSamplers = nullptr,
+		});
+	}
+
+	bindings.push_back(VkDescriptorSetLayoutBinding
+	{
+		.binding = 10,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT,
+		.pImmutableSamplers = nullptr,
+	});
+
+	bindings.push_back(VkDescriptorSetLayoutBinding
+	{
+		.binding = 11,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+		.pImmutableSamplers = nullptr,
+	});
 
 	descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
 
@@ -234,12 +658,10 @@ std::vector<VkDescriptorType> Raytracer::createDescriptorSetLayout()
 
 void Raytracer::createDescriptorPool()
 {
-	uint32_t maxSets = static_cast<uint32_t>(vkut::swapChainImages.size());
-	uint32_t descriptorCount = maxSets;
-	descriptorPool = vkut::common::createDescriptorPool(descriptorTypes, descriptorCount, maxSets);
+	descriptorPool = vkut::common::createDescriptorPool(descriptorTypes, 1, 1);
 }
 
-void Raytracer::createDescriptorSets()
+void Raytracer::createDescriptorSet()
 {
 	VkWriteDescriptorSetAccelerationStructureKHR descriptorAccelerationStructureInfo
 	{
@@ -261,6 +683,13 @@ void Raytracer::createDescriptorSets()
 		.pTexelBufferView = nullptr
 	};
 
+	VkDescriptorImageInfo imageInfo
+	{
+		.sampler = VK_NULL_HANDLE,
+		.imageView = traceImage.view,
+		.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+	};
+
 	vkut::DescriptorSetInfo imageSetInfo
 	{
 		.pNext = nullptr,
@@ -268,39 +697,154 @@ void Raytracer::createDescriptorSets()
 		.dstArrayElement = 0,
 		.descriptorCount = 1,
 		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.pImageInfo = &imageInfo,
+		.pBufferInfo = nullptr,
+		.pTexelBufferView = nullptr
 	};
 
-	descriptorSets.resize(vkut::swapChainImages.size());
-	for(size_t i = 0; i < descriptorSets.size(); i++)
+	VkDescriptorBufferInfo cameraBufferInfo
 	{
-		VkDescriptorImageInfo imageInfo
-		{
-			.sampler = VK_NULL_HANDLE,
-			.imageView = vkut::swapChainImageViews[i],
-			.imageLayout = VK_IMAGE_LAYOUT_GENERAL
-		};
-		
-		imageSetInfo.pImageInfo = &imageInfo;
+		.buffer = cameraBuffer.buffer.buffer,
+		.offset = 0,
+		.range = cameraBuffer.regionSize
+	};
+
+	vkut::DescriptorSetInfo cameraSetInfo
+	{
+		.pNext = nullptr,
+		.dstBinding = 2,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &cameraBufferInfo,
+		.pTexelBufferView = nullptr
+	};
+
+	VkDescriptorBufferInfo materialBufferInfo
+	{
+		.buffer = materialBuffer.buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE
+	};
 
-		std::vector<vkut::DescriptorSetInfo> descriptorSetInfos
+	vkut::DescriptorSetInfo materialSetInfo
+	{
+		.pNext = nullptr,
+		.dstBinding = 3,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &materialBufferInfo,
+		.pTexelBufferView = nullptr
+	};
+
+	const VkImageView samplingViews[] =
+	{
+		samplingTargets.accumulation.view, samplingTargets.moments.view, samplingTargets.budget.view,
+		reconstructionTargets.motion.view, denoiserTargets.positions.view, denoiserTargets.albedo.view
+	};
+	VkDescriptorImageInfo samplingImageInfos[6] = {};
+	std::vector<vkut::DescriptorSetInfo> samplingSetInfos = std::vector<vkut::DescriptorSetInfo>(6);
+	for (uint32_t i = 0; i < 6U; i++)
+	{
+		samplingImageInfos[i] = { .sampler = VK_NULL_HANDLE, .imageView = samplingViews[i], .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+		samplingSetInfos[i] = vkut::DescriptorSetInfo
 		{
-			accelerationStructureSetInfo,
-			imageSetInfo
+			.pNext = nullptr,
+			.dstBinding = 4U + i,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+			.pImageInfo = &samplingImageInfos[i],
+			.pBufferInfo = nullptr,
+			.pTexelBufferView = nullptr
 		};
+	}
 
-		descriptorSets[i] = vkut::common::createDescriptorSet(descriptorSetLayout, descriptorPool, descriptorSetInfos);
+	VkDescriptorBufferInfo geometryBufferInfo
+	{
+		.buffer = geometryBuffer.buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE
+	};
 
-	}
+	vkut::DescriptorSetInfo geometrySetInfo
+	{
+		.pNext = nullptr,
+		.dstBinding = 10,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &geometryBufferInfo,
+		.pTexelBufferView = nullptr
+	};
+
+	VkDescriptorBufferInfo tilesBufferInfo
+	{
+		.buffer = samplingTargets.tiles.buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE
+	};
+
+	vkut::DescriptorSetInfo tilesSetInfo
+	{
+		.pNext = nullptr,
+		.dstBinding = 11,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &tilesBufferInfo,
+		.pTexelBufferView = nullptr
+	};
+
+	std::vector<vkut::DescriptorSetInfo> descriptorSetInfos
+	{
+		accelerationStructureSetInfo,
+		imageSetInfo,
+		cameraSetInfo,
+		materialSetInfo
+	};
+	descriptorSetInfos.insert(descriptorSetInfos.end(), samplingSetInfos.begin(), samplingSetInfos.end());
+	descriptorSetInfos.push_back(geometrySetInfo);
+	descriptorSetInfos.push_back(tilesSetInfo);
+
+	descriptorSet = vkut::common::createDescriptorSet(descriptorSetLayout, descriptorPool, descriptorSetInfos);
+}
+
+void Raytracer::createWavefrontDescriptorSets()
+{
+	wavefront::Resources resources
+	{
+		.topLevelAS = tlas.accelerationStructure,
+		.camera = &cameraBuffer,
+		.materials = materialBuffer.buffer,
+		.geometries = geometryBuffer.buffer,
+		.output = traceImage.view
+	};
+	wavefront::createDescriptorSets(wavefrontTargets, wavefrontPipelines, resources);
 }
 
 void Raytracer::createPipeline()
 {
+	//reading and creating the modules does not need external synchronization, so they load in parallel
+	const char *shaderPaths[] = { "../Assets/shaders/raytrace.rgen.spv", "../Assets/shaders/raytrace.rmiss.spv", "../Assets/shaders/raytrace.rchit.spv" };
+	VkShaderModule shaderModules[3] = {};
+	JobSystem::Counter shaderCounter = {};
+	for (size_t i = 0; i < 3U; i++)
+	{
+		jobs.run(shaderCounter, [&shaderModules, &shaderPaths, i]() { shaderModules[i] = vkut::common::createShaderModule(shaderPaths[i]); });
+	}
+	jobs.wait(shaderCounter);
 
 	std::vector<VkPipelineShaderStageCreateInfo> shaderStages
 	{
-		vkut::raytracing::getShaderStageCreateInfo(vkut::common::createShaderModule("../Assets/shaders/raytrace.rgen.spv"), VK_SHADER_STAGE_RAYGEN_BIT_KHR),
-		vkut::raytracing::getShaderStageCreateInfo(vkut::common::createShaderModule("../Assets/shaders/raytrace.rmiss.spv"), VK_SHADER_STAGE_MISS_BIT_KHR),
-		vkut::raytracing::getShaderStageCreateInfo(vkut::common::createShaderModule("../Assets/shaders/raytrace.rchit.spv"), VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+		vkut::raytracing::getShaderStageCreateInfo(shaderModules[raygenShaderIndex], VK_SHADER_STAGE_RAYGEN_BIT_KHR),
+		vkut::raytracing::getShaderStageCreateInfo(shaderModules[missShaderIndex], VK_SHADER_STAGE_MISS_BIT_KHR),
+		vkut::raytracing::getShaderStageCreateInfo(shaderModules[closestHitShaderIndex], VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
 	};
 
 	std::vector<VkRayTracingShaderGroupCreateInfoKHR> shaderGroups = 
@@ -321,17 +865,40 @@ void Raytracer::createPipeline()
 
 
 //todo: clean this up
+void Raytracer::paceFrame()
+{
+	pacer.framesCompleted(vkut::common::getCompletedGraphicsValue());
+	if (!framePacing) return;
+
+	//with the frame ahead of it done the GPU works on the last frame submitted, the next one only has to be there when it finishes
+	const uint64_t submittedValue = vkut::common::getSubmittedGraphicsValue();
+	if (submittedValue < 2U) return;
+	vkut::common::waitGraphicsValue(submittedValue - 1U);
+	pacer.framesCompleted(submittedValue - 1U);
+
+	pacer.sleepBeforeInput(gpuFrameMilliseconds);
+}
+
 void Raytracer::drawFrame()
 {
-	vkWaitForFences(vkut::device, 1, &vkut::inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
-	VkSemaphore currentSemaphore = vkut::imageAvailableSemaphores[currentFrame];
+	vkut::common::waitGraphicsValue(frameValues[currentFrame]);
+	vkut::setup::resourceQueue.collect(vkut::common::getCompletedGraphicsValue());
+	//the timestamps of the previous frame of this frame in flight are available now
+	if (frameValues[currentFrame] != 0) gpuFrameMilliseconds = getTraceMilliseconds(currentFrame);
+	collectSamplingStats(currentFrame);
+	collectPick(currentFrame);
+	if (dynamicResolution && frameValues[currentFrame] != 0)
+	{
+		updateRenderExtent();
+	}
+	VkSemaphore imageAvailableSemaphore = vkut::imageAvailableSemaphores[currentFrame];
 
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(
 		vkut::device,
 		vkut::swapChain,
 		std::numeric_limits<uint64_t>::max(),
-		currentSemaphore,
+		imageAvailableSemaphore,
 		VK_NULL_HANDLE,
 		&imageIndex);
 
@@ -344,29 +911,54 @@ void Raytracer::drawFrame()
 		assert(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR);
 	}
 
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	lastFrame = currentFrame;
+	lastImageIndex = imageIndex;
+
+	//the timeline wait guarantees the command buffer and the camera region of this frame in flight are no longer in use
+	VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+	VK_CHECK(vkResetCommandBuffer(commandBuffer, 0));
+	updateCamera();
+	recordCommandBuffer(commandBuffer, imageIndex);
+
+	//binary semaphores ignore their values
+	VkSemaphore renderFinishedSemaphore = vkut::renderFinishedSemaphores[imageIndex];
+	const uint64_t waitValues[] = { 0 };
+	VkSemaphore signalSemaphores[] = { renderFinishedSemaphore, vkut::graphicsTimeline };
+	const uint64_t signalValues[] = { 0, vkut::common::claimGraphicsValue() };
+	frameValues[currentFrame] = signalValues[1];
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.waitSemaphoreValueCount = 1,
+		.pWaitSemaphoreValues = waitValues,
+		.signalSemaphoreValueCount = 2,
+		.pSignalSemaphoreValues = signalValues
+	};
+
+	//the upscale pass writes the swapchain image
+	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
 	VkSubmitInfo submitInfo
 	{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineInfo,
 		.waitSemaphoreCount = 1,
-		.pWaitSemaphores = &currentSemaphore,
+		.pWaitSemaphores = &imageAvailableSemaphore,
 		.pWaitDstStageMask = waitStages,
 		.commandBufferCount = 1,
-		.pCommandBuffers = &commandBuffers[imageIndex],
-		.signalSemaphoreCount = 1,
-		.pSignalSemaphores = &currentSemaphore,
+		.pCommandBuffers = &commandBuffer,
+		.signalSemaphoreCount = 2,
+		.pSignalSemaphores = signalSemaphores,
 	};
 
-	VkFence *fenceToReset = &vkut::inFlightFences[currentFrame];
-	VK_CHECK(vkResetFences(vkut::device, 1, fenceToReset));
-
-	VK_CHECK(vkQueueSubmit(vkut::graphicsQueue, 1, &submitInfo, *fenceToReset));
+	VK_CHECK(vkQueueSubmit(vkut::graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+	pacer.frameSubmitted(signalValues[1]);
 
 	VkPresentInfoKHR presentInfo
 	{
 		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 		.waitSemaphoreCount = 1,
-		.pWaitSemaphores = &currentSemaphore,
+		.pWaitSemaphores = &renderFinishedSemaphore,
 		.swapchainCount = 1,
 		.pSwapchains = &vkut::swapChain,
 		.pImageIndices = &imageIndex,
@@ -384,7 +976,7 @@ void Raytracer::drawFrame()
 		assert(result == VK_SUCCESS);
 	}
 
-	currentFrame = (currentFrame + 1U) % maxFramesInFlight;
+	currentFrame = (currentFrame + 1U) % framesInFlight;
 
 }
 
@@ -396,11 +988,53 @@ void Raytracer::framebufferResizeCallback(GLFWwindow *window, int width, int hei
 	raytracer->windowResized = true;
 }
 
+void Raytracer::keyCallback(GLFWwindow *window, int key, int, int action, int)
+{
+	Raytracer *raytracer = reinterpret_cast<Raytracer *>(glfwGetWindowUserPointer(window));
+	if (key == GLFW_KEY_H && action == GLFW_PRESS)
+	{
+		raytracer->showSampleHeatmap = !raytracer->showSampleHeatmap;
+		raytracer->redrawTraceImage = true;
+	}
+	else if (key == GLFW_KEY_D && action == GLFW_PRESS)
+	{
+		raytracer->setDenoiser(!raytracer->denoise);
+	}
+	else if (key == GLFW_KEY_W && action == GLFW_PRESS)
+	{
+		raytracer->setWavefront(!raytracer->wavefrontPaths);
+	}
+	else if (key == GLFW_KEY_V && action == GLFW_PRESS)
+	{
+		raytracer->setVisibilityQueries(!raytracer->visibilityQueries);
+	}
+}
+
+void Raytracer::mouseButtonCallback(GLFWwindow *window, int button, int action, int)
+{
+	Raytracer *raytracer = reinterpret_cast<Raytracer *>(glfwGetWindowUserPointer(window));
+	if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
+
+	//the cursor is in swapchain pixels, the trace at the render resolution
+	double x = .0;
+	double y = .0;
+	glfwGetCursorPos(window, &x, &y);
+	const VkExtent2D extent = raytracer->renderExtent;
+	const int32_t pixelX = static_cast<int32_t>(x * extent.width / vkut::swapChainExtent.width);
+	const int32_t pixelY = static_cast<int32_t>(y * extent.height / vkut::swapChainExtent.height);
+	if (pixelX < 0 || pixelY < 0 || pixelX >= static_cast<int32_t>(extent.width) || pixelY >= static_cast<int32_t>(extent.height)) return;
+
+	raytracer->pickPixel = { pixelX, pixelY };
+	raytracer->pickPending = true;
+}
+
 void Raytracer::init()
 {
 	window = vkut::setup::createWindow(title, width, height);
 	glfwSetWindowUserPointer(window, this);
 	glfwSetFramebufferSizeCallback(window, Raytracer::framebufferResizeCallback);
+	glfwSetKeyCallback(window, Raytracer::keyCallback);
+	glfwSetMouseButtonCallback(window, Raytracer::mouseButtonCallback);
 
 	vkut::setup::createInstance(title);
 
@@ -408,21 +1042,21 @@ void Raytracer::init()
 	vkut::setup::createDebugMessenger();
 	vkut::setup::createSurface(window);
 
-	vkut::setup::choosePhysicalDevice(requiredExtensions);
+	std::vector<const char *> deviceExtensions = requiredExtensions;
+	deviceExtensions.insert(deviceExtensions.end(), vkut::raytracing::extensionNames.begin(), vkut::raytracing::extensionNames.end());
+	vkut::setup::choosePhysicalDevice(deviceExtensions);
 	vkut::raytracing::getPhysicalDeviceRaytracingProperties();
 
-	VkPhysicalDeviceRayTracingFeaturesKHR rayTracingFeatures
-	{
-		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_FEATURES_KHR,
-		.rayTracing = VK_TRUE,
-	};
-	vkut::setup::createLogicalDevice(&rayTracingFeatures);
+	//including ray queries, the wavefront and query kernels trace from compute shaders
+	vkut::raytracing::Features rayTracingFeatures = {};
+	vkut::setup::createLogicalDevice(vkut::raytracing::getFeatureChain(rayTracingFeatures));
 	vkut::raytracing::initRaytracingFunctions();
 
-	vkut::setup::createSwapChain(width, height, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+	vkut::setup::createSwapChain(width, height, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
 	vkut::setup::createSwapchainImageViews();
 
-	commandPool = vkut::setup::createGraphicsCommandPool();
+	//command buffers are re-recorded every frame
+	commandPool = vkut::setup::createGraphicsCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 	VkImageSubresourceRange subresourceRange
 	{
 		.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -443,42 +1077,379 @@ void Raytracer::init()
 			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 	}
 
-	vkut::setup::createSyncObjects(maxFramesInFlight);
+	vkut::setup::createSyncObjects(framesInFlight);
+
+	if (characterMesh != noMesh)
+	{
+		skinningPipeline = skinning::createPipeline();
+	}
+
+	cameraBuffer = vkut::common::createPersistentBuffer(sizeof(CameraData), static_cast<uint32_t>(framesInFlight), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+	createMaterialBuffer();
 	
 	createAccelerationStructures();
 
+	samplingPipeline = adaptive::createPipeline();
+	samplingTargets = adaptive::createTargets(commandPool, samplingPipeline, vkut::swapChainExtent, framesInFlight);
+	traceImage = vkut::common::createStorageImage(commandPool, vkut::swapChainExtent, resolution::traceFormat);
+	renderExtent = resolution::getRenderExtent(vkut::swapChainExtent, resolutionController.getScale());
+	reconstructionPipeline = reconstruction::createPipeline();
+	reconstructionTargets = reconstruction::createTargets(commandPool, reconstructionPipeline, vkut::swapChainExtent, traceImage.view, samplingTargets.accumulation.view);
+	denoiserPipelines = denoiser::createPipelines();
+	denoiserTargets = denoiser::createTargets(commandPool, denoiserPipelines, vkut::swapChainExtent,
+		{ traceImage.view, reconstructionTargets.history[0].view, reconstructionTargets.history[1].view }, reconstructionTargets.motion.view);
+	//the query kernels bind the descriptor set of the trace next to their own
 	descriptorTypes = createDescriptorSetLayout();
+	queryPipelines = queries::createPipelines(commandPool, descriptorSetLayout);
+	queryTargets = queries::createTargets(commandPool, queryPipelines, vkut::swapChainExtent, framesInFlight);
+	upscalePipeline = resolution::createPipeline();
+	upscaler = resolution::createUpscaler(upscalePipeline,
+		{ traceImage.view, reconstructionTargets.history[0].view, reconstructionTargets.history[1].view, denoiserTargets.filtered[0].view, denoiserTargets.filtered[1].view,
+		queryTargets.result.view },
+		vkut::swapChainImageViews);
+	wavefrontPipelines = wavefront::createPipelines();
+	wavefrontTargets = wavefront::createTargets(commandPool, vkut::swapChainExtent, framesInFlight);
+	createWavefrontDescriptorSets();
+
+	VkPushConstantRange pushConstantRange
+	{
+		.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+		.offset = 0,
+		.size = sizeof(TracePushConstants)
+	};
+	pipelineLayout = vkut::common::createPipelineLayout({ descriptorSetLayout }, { pushConstantRange });
 
-	pipelineLayout = vkut::common::createPipelineLayout({ descriptorSetLayout });
-
-	descriptorPool = vkut::common::createDescriptorPool(descriptorTypes, static_cast<uint32_t>(vkut::swapChainImages.size()), static_cast<uint32_t>(vkut::swapChainImages.size()));
+	createDescriptorPool();
 	
-	createDescriptorSets();
+	createDescriptorSet();
 
 	createPipeline();
 
 	shaderBindingTable = vkut::raytracing::createShaderBindingTable(commandPool, pipeline, {  raygenShaderIndex, missShaderIndex, closestHitShaderIndex });
 
-	commandBuffers = vkut::common::createCommandBuffers(commandPool, vkut::swapChainImages.size());
-	recordCommandBuffers();
+	traceTimestamps = vkut::common::createTimestampQueries(static_cast<uint32_t>(framesInFlight * 2U));
+	denoiserTimestamps = vkut::common::createTimestampQueries(static_cast<uint32_t>(framesInFlight) * denoiser::timestampsPerFrame);
+	wavefrontTimestamps = vkut::common::createTimestampQueries(static_cast<uint32_t>(framesInFlight) * wavefront::timestampsPerFrame);
+	queryTimestamps = vkut::common::createTimestampQueries(static_cast<uint32_t>(framesInFlight) * queries::timestampsPerFrame);
+
+	commandBuffers = vkut::common::createCommandBuffers(commandPool, framesInFlight);
+
+	vkut::common::beginDeferredDestruction();
+}
+
+double Raytracer::getTraceMilliseconds(size_t frame)
+{
+	uint32_t timestampIndex = static_cast<uint32_t>(frame * 2U);
+	return vkut::common::getElapsedMilliseconds(traceTimestamps, timestampIndex, timestampIndex + 1U);
+}
+
+void Raytracer::collectSamplingStats(size_t frame)
+{
+	const bool current = frameEpochs[frame] != 0 && frameEpochs[frame] == accumulationEpoch;
+	frameEpochs[frame] = 0;
+	if (!current || convergence.converged) return;
+
+	const uint32_t pixelCount = renderExtent.width * renderExtent.height;
+	adaptive::addFrame(convergence, adaptive::getStats(samplingTargets, frame), getTraceMilliseconds(frame), pixelCount);
+	if (convergence.converged)
+	{
+		Logger::logMessageFormatted("Converged after %u frames, %f ms on the GPU and %f rays per pixel! ",
+			convergence.frames, convergence.gpuMilliseconds, static_cast<double>(convergence.rays) / static_cast<double>(pixelCount));
+	}
+}
+
+void Raytracer::collectPick(size_t frame)
+{
+	if (!pickRecorded[frame]) return;
+	pickRecorded[frame] = false;
+
+	const queries::PickResult pick = queries::getPick(queryTargets, frame);
+	if (pick.hit == 0)
+	{
+		Logger::logMessage("Picked nothing! ");
+		return;
+	}
+	Logger::logMessageFormatted("Picked instance %u, triangle %u at a distance of %f! ", pick.instance, pick.primitive, pick.distance);
+}
+
+void Raytracer::joinOnWorkers(uint32_t concurrency, const std::function<void()> &join)
+{
+	const uint32_t threadCount = std::min(concurrency, jobs.getWorkerCount() + 1U);
+	JobSystem::Counter joinCounter = {};
+	for (uint32_t thread = 1; thread < threadCount; thread++)
+	{
+		jobs.run(joinCounter, join);
+	}
+	join();
+	jobs.wait(joinCounter);
+}
+
+void Raytracer::rebuildAccelerationStructures()
+{
+	//the descriptor sets reference the previous TLAS, both stay alive until the frames submitted so far completed
+	vkut::common::destroyDescriptorPool(descriptorPool);
+	vkut::setup::resourceQueue.endScope(vkut::common::getSubmittedGraphicsValue());
+	blases.clear();
+
+	createAccelerationStructures();
+	createDescriptorPool();
+	createDescriptorSet();
+	createWavefrontDescriptorSets();
+	resetAccumulation = true;
+}
+
+void Raytracer::runCpuBenchmark()
+{
+	createBenchmarkScene();
+	benchmarks::runCpu(*this);
+}
+
+void Raytracer::runBenchmark()
+{
+	createBenchmarkScene();
+	init();
+	benchmarks::runRendering(*this);
+	cleanup();
+}
+
+void Raytracer::runValidation()
+{
+	createValidationScene();
+	init();
+
+	drawFrame();
+	vkut::common::waitGraphicsValue(frameValues[lastFrame]);
+
+	const uint32_t imageWidth = vkut::swapChainExtent.width;
+	const uint32_t imageHeight = vkut::swapChainExtent.height;
+	std::vector<uint8_t> gpuImage = readPresentedImage();
+	if (vkut::swapChainImageFormat == VK_FORMAT_B8G8R8A8_UNORM || vkut::swapChainImageFormat == VK_FORMAT_B8G8R8A8_SRGB)
+	{
+		for (size_t pixel = 0; pixel < gpuImage.size(); pixel += 4)
+		{
+			std::swap(gpuImage[pixel], gpuImage[pixel + 2]);
+		}
+	}
+
+	const CameraData cameraData = camera.getData(static_cast<float>(imageWidth) / static_cast<float>(imageHeight));
+	CpuRaytracer cpuRaytracer = CpuRaytracer(scene, jobs);
+	Stopwatch stopwatch = Stopwatch();
+	std::vector<uint8_t> cpuImage = cpuRaytracer.render(cameraData, imageWidth, imageHeight);
+	const double cpuMilliseconds = stopwatch.elapsedMilliseconds();
+
+	const ImageComparison comparison = compareImages(cpuImage, gpuImage, imageWidth, imageHeight);
+
+	BenchmarkReport report = BenchmarkReport("CPU reference against GPU", { "RMSE", "PSNR dB", "max error", "mismatched %", "CPU ms", "GPU ms" });
+	report.addRow("validation", { comparison.rmse, comparison.psnr, comparison.maxError, comparison.mismatchedPixelRatio * 100.0, cpuMilliseconds, getTraceMilliseconds(lastFrame) });
+	report.log();
+	report.writeCsv("validation_cpu_gpu.csv");
+
+	JobSystem::Counter writeCounter = {};
+	jobs.run(writeCounter, [&]() { writePpm("validation_gpu.ppm", gpuImage, imageWidth, imageHeight); });
+	jobs.run(writeCounter, [&]() { writePpm("validation_cpu.ppm", cpuImage, imageWidth, imageHeight); });
+	jobs.wait(writeCounter);
+
+	cleanup();
+}
+
+void Raytracer::runCpu()
+{
+	createScene();
+
+	const CameraData cameraData = camera.getData(static_cast<float>(width) / static_cast<float>(height));
+	CpuRaytracer cpuRaytracer = CpuRaytracer(scene, jobs);
+	Stopwatch stopwatch = Stopwatch();
+	std::vector<uint8_t> image = cpuRaytracer.render(cameraData, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	Logger::logMessageFormatted("Rendered %ix%i on the CPU in %f ms! ", width, height, stopwatch.elapsedMilliseconds());
+
+	writePpm("cpu_render.ppm", image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
 }
 
 void Raytracer::run()
 {
+	createScene();
 	init();
 
 	do
 	{
+		paceFrame();
 		glfwPollEvents();
+		pacer.inputSampled();
+		jobs.runMainThreadJobs();
 		drawFrame();
 	} while (!glfwWindowShouldClose(window));
 
+	const FramePacer::Stats stats = pacer.getStats();
+	Logger::logMessageFormatted("Input latency %f ms on average, %f ms at most, %f ms per frame over %llu frames! ",
+		stats.averageLatencyMilliseconds, stats.maxLatencyMilliseconds, stats.averageFrameMilliseconds, static_cast<unsigned long long>(stats.frameCount));
+
 	cleanup();
 }
 
+void Raytracer::setFramesInFlight(size_t count)
+{
+	assert(count >= 1 && count <= maxFramesInFlight);
+	framesInFlight = count;
+}
+
+void Raytracer::setPresentPolicy(vkut::PresentPolicy policy)
+{
+	vkut::presentPolicy = policy;
+	if (vkut::swapChain != VK_NULL_HANDLE) recreateSwapchainDependents();
+}
+
+void Raytracer::setFramePacing(bool enabled)
+{
+	framePacing = enabled;
+}
+
+void Raytracer::setAdaptiveSampling(bool enabled)
+{
+	samplingSettings.adaptive = enabled;
+}
+
+void Raytracer::setTargetFrameTime(double milliseconds)
+{
+	dynamicResolution = milliseconds > .0;
+	resolutionController.settings.targetMilliseconds = milliseconds;
+	resolutionController.reset();
+	if (vkut::swapChain != VK_NULL_HANDLE) setRenderExtent(dynamicResolution ? resolution::getRenderExtent(vkut::swapChainExtent, resolutionController.getScale()) : vkut::swapChainExtent);
+}
+
+void Raytracer::setTracePattern(reconstruction::TracePattern pattern)
+{
+	tracePattern = pattern;
+	historyValid = false;
+}
+
+void Raytracer::setDenoiser(bool enabled)
+{
+	denoise = enabled;
+	denoiserHistoryValid = false;
+	resetAccumulation = true;
+}
+
+void Raytracer::setPathBounces(uint32_t bounces)
+{
+	assert(bounces <= wavefront::maxBounces);
+	pathBounces = bounces;
+	resetAccumulation = true;
+}
+
+void Raytracer::setWavefront(bool enabled)
+{
+	wavefrontPaths = enabled;
+	resetAccumulation = true;
+}
+
+void Raytracer::setVisibilityQueries(bool enabled)
+{
+	visibilityQueries = enabled;
+	resetAccumulation = true;
+}
+
+void Raytracer::setHostBuilds(bool enabled)
+{
+	hostBuilds = enabled;
+}
+
+void Raytracer::setIndirectTrace(bool enabled)
+{
+	indirectTrace = enabled;
+}
+
+void Raytracer::updateRenderExtent()
+{
+	const float scale = resolutionController.update(gpuFrameMilliseconds);
+	const VkExtent2D extent = resolution::getRenderExtent(vkut::swapChainExtent, scale);
+	if (!setRenderExtent(extent)) return;
+
+	LOG_MESSAGE_FORMATTED("Tracing at %ux%u for %f ms! ", extent.width, extent.height, gpuFrameMilliseconds);
+}
+
+bool Raytracer::setRenderExtent(VkExtent2D extent)
+{
+	if (extent.width == renderExtent.width && extent.height == renderExtent.height) return false;
+
+	//the accumulated pixels no longer line up with the new ones
+	renderExtent = extent;
+	resetAccumulation = true;
+	historyValid = false;
+	denoiserHistoryValid = false;
+	return true;
+}
+
+void Raytracer::restartAccumulation()
+{
+	resetAccumulation = true;
+	convergence = {};
+}
+
+double Raytracer::drawFrameAndWait()
+{
+	glfwPollEvents();
+	drawFrame();
+	vkut::common::waitGraphicsValue(frameValues[lastFrame]);
+	return getTraceMilliseconds(lastFrame);
+}
+
+const adaptive::Convergence &Raytracer::collectConvergence()
+{
+	collectSamplingStats(lastFrame);
+	return convergence;
+}
+
+void Raytracer::drawPacedFrames(size_t count)
+{
+	for (size_t frame = 0; frame < count; frame++)
+	{
+		paceFrame();
+		glfwPollEvents();
+		pacer.inputSampled();
+		resetAccumulation = true;
+		drawFrame();
+	}
+	vkut::common::waitGraphicsValue(vkut::common::getSubmittedGraphicsValue());
+	pacer.framesCompleted(vkut::common::getSubmittedGraphicsValue());
+}
+
+std::vector<uint8_t> Raytracer::readPresentedImage()
+{
+	return vkut::common::readImage(commandPool, vkut::swapChainImages[lastImageIndex], VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, vkut::swapChainExtent.width, vkut::swapChainExtent.height, 4);
+}
+
+denoiser::PassMilliseconds Raytracer::getDenoiserPassMilliseconds()
+{
+	return denoiser::getPassMilliseconds(denoiserTimestamps, lastFrame, denoiserSettings);
+}
+
+wavefront::Stats Raytracer::getWavefrontStats()
+{
+	return wavefront::getStats(wavefrontTargets, lastFrame);
+}
+
+wavefront::StageMilliseconds Raytracer::getWavefrontStageMilliseconds()
+{
+	return wavefront::getStageMilliseconds(wavefrontTimestamps, lastFrame, pathBounces);
+}
+
+double Raytracer::getQueryMilliseconds()
+{
+	return queries::getMilliseconds(queryTimestamps, lastFrame);
+}
+
+void Raytracer::setBuildPolicy(vkut::raytracing::BuildPolicy policy)
+{
+	for (Scene::MeshHandle mesh = 0; mesh < scene.getMeshCount(); mesh++)
+	{
+		scene.setBuildPolicy(mesh, policy);
+	}
+}
+
 void Raytracer::cleanup()
 {
 	vkDeviceWaitIdle(vkut::device);
+	vkut::common::endDeferredDestruction();
 
 	vkut::common::destroyCommandBuffers(commandPool, commandBuffers);
 
@@ -492,9 +1463,34 @@ void Raytracer::cleanup()
 
 	vkut::common::destroyDescriptorSetLayout(descriptorSetLayout);
 
+	wavefront::destroyTargets(wavefrontTargets);
+	wavefront::destroyPipelines(wavefrontPipelines);
+	resolution::destroyUpscaler(upscaler);
+	queries::destroyTargets(queryTargets);
+	queries::destroyPipelines(queryPipelines);
+	resolution::destroyPipeline(upscalePipeline);
+	denoiser::destroyTargets(denoiserTargets);
+	denoiser::destroyPipelines(denoiserPipelines);
+	reconstruction::destroyTargets(reconstructionTargets);
+	reconstruction::destroyPipeline(reconstructionPipeline);
+	vkut::common::destroyStorageImage(traceImage);
+	adaptive::destroyTargets(samplingTargets);
+	adaptive::destroyPipeline(samplingPipeline);
+
+	destroyAccelerationStructures();
+
+	if (characterMesh != noMesh)
+	{
+		skinning::destroyPipeline(skinningPipeline);
+	}
+
+	vkut::common::destroyPersistentBuffer(cameraBuffer);
+	vkut::common::destroyBuffer(materialBuffer);
 
-	vkut::raytracing::destroyTopLevelAccelerationStructure(tlas);
-	vkut::raytracing::destroyBottomLevelAccelerationStructure(blas);
+	vkut::common::destroyTimestampQueries(queryTimestamps);
+	vkut::common::destroyTimestampQueries(wavefrontTimestamps);
+	vkut::common::destroyTimestampQueries(denoiserTimestamps);
+	vkut::common::destroyTimestampQueries(traceTimestamps);
 
 	vkut::setup::resourceQueue.popAll();
 }
\ No newline at end of file
@@ -1,26 +1,125 @@
 #pragma once
 #include "glfw3.h"
-#define VK_ENABLE_BETA_EXTENSIONS
 #include "vulkan.h"
-#define VKUT_USE_SETUP_RESOURCE_QUEUE
 #include "vkutils.h"
+#include "Scene.h"
+#include "Skinning.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "FramePacer.h"
+#include "AdaptiveSampling.h"
+#include "DynamicResolution.h"
+#include "Reconstruction.h"
+#include "Denoiser.h"
+#include "Wavefront.h"
+#include "RayQueries.h"
+#include <limits>
 
 class Raytracer
 {
 public:
 
 	void run();
+	void runBenchmark();
+	//renders one frame on both the GPU and the CPU reference and reports how far apart they are
+	void runValidation();
+	//software fallback, does not touch Vulkan
+	void runCpu();
+	//host ray query benchmarks, does not touch Vulkan either
+	void runCpuBenchmark();
+
+	//frames the host may record ahead of the GPU, 1 to maxFramesInFlight, has to be set before running
+	void setFramesInFlight(size_t count);
+	void setPresentPolicy(vkut::PresentPolicy policy);
+	//sleeps before sampling input so frames reach the GPU just in time, trades a little throughput for input latency
+	void setFramePacing(bool enabled);
+	//variance driven sample budgets, otherwise every pixel traces one sample per frame until it reached the maximum
+	void setAdaptiveSampling(bool enabled);
+	//adjusts the trace resolution to hold the frame time on the GPU, 0 traces at the swapchain resolution
+	void setTargetFrameTime(double milliseconds);
+	//traces every pixel, or half or a quarter of them every frame and reconstructs the others from the previous frames
+	void setTracePattern(reconstruction::TracePattern pattern);
+	//traces one sample per pixel every frame and denoises it instead of accumulating samples
+	void setDenoiser(bool enabled);
+	//diffuse bounces under a white sky after the first hit, 0 to wavefront::maxBounces, 0 shows the albedo of the first hit
+	void setPathBounces(uint32_t bounces);
+	//traces one path per pixel every frame with the wavefront kernels instead of the ray tracing pipeline, bypassing the accumulation
+	void setWavefront(bool enabled);
+	//shows the first hit shaded by the sun, its shadow and the ambient occlusion, traced with ray queries, instead of the traced image
+	void setVisibilityQueries(bool enabled);
+	//builds the static BLASes on the CPU, joined by the worker threads, instead of on the graphics queue where it waits for the frames in flight
+	//falls back to device builds when the device has no host commands, takes effect with the next rebuild
+	void setHostBuilds(bool enabled);
+	//launches the trace only over the tiles with pixels left to sample, with the launch size written on the GPU by adaptive::recordTiles
+	//falls back to launching every pixel when the device can't trace rays indirectly
+	void setIndirectTrace(bool enabled);
+
+	static constexpr size_t maxFramesInFlight = 4;
+
+	//benchmark hooks, only Benchmarks.cpp calls these and the frame loop never does, the frame calls need an initialized renderer
+
+	//the next frame discards the accumulation and the convergence starts over
+	void restartAccumulation();
+	//draws one frame and waits for it, returns its GPU time
+	double drawFrameAndWait();
+	//the convergence including the last frame drawn
+	const adaptive::Convergence &collectConvergence();
+	//paces, draws and waits for count frames the way the frame loop does, each one with a fresh accumulation
+	void drawPacedFrames(size_t count);
+	void resetPacingStats() { pacer.resetStats(); }
+	FramePacer::Stats getPacingStats() const { return pacer.getStats(); }
+	//the swapchain image of the last frame drawn
+	std::vector<uint8_t> readPresentedImage();
+	//the next frame traces the pixels and directions of the first frame again
+	void restartTraceFrames() { traceFrame = 0; }
+
+	//of the last frame drawn
+	denoiser::PassMilliseconds getDenoiserPassMilliseconds();
+	wavefront::Stats getWavefrontStats();
+	wavefront::StageMilliseconds getWavefrontStageMilliseconds();
+	double getQueryMilliseconds();
+
+	//also recreates everything referencing the TLAS, the previous ones are destroyed once the frames in flight are done with them
+	void rebuildAccelerationStructures();
+	//of every mesh, takes effect with the next rebuild
+	void setBuildPolicy(vkut::raytracing::BuildPolicy policy);
+	//takes effect with the next rebuild
+	void setGeometryPlacement(vkut::raytracing::MemoryPlacement placement) { geometryPlacement = placement; }
+	vkut::raytracing::MemoryPlacement getGeometryPlacement() const { return geometryPlacement; }
+	const std::vector<vkut::raytracing::BottomLevelAccelerationStructure> &getBottomLevelAccelerationStructures() const { return blases; }
+	const Scene &getScene() const { return scene; }
+	JobSystem &getJobs() { return jobs; }
+
+	//what the benchmarks change and put back
+	size_t getFramesInFlight() const { return framesInFlight; }
+	bool getFramePacing() const { return framePacing; }
+	//0 when tracing at the swapchain resolution
+	double getTargetFrameTime() const { return dynamicResolution ? resolutionController.settings.targetMilliseconds : .0; }
+	VkExtent2D getRenderExtent() const { return renderExtent; }
+	VkExtent2D getWindowExtent() const { return { static_cast<uint32_t>(width), static_cast<uint32_t>(height) }; }
+	const Camera &getCamera() const { return camera; }
+	void setCameraPosition(const glm::vec3 &position) { camera.position = position; }
+	const adaptive::Settings &getSamplingSettings() const { return samplingSettings; }
+	void setSamplingSettings(const adaptive::Settings &settings) { samplingSettings = settings; }
+	bool getIndirectTrace() const { return indirectTrace; }
+	reconstruction::TracePattern getTracePattern() const { return tracePattern; }
+	bool getDenoiser() const { return denoise; }
+	const denoiser::Settings &getDenoiserSettings() const { return denoiserSettings; }
+	uint32_t getPathBounces() const { return pathBounces; }
+	bool getWavefront() const { return wavefrontPaths; }
+	const wavefront::Settings &getWavefrontSettings() const { return wavefrontSettings; }
+	void setWavefrontSettings(const wavefront::Settings &settings) { wavefrontSettings = settings; }
+	bool getVisibilityQueries() const { return visibilityQueries; }
+	const queries::Settings &getQuerySettings() const { return querySettings; }
+	void setQuerySettings(const queries::Settings &settings) { querySettings = settings; }
 
 private:
 
 	static constexpr const char *title = "Raytracing!";	
 	const std::vector<const char *> requiredExtensions = {
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-		VK_KHR_RAY_TRACING_EXTENSION_NAME,
-		VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
 		VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
 		VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
-		VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
 		VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME
 	};
 
@@ -31,25 +130,117 @@ private:
 		0.0f, -1.0f, .0f
 	};
 	const std::vector<uint32_t> indices = { 0, 1, 2 };
-	static constexpr size_t maxFramesInFlight = 2;
+	size_t framesInFlight = 2;
 	size_t currentFrame = 0;
+	//graphics timeline value each frame in flight signals, its command buffer is free again once the timeline reached it
+	uint64_t frameValues[maxFramesInFlight] = {};
 
 	GLFWwindow *window = nullptr;
 	int width = 1366;
 	int height = 768;
 	bool windowResized = false;
 
+	JobSystem jobs;
+
+	bool framePacing = false;
+	FramePacer pacer;
+	//GPU time of the last frame whose timestamps were read
+	double gpuFrameMilliseconds = 0.0;
+
 	VkCommandPool commandPool = {};
 	std::vector<VkCommandBuffer> commandBuffers = {};
-	vkut::raytracing::BottomLevelAccelerationStructure blas = {};
+	Scene scene = {};
+	std::vector<vkut::raytracing::BottomLevelAccelerationStructure> blases = {};
 	vkut::raytracing::TopLevelAccelerationStructure tlas = {};
+	vkut::raytracing::MemoryPlacement geometryPlacement = vkut::raytracing::MemoryPlacement::DEVICE_LOCAL;
+	bool hostBuilds = false;
 	VkDescriptorSetLayout descriptorSetLayout = {};
 	VkDescriptorPool descriptorPool = {};
-	std::vector<VkDescriptorSet> descriptorSets = {};
+	VkDescriptorSet descriptorSet = {};
 	std::vector<VkDescriptorType> descriptorTypes = {};
 	VkPipelineLayout pipelineLayout = {};
 	VkPipeline pipeline = {};
 	vkut::raytracing::ShaderBindingTable shaderBindingTable = {};
+	vkut::TimestampQueries traceTimestamps = {};
+	size_t lastFrame = 0;
+	uint32_t lastImageIndex = 0;
+
+	vkut::PersistentBuffer cameraBuffer = {};
+	vkut::Buffer materialBuffer = {};
+	//vertex and index addresses of every instance, the bounces need the normals of the triangles they hit
+	vkut::Buffer geometryBuffer = {};
+	Camera camera = { .position = glm::vec3(.0f, .0f, 2.5f), .verticalFieldOfView = 60.0f };
+	CameraData lastCameraData = {};
+
+	adaptive::Settings samplingSettings = {};
+	adaptive::Pipeline samplingPipeline = {};
+	adaptive::Targets samplingTargets = {};
+	//the next frame discards the accumulation, set whenever the camera, the scene or the targets changed
+	bool resetAccumulation = true;
+	//counts resets, so that frames recorded before the latest one are left out of the convergence
+	uint64_t accumulationEpoch = 0;
+	//epoch each frame in flight was recorded in, 0 once its stats were collected
+	uint64_t frameEpochs[maxFramesInFlight] = {};
+	adaptive::Convergence convergence = {};
+	//toggled with H
+	bool showSampleHeatmap = false;
+	bool indirectTrace = false;
+	//the next frame launches every tile, as the tiles left out would keep the previous debug view
+	bool redrawTraceImage = false;
+
+	bool dynamicResolution = false;
+	resolution::Controller resolutionController = {};
+	resolution::Pipeline upscalePipeline = {};
+	resolution::Upscaler upscaler = {};
+	//the trace writes its top left renderExtent, which is upscaled into the swapchain image
+	vkut::StorageImage traceImage = {};
+	VkExtent2D renderExtent = {};
+
+	reconstruction::TracePattern tracePattern = reconstruction::TracePattern::FULL;
+	reconstruction::Pipeline reconstructionPipeline = {};
+	reconstruction::Targets reconstructionTargets = {};
+	//frames recorded since the start, selects the pixels of the pattern traced
+	uint32_t traceFrame = 0;
+	//history the next reconstruction writes, the other one holds the previous frame
+	size_t historyIndex = 0;
+	//cleared whenever the history no longer lines up with the trace, such as after the pattern or the extent changed
+	bool historyValid = false;
+
+	//toggled with D
+	bool denoise = false;
+	denoiser::Settings denoiserSettings = {};
+	denoiser::Pipelines denoiserPipelines = {};
+	denoiser::Targets denoiserTargets = {};
+	vkut::TimestampQueries denoiserTimestamps = {};
+	size_t denoiserHistoryIndex = 0;
+	bool denoiserHistoryValid = false;
+
+	uint32_t pathBounces = 0;
+	//toggled with W
+	bool wavefrontPaths = false;
+	wavefront::Settings wavefrontSettings = {};
+	wavefront::Pipelines wavefrontPipelines = {};
+	wavefront::Targets wavefrontTargets = {};
+	vkut::TimestampQueries wavefrontTimestamps = {};
+
+	//toggled with V
+	bool visibilityQueries = false;
+	queries::Settings querySettings = {};
+	queries::Pipelines queryPipelines = {};
+	queries::Targets queryTargets = {};
+	vkut::TimestampQueries queryTimestamps = {};
+	//render resolution pixel clicked, picked by the next frame recorded
+	bool pickPending = false;
+	VkOffset2D pickPixel = {};
+	//frames in flight whose pick result has not been read yet
+	bool pickRecorded[maxFramesInFlight] = {};
+
+	static constexpr Scene::MeshHandle noMesh = std::numeric_limits<Scene::MeshHandle>::max();
+	static constexpr uint32_t characterJointCount = 4;
+	skinning::MeshDescription characterDescription = {};
+	Scene::MeshHandle characterMesh = noMesh;
+	skinning::SkinnedMesh character = {};
+	skinning::Pipeline skinningPipeline = {};
 
 	const uint32_t raygenShaderIndex = 0U;
 	const uint32_t missShaderIndex = 1U;
@@ -60,16 +251,44 @@ private:
 
 	void recreateSwapchainDependents();
 
-	void recordCommandBuffers();
+	//command buffers are recorded every frame for the current frame in flight
+	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+	void updateCamera();
+
+	void createScene();
+	void createBenchmarkScene();
+	void createCharacter();
+	void createValidationScene();
+	//records the deformation and the TLAS refit ahead of the trace
+	void animateCharacter(VkCommandBuffer commandBuffer);
 
 	void createAccelerationStructures();
+	//runs join on the calling thread and up to concurrency - 1 workers
+	void joinOnWorkers(uint32_t concurrency, const std::function<void()> &join);
+	void destroyAccelerationStructures();
+	void createMaterialBuffer();
 	std::vector<VkDescriptorType> createDescriptorSetLayout();
 	void createDescriptorPool();
-	void createDescriptorSets();
+	void createDescriptorSet();
+	//the wavefront kernels read the TLAS, the buffers of the scene and the trace image
+	void createWavefrontDescriptorSets();
 	void createPipeline();
 
+	//waits and sleeps as setFramePacing asks for, right before input is sampled
+	void paceFrame();
 	void drawFrame();
+	double getTraceMilliseconds(size_t frame);
+	//adds the sampling stats of a completed frame in flight to the convergence, once
+	void collectSamplingStats(size_t frame);
+	//logs what the pick query of a completed frame in flight hit, once
+	void collectPick(size_t frame);
+	//feeds the last GPU frame time to the resolution controller
+	void updateRenderExtent();
+	//discards the accumulation and the history if the extent changed, returns whether it did
+	bool setRenderExtent(VkExtent2D extent);
 
 	static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
+	static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+	static void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
 };
 
@@ -0,0 +1,152 @@
+#include "Reconstruction.h"
+#include <assert.h>
+#include "Logger/Logger.h"
+
+namespace {
+
+	//matches the push constant block in reconstruct.comp
+	struct PushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t historyValid;
+	};
+
+	//trace, accumulation, motion, previous history and result
+	constexpr uint32_t bindingCount = 5;
+}
+
+namespace reconstruction {
+
+	Pipeline createPipeline()
+	{
+		Pipeline pipeline = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(bindingCount);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipeline.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipeline.layout = vkut::common::createPipelineLayout({ pipeline.descriptorSetLayout }, { pushConstantRange });
+
+		VkShaderModule shaderModule = vkut::common::createShaderModule("../Assets/shaders/reconstruct.comp.spv");
+		pipeline.pipeline = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		return pipeline;
+	}
+
+	void destroyPipeline(Pipeline pipeline)
+	{
+		vkut::common::destroyPipeline(pipeline.pipeline);
+		vkut::common::destroyPipelineLayout(pipeline.layout);
+		vkut::common::destroyDescriptorSetLayout(pipeline.descriptorSetLayout);
+	}
+
+	Targets createTargets(VkCommandPool commandPool, const Pipeline &pipeline, VkExtent2D extent, VkImageView traceView, VkImageView accumulationView)
+	{
+		Targets targets
+		{
+			.motion = vkut::common::createStorageImage(commandPool, extent, motionFormat),
+			.history =
+			{
+				vkut::common::createStorageImage(commandPool, extent, historyFormat),
+				vkut::common::createStorageImage(commandPool, extent, historyFormat)
+			}
+		};
+
+		targets.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }, 2U * bindingCount, 2U);
+
+		for (size_t i = 0; i < 2U; i++)
+		{
+			const VkImageView views[bindingCount] = { traceView, accumulationView, targets.motion.view, targets.history[1U - i].view, targets.history[i].view };
+			VkDescriptorImageInfo imageInfos[bindingCount] = {};
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(bindingCount);
+			for (uint32_t binding = 0; binding < bindingCount; binding++)
+			{
+				imageInfos[binding] = { .sampler = VK_NULL_HANDLE, .imageView = views[binding], .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+				descriptorSetInfos[binding] = vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = binding,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+					.pImageInfo = &imageInfos[binding],
+					.pBufferInfo = nullptr,
+					.pTexelBufferView = nullptr
+				};
+			}
+
+			targets.descriptorSets[i] = vkut::common::createDescriptorSet(pipeline.descriptorSetLayout, targets.descriptorPool, descriptorSetInfos);
+		}
+
+		Logger::logMessageFormatted("Created reconstruction targets of %ux%u! ", extent.width, extent.height);
+
+		return targets;
+	}
+
+	void destroyTargets(Targets targets)
+	{
+		vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		vkut::common::destroyStorageImage(targets.history[1]);
+		vkut::common::destroyStorageImage(targets.history[0]);
+		vkut::common::destroyStorageImage(targets.motion);
+	}
+
+	uint32_t getPeriod(TracePattern pattern)
+	{
+		switch (pattern)
+		{
+		case TracePattern::CHECKERBOARD: return 2;
+		case TracePattern::INTERLEAVED: return 4;
+		default: return 1;
+		}
+	}
+
+	VkExtent2D getLaunchExtent(VkExtent2D extent, TracePattern pattern)
+	{
+		switch (pattern)
+		{
+		case TracePattern::CHECKERBOARD: return VkExtent2D{ (extent.width + 1U) / 2U, extent.height };
+		case TracePattern::INTERLEAVED: return VkExtent2D{ (extent.width + 1U) / 2U, (extent.height + 1U) / 2U };
+		default: return extent;
+		}
+	}
+
+	void recordReconstruction(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t historyIndex, VkExtent2D extent, bool historyValid)
+	{
+		assert(historyIndex < 2U);
+		assert(extent.width <= targets.motion.extent.width && extent.height <= targets.motion.extent.height);
+
+		PushConstants pushConstants
+		{
+			.width = extent.width,
+			.height = extent.height,
+			.historyValid = historyValid ? 1U : 0U
+		};
+
+		//the previous frame wrote the history read here and upscaled from the one written here
+		vkut::common::recordShaderBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &targets.descriptorSets[historyIndex], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (extent.width + workgroupSize - 1) / workgroupSize, (extent.height + workgroupSize - 1) / workgroupSize, 1);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "vkutils.h"
+
+//traces half or a quarter of the pixels every frame and fills in the others from the previous frame
+//reconstruct.comp reprojects the history along the motion vectors of the traced neighbours and clamps it to their colors
+namespace reconstruction {
+
+	constexpr uint32_t workgroupSize = 8;
+
+	constexpr VkFormat motionFormat = VK_FORMAT_R16G16_SFLOAT;
+	//same as the trace, so that the upscale reads either of them
+	constexpr VkFormat historyFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+	//matches the pattern values in raytrace.rgen and sampleBudget.comp
+	enum class TracePattern : uint32_t
+	{
+		FULL = 0,
+		//every other pixel, alternating every frame
+		CHECKERBOARD = 1,
+		//one pixel of every 2x2 block, all four of them within four frames
+		INTERLEAVED = 2
+	};
+
+	struct Pipeline
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+	};
+
+	struct Targets
+	{
+		//pixels the first hit of every traced pixel moved by since the previous frame
+		vkut::StorageImage motion;
+		//the reconstruction of the current frame goes into one of them while the other one holds the previous frame
+		vkut::StorageImage history[2];
+		VkDescriptorPool descriptorPool;
+		//the set at index i writes history[i]
+		VkDescriptorSet descriptorSets[2];
+	};
+
+	[[nodiscard]]
+	Pipeline createPipeline();
+	void destroyPipeline(Pipeline pipeline);
+
+	//traceView and accumulationView are the images written by the trace, of at least the same extent
+	[[nodiscard]]
+	Targets createTargets(VkCommandPool commandPool, const Pipeline &pipeline, VkExtent2D extent, VkImageView traceView, VkImageView accumulationView);
+	void destroyTargets(Targets targets);
+
+	//frames until every pixel was traced once
+	uint32_t getPeriod(TracePattern pattern);
+	//launch size that covers the pixels of the pattern in the extent
+	VkExtent2D getLaunchExtent(VkExtent2D extent, TracePattern pattern);
+
+	//fills the pixels of the top left extent without samples into history[historyIndex], reprojecting the other history if historyValid
+	//the trace has to be behind a barrier to the compute stage, the upscale reading the result behind another one
+	void recordReconstruction(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const Targets &targets, size_t historyIndex, VkExtent2D extent, bool historyValid);
+}
@@ -1,18 +1,266 @@
 #include "ResourceQueue.h"
+#include "vkutils.h"
+#include "glfw3.h"
+#include "Logger/Logger.h"
+#include <algorithm>
+#include <assert.h>
 
 namespace vkut {
-	void ResourceQueue::push(const VoidFunction &destroyFunc)
+
+	namespace {
+
+		//the setup queue holds a few dozen entries, scenes a few hundred
+		constexpr size_t initialCapacity = 256;
+
+		//non dispatchable handles are pointers on 64 bit and integers on 32 bit targets
+		template<typename Handle>
+		Handle fromHandle(uint64_t handle)
+		{
+			if constexpr (std::is_pointer_v<Handle>)
+			{
+				return reinterpret_cast<Handle>(handle);
+			}
+			else
+			{
+				return static_cast<Handle>(handle);
+			}
+		}
+	}
+
+	ResourceQueue::ResourceQueue()
+	{
+		entries.reserve(initialCapacity);
+		retiredEntries.reserve(initialCapacity);
+	}
+
+	void ResourceQueue::push(ResourceType type)
+	{
+		assert(type >= ResourceType::SYNC_OBJECTS);
+		entries.push_back({ 0, type });
+	}
+
+	void ResourceQueue::push(const Buffer &buffer)
+	{
+		push(ResourceType::DEVICE_MEMORY, buffer.memory);
+		push(ResourceType::BUFFER, buffer.buffer);
+	}
+
+	void ResourceQueue::push(const Image &image)
 	{
-		queue.push_back(destroyFunc);
+		push(ResourceType::DEVICE_MEMORY, image.memory);
+		push(ResourceType::IMAGE, image.image);
+	}
+
+	void ResourceQueue::push(const PersistentBuffer &persistentBuffer)
+	{
+		push(ResourceType::MAPPED_MEMORY, persistentBuffer.buffer.memory);
+		push(ResourceType::BUFFER, persistentBuffer.buffer.buffer);
+	}
+
+	void ResourceQueue::push(const TimestampQueries &queries)
+	{
+		push(ResourceType::QUERY_POOL, queries.pool);
+	}
+
+	void ResourceQueue::push(const raytracing::MappedBuffer &mappedBuffer)
+	{
+		if (mappedBuffer.buffer == VK_NULL_HANDLE) return;
+
+		push(mappedBuffer.mappedPointer != nullptr ? ResourceType::MAPPED_MEMORY : ResourceType::DEVICE_MEMORY, mappedBuffer.memory);
+		push(ResourceType::BUFFER, mappedBuffer.buffer);
+	}
+
+	void ResourceQueue::push(const raytracing::BottomLevelAccelerationStructure &blas)
+	{
+		push(blas.mappedBuffer);
+		push(blas.indexBuffer);
+		push(blas.vertexBuffer);
+		push(blas.scratchBuffer);
+		push(ResourceType::ACCELERATION_STRUCTURE, blas.accelerationStructure);
+	}
+
+	void ResourceQueue::push(const raytracing::TopLevelAccelerationStructure &tlas)
+	{
+		push(tlas.mappedBuffer);
+		push(tlas.instanceBuffer);
+		push(tlas.scratchBuffer);
+		push(ResourceType::ACCELERATION_STRUCTURE, tlas.accelerationStructure);
+	}
+
+	void ResourceQueue::beginScope()
+	{
+		scopeBegins.push_back(entries.size());
+	}
+
+	void ResourceQueue::endScope()
+	{
+		assert(!scopeBegins.empty());
+		const size_t begin = scopeBegins.back();
+		scopeBegins.pop_back();
+
+		destroyRange(entries.data() + begin, entries.data() + entries.size());
+		entries.resize(begin);
+	}
+
+	void ResourceQueue::endScope(uint64_t value)
+	{
+		assert(!scopeBegins.empty());
+		const size_t begin = scopeBegins.back();
+		scopeBegins.pop_back();
+
+		retiredEntries.insert(retiredEntries.end(), entries.begin() + begin, entries.end());
+		retiredScopes.push_back({ value, retiredEntries.size() });
+		entries.resize(begin);
+	}
+
+	void ResourceQueue::collect(uint64_t reachedValue)
+	{
+		//scopes that are still pending are moved down over the destroyed ones
+		size_t keptScopes = 0;
+		size_t keptEntries = 0;
+		size_t begin = 0;
+		for (size_t i = 0; i < retiredScopes.size(); i++)
+		{
+			const RetiredScope scope = retiredScopes[i];
+			if (scope.value <= reachedValue)
+			{
+				destroyRange(retiredEntries.data() + begin, retiredEntries.data() + scope.end);
+			}
+			else
+			{
+				std::copy(retiredEntries.begin() + begin, retiredEntries.begin() + scope.end, retiredEntries.begin() + keptEntries);
+				keptEntries += scope.end - begin;
+				retiredScopes[keptScopes++] = { scope.value, keptEntries };
+			}
+			begin = scope.end;
+		}
+
+		retiredEntries.resize(keptEntries);
+		retiredScopes.resize(keptScopes);
 	}
 
 	void ResourceQueue::popAll()
 	{
-		while(!queue.empty())
+		//pending scopes were nested in the live ones
+		size_t begin = 0;
+		for (const RetiredScope &scope : retiredScopes)
 		{
-			queue[queue.size() - 1U]();
-			queue.pop_back();
-		}		
+			destroyRange(retiredEntries.data() + begin, retiredEntries.data() + scope.end);
+			begin = scope.end;
+		}
+		retiredEntries.clear();
+		retiredScopes.clear();
+
+		destroyRange(entries.data(), entries.data() + entries.size());
+		entries.clear();
+		scopeBegins.clear();
+	}
+
+	void ResourceQueue::destroyRange(const Entry *first, const Entry *last)
+	{
+		while (last != first)
+		{
+			last--;
+			destroy(*last);
+		}
 	}
-}
 
+	void ResourceQueue::destroy(const Entry &entry)
+	{
+		switch (entry.type)
+		{
+		case ResourceType::BUFFER:
+			vkDestroyBuffer(device, fromHandle<VkBuffer>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Destroyed buffer %u! ", fromHandle<VkBuffer>(entry.handle));
+			break;
+		case ResourceType::DEVICE_MEMORY:
+			vkFreeMemory(device, fromHandle<VkDeviceMemory>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Freed memory %u! ", fromHandle<VkDeviceMemory>(entry.handle));
+			break;
+		case ResourceType::MAPPED_MEMORY:
+			vkUnmapMemory(device, fromHandle<VkDeviceMemory>(entry.handle));
+			vkFreeMemory(device, fromHandle<VkDeviceMemory>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Freed mapped memory %u! ", fromHandle<VkDeviceMemory>(entry.handle));
+			break;
+		case ResourceType::IMAGE:
+			vkDestroyImage(device, fromHandle<VkImage>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed image %u! ", fromHandle<VkImage>(entry.handle));
+			break;
+		case ResourceType::IMAGE_VIEW:
+			vkDestroyImageView(device, fromHandle<VkImageView>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed image view %u! ", fromHandle<VkImageView>(entry.handle));
+			break;
+		case ResourceType::FRAMEBUFFER:
+			vkDestroyFramebuffer(device, fromHandle<VkFramebuffer>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed framebuffer %u! ", fromHandle<VkFramebuffer>(entry.handle));
+			break;
+		case ResourceType::RENDER_PASS:
+			vkDestroyRenderPass(device, fromHandle<VkRenderPass>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed render pass %u! ", fromHandle<VkRenderPass>(entry.handle));
+			break;
+		case ResourceType::DESCRIPTOR_POOL:
+			vkDestroyDescriptorPool(device, fromHandle<VkDescriptorPool>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed descriptor pool %u! ", fromHandle<VkDescriptorPool>(entry.handle));
+			break;
+		case ResourceType::DESCRIPTOR_SET_LAYOUT:
+			vkDestroyDescriptorSetLayout(device, fromHandle<VkDescriptorSetLayout>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed descriptor set layout %u! ", fromHandle<VkDescriptorSetLayout>(entry.handle));
+			break;
+		case ResourceType::PIPELINE_LAYOUT:
+			vkDestroyPipelineLayout(device, fromHandle<VkPipelineLayout>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed pipeline layout %u! ", fromHandle<VkPipelineLayout>(entry.handle));
+			break;
+		case ResourceType::PIPELINE:
+			vkDestroyPipeline(device, fromHandle<VkPipeline>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed pipeline %u! ", fromHandle<VkPipeline>(entry.handle));
+			break;
+		case ResourceType::SHADER_MODULE:
+			vkDestroyShaderModule(device, fromHandle<VkShaderModule>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Destroyed shader module %u! ", fromHandle<VkShaderModule>(entry.handle));
+			break;
+		case ResourceType::QUERY_POOL:
+			vkDestroyQueryPool(device, fromHandle<VkQueryPool>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Destroyed query pool %u! ", fromHandle<VkQueryPool>(entry.handle));
+			break;
+		case ResourceType::COMMAND_POOL:
+			setup::destroyCommandPool(fromHandle<VkCommandPool>(entry.handle));
+			break;
+		case ResourceType::ACCELERATION_STRUCTURE:
+			raytracing::vkDestroyAccelerationStructureKHR(device, fromHandle<VkAccelerationStructureKHR>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed acceleration structure %u! ", fromHandle<VkAccelerationStructureKHR>(entry.handle));
+			break;
+		case ResourceType::SEMAPHORE:
+			vkDestroySemaphore(device, fromHandle<VkSemaphore>(entry.handle), nullptr);
+			LOG_TRIVIAL_FORMATTED("Destroyed semaphore %u! ", fromHandle<VkSemaphore>(entry.handle));
+			break;
+		case ResourceType::RETIRED_SWAPCHAIN:
+			vkDestroySwapchainKHR(device, fromHandle<VkSwapchainKHR>(entry.handle), nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed retired swapchain %u! ", fromHandle<VkSwapchainKHR>(entry.handle));
+			break;
+		case ResourceType::WINDOW:
+			setup::destroyWindow(fromHandle<GLFWwindow *>(entry.handle));
+			break;
+		case ResourceType::SYNC_OBJECTS:
+			setup::destroySyncObjects();
+			break;
+		case ResourceType::SWAPCHAIN_IMAGE_VIEWS:
+			setup::destroySwapchainImageViews();
+			break;
+		case ResourceType::SWAPCHAIN:
+			setup::destroySwapChain();
+			break;
+		case ResourceType::LOGICAL_DEVICE:
+			setup::destroyLogicalDevice();
+			break;
+		case ResourceType::SURFACE:
+			setup::destroySurface();
+			break;
+		case ResourceType::DEBUG_MESSENGER:
+			setup::destroyDebugMessenger();
+			break;
+		case ResourceType::INSTANCE:
+			setup::destroyInstance();
+			break;
+		}
+	}
+}
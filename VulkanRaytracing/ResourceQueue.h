@@ -1,22 +1,125 @@
 #pragma once
+#include "vulkan.h"
+#include <cstdint>
+#include <type_traits>
 #include <vector>
-#include <functional>
 
-using VoidFunction = std::function<void()>;
+struct GLFWwindow;
 
 namespace vkut {
 
+	struct Buffer;
+	struct Image;
+	struct PersistentBuffer;
+	struct TimestampQueries;
+
+	namespace raytracing {
+		struct MappedBuffer;
+		struct BottomLevelAccelerationStructure;
+		struct TopLevelAccelerationStructure;
+	}
+
+	enum class ResourceType : uint32_t
+	{
+		BUFFER,
+		DEVICE_MEMORY,
+		//unmapped before it is freed
+		MAPPED_MEMORY,
+		IMAGE,
+		IMAGE_VIEW,
+		FRAMEBUFFER,
+		RENDER_PASS,
+		DESCRIPTOR_POOL,
+		DESCRIPTOR_SET_LAYOUT,
+		PIPELINE_LAYOUT,
+		PIPELINE,
+		SHADER_MODULE,
+		QUERY_POOL,
+		COMMAND_POOL,
+		ACCELERATION_STRUCTURE,
+		SEMAPHORE,
+		//replaced by setup::recreateSwapChain while frames in flight may still present to it
+		RETIRED_SWAPCHAIN,
+		WINDOW,
+		//the setup objects below are the vkut globals, their entries carry no handle
+		SYNC_OBJECTS,
+		SWAPCHAIN_IMAGE_VIEWS,
+		SWAPCHAIN,
+		LOGICAL_DEVICE,
+		SURFACE,
+		DEBUG_MESSENGER,
+		INSTANCE
+	};
+
+	//deletion queue of (type, handle) pairs in one flat array, destroyed newest first
+	//scopes nest on top of each other, e.g. setup objects at the bottom, then per scene, then per frame
+	//a scope ended with a timeline value is only destroyed once the timeline reached it, so resources still used by frames in flight can go without waiting for the device
 	class ResourceQueue
 	{
 	public:
 
-		void push(const VoidFunction &destroyFunc);
+		ResourceQueue();
+
+		template<typename Handle>
+		void push(ResourceType type, Handle handle)
+		{
+			if constexpr (std::is_pointer_v<Handle>)
+			{
+				entries.push_back({ reinterpret_cast<uint64_t>(handle), type });
+			}
+			else
+			{
+				entries.push_back({ static_cast<uint64_t>(handle), type });
+			}
+		}
+
+		//setup objects the queue finds through the vkut globals
+		void push(ResourceType type);
+
+		void push(const Buffer &buffer);
+		void push(const Image &image);
+		void push(const PersistentBuffer &persistentBuffer);
+		void push(const TimestampQueries &queries);
+		void push(const raytracing::MappedBuffer &mappedBuffer);
+		void push(const raytracing::BottomLevelAccelerationStructure &blas);
+		void push(const raytracing::TopLevelAccelerationStructure &tlas);
+
+		void beginScope();
+		//destroys everything pushed since the matching beginScope right away
+		void endScope();
+		//hands the scope over to collect, value must not be reached before the last submission using its resources completed
+		void endScope(uint64_t value);
+
+		//destroys the ended scopes whose value the timeline reached
+		void collect(uint64_t reachedValue);
+
+		bool isEmpty() const { return entries.empty() && retiredEntries.empty(); }
+
+		//destroys everything including pending scopes, the device has to be idle
 		void popAll();
 
 	private:
-		
-		std::vector<VoidFunction> queue;
-	};
-}
 
+		struct Entry
+		{
+			uint64_t handle;
+			ResourceType type;
+		};
+
+		struct RetiredScope
+		{
+			uint64_t value;
+			//end of the scope in retiredEntries, it starts where the previous one ends
+			size_t end;
+		};
 
+		std::vector<Entry> entries;
+		std::vector<size_t> scopeBegins;
+
+		std::vector<Entry> retiredEntries;
+		std::vector<RetiredScope> retiredScopes;
+
+		static void destroy(const Entry &entry);
+		static void destroyRange(const Entry *first, const Entry *last);
+	};
+}
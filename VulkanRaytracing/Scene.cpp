@@ -0,0 +1,168 @@
+#include "Scene.h"
+#include <assert.h>
+#include <cmath>
+#include "Logger/Logger.h"
+
+namespace {
+
+	//FNV-1a
+	size_t hashBytes(const void *data, size_t size, size_t hash = 14695981039346656037ULL)
+	{
+		const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	size_t hashMesh(const std::vector<float> &vertices, const std::vector<uint32_t> &indices)
+	{
+		size_t hash = hashBytes(vertices.data(), vertices.size() * sizeof(float));
+		return hashBytes(indices.data(), indices.size() * sizeof(uint32_t), hash);
+	}
+}
+
+Scene::MeshHandle Scene::addMesh(const std::vector<float> &vertices, const std::vector<uint32_t> &indices, vkut::raytracing::BuildPolicy buildPolicy)
+{
+	assert(vertices.size() % 3 == 0 && indices.size() % 3 == 0);
+
+	size_t hash = hashMesh(vertices, indices);
+	auto range = meshLookup.equal_range(hash);
+	for (auto it = range.first; it != range.second; it++)
+	{
+		const Mesh &candidate = meshes[it->second];
+		if (!candidate.deformable && candidate.buildPolicy == buildPolicy && candidate.vertices == vertices && candidate.indices == indices)
+		{
+			LOG_TRIVIAL_FORMATTED("Reusing mesh %u! ", it->second);
+			return it->second;
+		}
+	}
+
+	MeshHandle handle = static_cast<MeshHandle>(meshes.size());
+	meshes.push_back(Mesh{ .vertices = vertices, .indices = indices, .buildPolicy = buildPolicy, .deformable = false });
+	meshLookup.emplace(hash, handle);
+
+	LOG_TRIVIAL_FORMATTED("Added mesh %u with %u triangles! ", handle, static_cast<uint32_t>(indices.size() / 3));
+	return handle;
+}
+
+Scene::MeshHandle Scene::addDeformableMesh(const std::vector<float> &vertices, const std::vector<uint32_t> &indices)
+{
+	assert(vertices.size() % 3 == 0 && indices.size() % 3 == 0);
+
+	MeshHandle handle = static_cast<MeshHandle>(meshes.size());
+	meshes.push_back(Mesh{ .vertices = vertices, .indices = indices, .buildPolicy = vkut::raytracing::BuildPolicy::FAST_BUILD, .deformable = true });
+
+	LOG_TRIVIAL_FORMATTED("Added deformable mesh %u with %u triangles! ", handle, static_cast<uint32_t>(indices.size() / 3));
+	return handle;
+}
+
+Scene::MaterialHandle Scene::addMaterial(const Material &material)
+{
+	MaterialHandle handle = static_cast<MaterialHandle>(materials.size());
+	materials.push_back(material);
+	return handle;
+}
+
+Scene::InstanceHandle Scene::addInstance(
+	MeshHandle mesh,
+	const VkTransformMatrixKHR &transform,
+	uint32_t customIndex,
+	uint8_t mask,
+	uint32_t shaderBindingTableOffset,
+	VkGeometryInstanceFlagsKHR flags)
+{
+	assert(mesh < meshes.size());
+	assert(customIndex < (1U << 24U) && shaderBindingTableOffset < (1U << 24U));
+
+	InstanceHandle handle = static_cast<InstanceHandle>(instances.size());
+	instances.transforms.push_back(transform);
+	instances.customIndices.push_back(customIndex);
+	instances.masks.push_back(mask);
+	instances.shaderBindingTableOffsets.push_back(shaderBindingTableOffset);
+	instances.flags.push_back(flags);
+	instances.meshes.push_back(mesh);
+	return handle;
+}
+
+void Scene::setBuildPolicy(MeshHandle mesh, vkut::raytracing::BuildPolicy buildPolicy)
+{
+	assert(mesh < meshes.size() && !meshes[mesh].deformable);
+	meshes[mesh].buildPolicy = buildPolicy;
+}
+
+Scene::Mesh Scene::generateSphere(uint32_t rings, uint32_t segments, float radius)
+{
+	assert(rings >= 2 && segments >= 3);
+	constexpr float pi = 3.14159265358979f;
+
+	Mesh mesh = {};
+	mesh.vertices.reserve((rings + 1) * (segments + 1) * 3);
+	for (uint32_t ring = 0; ring <= rings; ring++)
+	{
+		float theta = pi * static_cast<float>(ring) / static_cast<float>(rings);
+		for (uint32_t segment = 0; segment <= segments; segment++)
+		{
+			float phi = 2.0f * pi * static_cast<float>(segment) / static_cast<float>(segments);
+			mesh.vertices.push_back(radius * std::sin(theta) * std::cos(phi));
+			mesh.vertices.push_back(radius * std::cos(theta));
+			mesh.vertices.push_back(radius * std::sin(theta) * std::sin(phi));
+		}
+	}
+
+	mesh.indices.reserve(rings * segments * 6);
+	for (uint32_t ring = 0; ring < rings; ring++)
+	{
+		for (uint32_t segment = 0; segment < segments; segment++)
+		{
+			uint32_t current = ring * (segments + 1) + segment;
+			uint32_t below = current + segments + 1;
+			mesh.indices.insert(mesh.indices.end(), { current, below, current + 1, current + 1, below, below + 1 });
+		}
+	}
+
+	return mesh;
+}
+
+void Scene::clear()
+{
+	meshes.clear();
+	meshLookup.clear();
+	instances = {};
+	materials.clear();
+}
+
+void Scene::reserveInstances(size_t count)
+{
+	instances.transforms.reserve(count);
+	instances.customIndices.reserve(count);
+	instances.masks.reserve(count);
+	instances.shaderBindingTableOffsets.reserve(count);
+	instances.flags.reserve(count);
+	instances.meshes.reserve(count);
+}
+
+void Scene::setTransform(InstanceHandle instance, const VkTransformMatrixKHR &transform)
+{
+	assert(instance < instances.size());
+	instances.transforms[instance] = transform;
+}
+
+void Scene::writeInstances(VkAccelerationStructureInstanceKHR *destination, const std::vector<uint64_t> &meshAddresses) const
+{
+	assert(meshAddresses.size() == meshes.size());
+
+	const size_t count = instances.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		VkAccelerationStructureInstanceKHR &instance = destination[i];
+		instance.transform = instances.transforms[i];
+		instance.instanceCustomIndex = instances.customIndices[i];
+		instance.mask = instances.masks[i];
+		instance.instanceShaderBindingTableRecordOffset = instances.shaderBindingTableOffsets[i];
+		instance.flags = instances.flags[i];
+		instance.accelerationStructureReference = meshAddresses[instances.meshes[i]];
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "vkutils.h"
+#include "glm.hpp"
+#include <vector>
+#include <unordered_map>
+
+//describes the meshes and instances of a scene independently of any acceleration structure
+//identical meshes are deduplicated so that they end up sharing one BLAS
+class Scene
+{
+public:
+
+	using MeshHandle = uint32_t;
+	using InstanceHandle = uint32_t;
+	using MaterialHandle = uint32_t;
+
+	//matches Material in raytrace.rchit and wavefront.glsl
+	struct Material
+	{
+		glm::vec4 albedo;
+	};
+
+	struct Mesh
+	{
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		vkut::raytracing::BuildPolicy buildPolicy;
+		//the BLAS of a deformable mesh is owned and updated by whoever deforms it
+		bool deformable;
+	};
+
+	//structure-of-arrays : every array holds one entry per instance
+	struct InstanceTable
+	{
+		std::vector<VkTransformMatrixKHR> transforms;
+		std::vector<uint32_t> customIndices;
+		std::vector<uint8_t> masks;
+		std::vector<uint32_t> shaderBindingTableOffsets;
+		std::vector<VkGeometryInstanceFlagsKHR> flags;
+		std::vector<MeshHandle> meshes;
+
+		size_t size() const { return meshes.size(); }
+	};
+
+	static constexpr VkTransformMatrixKHR identityTransform =
+	{
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f
+	};
+
+	//returns the handle of an already added mesh if its vertices, indices and build policy are identical
+	[[nodiscard]]
+	MeshHandle addMesh(const std::vector<float> &vertices, const std::vector<uint32_t> &indices, vkut::raytracing::BuildPolicy buildPolicy = vkut::raytracing::BuildPolicy::FAST_TRACE);
+	void setBuildPolicy(MeshHandle mesh, vkut::raytracing::BuildPolicy buildPolicy);
+
+	//deformable meshes are never deduplicated, vertices holds their rest pose
+	[[nodiscard]]
+	MeshHandle addDeformableMesh(const std::vector<float> &vertices, const std::vector<uint32_t> &indices);
+
+	//uv sphere centered on the origin
+	[[nodiscard]]
+	static Mesh generateSphere(uint32_t rings, uint32_t segments, float radius);
+
+	[[nodiscard]]
+	MaterialHandle addMaterial(const Material &material);
+
+	//customIndex is the material the hit shaders use for this instance
+	InstanceHandle addInstance(
+		MeshHandle mesh,
+		const VkTransformMatrixKHR &transform = identityTransform,
+		uint32_t customIndex = 0,
+		uint8_t mask = 0xFF,
+		uint32_t shaderBindingTableOffset = 0,
+		VkGeometryInstanceFlagsKHR flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR);
+
+	void reserveInstances(size_t count);
+	void clear();
+	void setTransform(InstanceHandle instance, const VkTransformMatrixKHR &transform);
+
+	//writes one VkAccelerationStructureInstanceKHR per instance into destination
+	//meshAddresses holds the BLAS device address of every mesh, indexed by MeshHandle
+	void writeInstances(VkAccelerationStructureInstanceKHR *destination, const std::vector<uint64_t> &meshAddresses) const;
+
+	const std::vector<Mesh> &getMeshes() const { return meshes; }
+	const InstanceTable &getInstances() const { return instances; }
+	const std::vector<Material> &getMaterials() const { return materials; }
+	uint32_t getMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+	uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+
+private:
+
+	std::vector<Mesh> meshes;
+	std::unordered_multimap<size_t, MeshHandle> meshLookup;
+	InstanceTable instances;
+	std::vector<Material> materials;
+};
@@ -0,0 +1,295 @@
+#include "Skinning.h"
+#include <assert.h>
+#include <algorithm>
+#include "Logger/Logger.h"
+#include <cstring>
+#include <limits>
+
+namespace {
+
+	//matches the push constant block in skinning.comp
+	struct PushConstants
+	{
+		uint32_t vertexCount;
+		uint32_t morphTargetCount;
+	};
+
+	constexpr uint32_t morphWeightVectors = skinning::maxMorphTargets / 4;
+
+	VkDeviceSize getPoseBufferSize(uint32_t jointCount)
+	{
+		return sizeof(glm::vec4) * morphWeightVectors + sizeof(glm::mat4) * jointCount;
+	}
+
+	void writePose(const vkut::PersistentBuffer &poseBuffer, size_t frame, const std::vector<glm::mat4> &jointMatrices, const std::vector<float> &morphWeights)
+	{
+		glm::vec4 weights[morphWeightVectors] = {};
+		for (size_t i = 0; i < morphWeights.size(); i++)
+		{
+			weights[i / 4][static_cast<glm::length_t>(i % 4)] = morphWeights[i];
+		}
+
+		const uint32_t region = static_cast<uint32_t>(frame);
+		uint8_t *destination = reinterpret_cast<uint8_t *>(vkut::common::getRegionPointer(poseBuffer, region));
+		memcpy(destination, weights, sizeof(weights));
+		memcpy(destination + sizeof(weights), jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
+		vkut::common::flushRegion(poseBuffer, region, 0, poseBuffer.regionSize);
+	}
+
+	//upper bound of how far any vertex within radius of the origin moved between two poses
+	float getMaxDisplacement(const skinning::SkinnedMesh &mesh, const std::vector<glm::mat4> &jointMatrices, const std::vector<float> &morphWeights)
+	{
+		float maxJointDisplacement = .0f;
+		for (size_t i = 0; i < jointMatrices.size(); i++)
+		{
+			glm::mat4 difference = jointMatrices[i] - mesh.rebuildJoints[i];
+			float displacement = glm::length(glm::vec3(difference[3]))
+				+ mesh.radius * (glm::length(glm::vec3(difference[0])) + glm::length(glm::vec3(difference[1])) + glm::length(glm::vec3(difference[2])));
+			maxJointDisplacement = std::max(maxJointDisplacement, displacement);
+		}
+
+		float morphDisplacement = .0f;
+		for (size_t i = 0; i < morphWeights.size(); i++)
+		{
+			morphDisplacement += std::abs(morphWeights[i] - mesh.rebuildMorphWeights[i]) * mesh.maxMorphDelta;
+		}
+
+		return maxJointDisplacement + morphDisplacement;
+	}
+
+	void recordSkinningDispatch(VkCommandBuffer commandBuffer, const skinning::Pipeline &pipeline, const skinning::SkinnedMesh &mesh, size_t frame)
+	{
+		PushConstants pushConstants
+		{
+			.vertexCount = mesh.vertexCount,
+			.morphTargetCount = mesh.morphTargetCount
+		};
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &mesh.descriptorSets[frame], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer, (mesh.vertexCount + skinning::workgroupSize - 1) / skinning::workgroupSize, 1, 1);
+	}
+
+	//makes the deformed vertices visible to the acceleration structure build
+	void recordDeformedVerticesBarrier(VkCommandBuffer commandBuffer)
+	{
+		VkMemoryBarrier barrier
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR,
+		};
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr);
+	}
+}
+
+namespace skinning {
+
+	Pipeline createPipeline()
+	{
+		Pipeline pipeline = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(4);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipeline.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipeline.layout = vkut::common::createPipelineLayout({ pipeline.descriptorSetLayout }, { pushConstantRange });
+
+		VkShaderModule shaderModule = vkut::common::createShaderModule("../Assets/shaders/skinning.comp.spv");
+		pipeline.pipeline = vkut::common::createComputePipeline(pipeline.layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+
+		return pipeline;
+	}
+
+	void destroyPipeline(Pipeline pipeline)
+	{
+		vkut::common::destroyPipeline(pipeline.pipeline);
+		vkut::common::destroyPipelineLayout(pipeline.layout);
+		vkut::common::destroyDescriptorSetLayout(pipeline.descriptorSetLayout);
+	}
+
+	SkinnedMesh createSkinnedMesh(VkCommandPool commandPool, const Pipeline &pipeline, const MeshDescription &description, size_t framesInFlight)
+	{
+		assert(description.morphTargets.size() <= maxMorphTargets);
+		assert(description.jointCount > 0);
+
+		SkinnedMesh mesh
+		{
+			.vertexCount = static_cast<uint32_t>(description.vertices.size()),
+			.morphTargetCount = static_cast<uint32_t>(description.morphTargets.size()),
+			.jointCount = description.jointCount,
+			.radius = .0f,
+			.maxMorphDelta = .0f,
+		};
+
+		for (const Vertex &vertex : description.vertices)
+		{
+			mesh.radius = std::max(mesh.radius, glm::length(glm::vec3(vertex.position)));
+		}
+		mesh.radius = std::max(mesh.radius, std::numeric_limits<float>::epsilon());
+
+		//the rest pose and morph targets never change, only the pose buffers are rewritten by the host
+		mesh.restVertices = vkut::common::createDeviceLocalBuffer(commandPool, sizeof(Vertex) * mesh.vertexCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			[&](void *dstData) { memcpy(dstData, description.vertices.data(), sizeof(Vertex) * mesh.vertexCount); });
+
+		//the shader always binds a morph buffer, even for meshes without targets
+		std::vector<glm::vec4> morphDeltas = std::vector<glm::vec4>(std::max(1U, mesh.morphTargetCount * mesh.vertexCount), glm::vec4(.0f));
+		for (size_t target = 0; target < description.morphTargets.size(); target++)
+		{
+			assert(description.morphTargets[target].size() == mesh.vertexCount);
+			for (size_t vertex = 0; vertex < mesh.vertexCount; vertex++)
+			{
+				const glm::vec4 &delta = description.morphTargets[target][vertex];
+				morphDeltas[target * mesh.vertexCount + vertex] = delta;
+				mesh.maxMorphDelta = std::max(mesh.maxMorphDelta, glm::length(glm::vec3(delta)));
+			}
+		}
+		mesh.morphDeltas = vkut::common::createDeviceLocalBuffer(commandPool, sizeof(glm::vec4) * morphDeltas.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			[&](void *dstData) { memcpy(dstData, morphDeltas.data(), sizeof(glm::vec4) * morphDeltas.size()); });
+
+		VkMemoryAllocateFlagsInfo memAllocFlagsInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+			.pNext = nullptr,
+			.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
+			.deviceMask = 0
+		};
+		mesh.deformedVertices = vkut::common::createBuffer(
+			sizeof(float) * 3 * mesh.vertexCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | vkut::raytracing::buildInputUsage,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			memAllocFlagsInfo);
+
+		mesh.poseBuffer = vkut::common::createPersistentBuffer(getPoseBufferSize(mesh.jointCount), static_cast<uint32_t>(framesInFlight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+		const uint32_t setCount = static_cast<uint32_t>(framesInFlight);
+		mesh.descriptorPool = vkut::common::createDescriptorPool({ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }, setCount * 4U, setCount);
+		mesh.descriptorSets.resize(framesInFlight);
+		for (size_t i = 0; i < framesInFlight; i++)
+		{
+			const uint32_t region = static_cast<uint32_t>(i);
+			VkDescriptorBufferInfo bufferInfos[4] =
+			{
+				{ .buffer = mesh.restVertices.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+				{ .buffer = mesh.morphDeltas.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+				{ .buffer = mesh.poseBuffer.buffer.buffer, .offset = vkut::common::getRegionOffset(mesh.poseBuffer, region), .range = mesh.poseBuffer.regionSize },
+				{ .buffer = mesh.deformedVertices.buffer, .offset = 0, .range = VK_WHOLE_SIZE },
+			};
+
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(4);
+			for (uint32_t binding = 0; binding < 4; binding++)
+			{
+				descriptorSetInfos[binding] = vkut::DescriptorSetInfo
+				{
+					.pNext = nullptr,
+					.dstBinding = binding,
+					.dstArrayElement = 0,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+					.pImageInfo = nullptr,
+					.pBufferInfo = &bufferInfos[binding],
+					.pTexelBufferView = nullptr
+				};
+			}
+
+			mesh.descriptorSets[i] = vkut::common::createDescriptorSet(pipeline.descriptorSetLayout, mesh.descriptorPool, descriptorSetInfos);
+		}
+
+		//rest pose, used for the initial build
+		mesh.rebuildJoints = std::vector<glm::mat4>(mesh.jointCount, glm::mat4(1.0f));
+		mesh.rebuildMorphWeights = std::vector<float>(mesh.morphTargetCount, .0f);
+		writePose(mesh.poseBuffer, 0, mesh.rebuildJoints, mesh.rebuildMorphWeights);
+
+		VkCommandBuffer commandBuffer = vkut::common::beginSingleTimeCommands(commandPool);
+		recordSkinningDispatch(commandBuffer, pipeline, mesh, 0);
+		recordDeformedVerticesBarrier(commandBuffer);
+		vkut::common::endSingleTimeCommands(commandPool, commandBuffer);
+
+		mesh.blas = vkut::raytracing::createBLAS(commandPool, mesh.deformedVertices, mesh.vertexCount, description.indices, vkut::raytracing::BuildPolicy::FAST_BUILD);
+
+		Logger::logMessageFormatted("Created skinned mesh with %u vertices, %u joints and %u morph targets! ", mesh.vertexCount, mesh.jointCount, mesh.morphTargetCount);
+
+		return mesh;
+	}
+
+	void destroySkinnedMesh(SkinnedMesh mesh)
+	{
+		vkut::raytracing::destroyBottomLevelAccelerationStructure(mesh.blas);
+		vkut::common::destroyDescriptorPool(mesh.descriptorPool);
+		vkut::common::destroyPersistentBuffer(mesh.poseBuffer);
+		vkut::common::destroyBuffer(mesh.deformedVertices);
+		vkut::common::destroyBuffer(mesh.morphDeltas);
+		vkut::common::destroyBuffer(mesh.restVertices);
+	}
+
+	bool setPose(SkinnedMesh &mesh, size_t frame, const std::vector<glm::mat4> &jointMatrices, const std::vector<float> &morphWeights)
+	{
+		assert(jointMatrices.size() == mesh.jointCount);
+		assert(morphWeights.size() == mesh.morphTargetCount);
+
+		writePose(mesh.poseBuffer, frame, jointMatrices, morphWeights);
+
+		float displacementRatio = getMaxDisplacement(mesh, jointMatrices, morphWeights) / mesh.radius;
+		bool rebuild = displacementRatio > mesh.refitSettings.maxDisplacementRatio
+			|| mesh.refitsSinceRebuild >= mesh.refitSettings.maxRefits;
+
+		if (rebuild)
+		{
+			mesh.rebuildJoints = jointMatrices;
+			mesh.rebuildMorphWeights = morphWeights;
+			mesh.refitsSinceRebuild = 0;
+			mesh.rebuildCount++;
+		}
+		else
+		{
+			mesh.refitsSinceRebuild++;
+		}
+
+		return rebuild;
+	}
+
+	void recordDeformation(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const SkinnedMesh &mesh, size_t frame, bool rebuild)
+	{
+		//previous frames may still be tracing against the BLAS or building from the deformed vertices
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			0,
+			0, nullptr,
+			0, nullptr,
+			0, nullptr);
+
+		recordSkinningDispatch(commandBuffer, pipeline, mesh, frame);
+		recordDeformedVerticesBarrier(commandBuffer);
+
+		vkut::raytracing::recordBLASUpdate(commandBuffer, mesh.blas, rebuild);
+		vkut::raytracing::recordAccelerationStructureBarrier(commandBuffer);
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "vkutils.h"
+#include "glm.hpp"
+#include <vector>
+
+//compute skinning and morphing of meshes whose BLAS is refit every frame without any host round trip
+namespace skinning {
+
+	constexpr uint32_t maxMorphTargets = 16;
+	constexpr uint32_t workgroupSize = 64;
+
+	//matches RestVertex in skinning.comp
+	struct Vertex
+	{
+		glm::vec4 position;
+		glm::uvec4 joints;
+		glm::vec4 weights;
+	};
+
+	struct MeshDescription
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		//one position delta per vertex for every target
+		std::vector<std::vector<glm::vec4>> morphTargets;
+		uint32_t jointCount;
+	};
+
+	struct Pipeline
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+	};
+
+	//a refit keeps the topology of the BVH, so its quality degrades as the pose drifts away from the last full rebuild
+	struct RefitSettings
+	{
+		//largest vertex displacement since the last rebuild, relative to the mesh radius
+		float maxDisplacementRatio = .25f;
+		uint32_t maxRefits = 120;
+	};
+
+	struct SkinnedMesh
+	{
+		vkut::Buffer restVertices;
+		vkut::Buffer morphDeltas;
+		//packed float3 positions written by the compute pass, read by the BLAS build
+		vkut::Buffer deformedVertices;
+		//morph weights followed by the joint matrices, one region per frame in flight
+		vkut::PersistentBuffer poseBuffer;
+		VkDescriptorPool descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+		vkut::raytracing::BottomLevelAccelerationStructure blas;
+
+		uint32_t vertexCount;
+		uint32_t morphTargetCount;
+		uint32_t jointCount;
+		float radius;
+		float maxMorphDelta;
+
+		RefitSettings refitSettings;
+		std::vector<glm::mat4> rebuildJoints;
+		std::vector<float> rebuildMorphWeights;
+		uint32_t refitsSinceRebuild;
+		uint32_t rebuildCount;
+	};
+
+	[[nodiscard]]
+	Pipeline createPipeline();
+	void destroyPipeline(Pipeline pipeline);
+
+	//deforms the mesh into its rest pose once and builds its BLAS from the result
+	[[nodiscard]]
+	SkinnedMesh createSkinnedMesh(VkCommandPool commandPool, const Pipeline &pipeline, const MeshDescription &description, size_t framesInFlight);
+	void destroySkinnedMesh(SkinnedMesh mesh);
+
+	//uploads the pose for the given frame in flight, returns true when the BLAS has to be rebuilt instead of refit
+	bool setPose(SkinnedMesh &mesh, size_t frame, const std::vector<glm::mat4> &jointMatrices, const std::vector<float> &morphWeights);
+
+	//deforms the vertices and updates the BLAS, the TLAS referencing it still has to be refit afterwards
+	void recordDeformation(VkCommandBuffer commandBuffer, const Pipeline &pipeline, const SkinnedMesh &mesh, size_t frame, bool rebuild);
+}
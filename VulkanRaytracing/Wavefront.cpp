@@ -0,0 +1,368 @@
+#include "Wavefront.h"
+#include <assert.h>
+#include "Logger/Logger.h"
+#include "glm.hpp"
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+	//matches the push constant block in wavefront.glsl
+	struct PushConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t capacity;
+		uint32_t seed;
+		uint32_t bounces;
+		uint32_t depth;
+		uint32_t sorted;
+	};
+
+	//match the structs in wavefront.glsl
+	struct Ray
+	{
+		glm::vec3 origin;
+		uint32_t pixel;
+		glm::vec3 direction;
+		uint32_t depth;
+		glm::vec3 throughput;
+		uint32_t padding;
+	};
+	static_assert(sizeof(Ray) == 48);
+
+	struct Hit
+	{
+		glm::vec3 normal;
+		float distance;
+		uint32_t material;
+		uint32_t key;
+		uint32_t padding[2];
+	};
+	static_assert(sizeof(Hit) == 32);
+
+	struct Queue
+	{
+		uint32_t groupCountX;
+		uint32_t groupCountY;
+		uint32_t groupCountZ;
+		uint32_t count;
+	};
+
+	constexpr uint32_t bucketCount = 256;
+
+	//in binding order
+	const VkDescriptorType descriptorTypes[] =
+	{
+		VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+		//materials and geometries
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		//rays, hits, order, queues, buckets and stats
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+	};
+	constexpr uint32_t bindingCount = static_cast<uint32_t>(std::size(descriptorTypes));
+	constexpr uint32_t outputBinding = 4;
+	constexpr uint32_t statsBinding = 10;
+
+	VkPipeline createKernel(VkPipelineLayout layout, const char *shaderPath)
+	{
+		VkShaderModule shaderModule = vkut::common::createShaderModule(shaderPath);
+		VkPipeline pipeline = vkut::common::createComputePipeline(layout, shaderModule);
+		vkut::common::destroyShaderModule(shaderModule);
+		return pipeline;
+	}
+
+	vkut::DescriptorSetInfo getBufferSetInfo(uint32_t binding, const VkDescriptorBufferInfo *bufferInfo)
+	{
+		return vkut::DescriptorSetInfo
+		{
+			.pNext = nullptr,
+			.dstBinding = binding,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = descriptorTypes[binding],
+			.pImageInfo = nullptr,
+			.pBufferInfo = bufferInfo,
+			.pTexelBufferView = nullptr
+		};
+	}
+
+	void recordKernel(VkCommandBuffer commandBuffer, const wavefront::Pipelines &pipelines, VkPipeline kernel, const PushConstants &pushConstants)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel);
+		vkCmdPushConstants(commandBuffer, pipelines.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+	}
+}
+
+namespace wavefront {
+
+	Pipelines createPipelines()
+	{
+		Pipelines pipelines = {};
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings = std::vector<VkDescriptorSetLayoutBinding>(bindingCount);
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding
+			{
+				.binding = i,
+				.descriptorType = descriptorTypes[i],
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.pImmutableSamplers = nullptr,
+			};
+		}
+		pipelines.descriptorSetLayout = vkut::common::createDescriptorSetLayout(bindings);
+
+		VkPushConstantRange pushConstantRange
+		{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(PushConstants)
+		};
+		pipelines.layout = vkut::common::createPipelineLayout({ pipelines.descriptorSetLayout }, { pushConstantRange });
+
+		pipelines.generate = createKernel(pipelines.layout, "../Assets/shaders/wavefrontGenerate.comp.spv");
+		pipelines.intersect = createKernel(pipelines.layout, "../Assets/shaders/wavefrontIntersect.comp.spv");
+		pipelines.prepare = createKernel(pipelines.layout, "../Assets/shaders/wavefrontPrepare.comp.spv");
+		pipelines.scatter = createKernel(pipelines.layout, "../Assets/shaders/wavefrontScatter.comp.spv");
+		pipelines.shade = createKernel(pipelines.layout, "../Assets/shaders/wavefrontShade.comp.spv");
+
+		return pipelines;
+	}
+
+	void destroyPipelines(Pipelines pipelines)
+	{
+		vkut::common::destroyPipeline(pipelines.shade);
+		vkut::common::destroyPipeline(pipelines.scatter);
+		vkut::common::destroyPipeline(pipelines.prepare);
+		vkut::common::destroyPipeline(pipelines.intersect);
+		vkut::common::destroyPipeline(pipelines.generate);
+		vkut::common::destroyPipelineLayout(pipelines.layout);
+		vkut::common::destroyDescriptorSetLayout(pipelines.descriptorSetLayout);
+	}
+
+	Targets createTargets(VkCommandPool commandPool, VkExtent2D extent, size_t framesInFlight)
+	{
+		const uint32_t capacity = extent.width * extent.height;
+		auto createBuffer = [](VkDeviceSize size, VkBufferUsageFlags usage)
+		{
+			return vkut::common::createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		};
+
+		Targets targets
+		{
+			.capacity = capacity,
+			.rays = createBuffer(2U * capacity * sizeof(Ray), 0),
+			.hits = createBuffer(capacity * sizeof(Hit), 0),
+			.order = createBuffer(capacity * sizeof(uint32_t), 0),
+			.queues = createBuffer(2U * sizeof(Queue), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT),
+			//the bucket counts have to start out zero, the prepare kernel zeroes them again after every bounce
+			.buckets = vkut::common::createDeviceLocalBuffer(commandPool, 2U * bucketCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				[](void *destination) { memset(destination, 0, 2U * bucketCount * sizeof(uint32_t)); }),
+			.statsBuffer = vkut::common::createPersistentBuffer(sizeof(Stats), static_cast<uint32_t>(framesInFlight), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+			.descriptorPool = VK_NULL_HANDLE,
+			.descriptorSets = std::vector<VkDescriptorSet>(framesInFlight)
+		};
+
+		Logger::logMessageFormatted("Created wavefront queues of %u rays! ", capacity);
+
+		return targets;
+	}
+
+	void destroyTargets(Targets targets)
+	{
+		if (targets.descriptorPool != VK_NULL_HANDLE)
+		{
+			vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		}
+		vkut::common::destroyPersistentBuffer(targets.statsBuffer);
+		vkut::common::destroyBuffer(targets.buckets);
+		vkut::common::destroyBuffer(targets.queues);
+		vkut::common::destroyBuffer(targets.order);
+		vkut::common::destroyBuffer(targets.hits);
+		vkut::common::destroyBuffer(targets.rays);
+	}
+
+	void createDescriptorSets(Targets &targets, const Pipelines &pipelines, const Resources &resources)
+	{
+		if (targets.descriptorPool != VK_NULL_HANDLE)
+		{
+			vkut::common::destroyDescriptorPool(targets.descriptorPool);
+		}
+
+		const uint32_t setCount = static_cast<uint32_t>(targets.descriptorSets.size());
+		targets.descriptorPool = vkut::common::createDescriptorPool(std::vector<VkDescriptorType>(std::begin(descriptorTypes), std::end(descriptorTypes)), setCount, setCount);
+
+		VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
+			.pNext = nullptr,
+			.accelerationStructureCount = 1,
+			.pAccelerationStructures = &resources.topLevelAS
+		};
+
+		VkDescriptorImageInfo outputInfo
+		{
+			.sampler = VK_NULL_HANDLE,
+			.imageView = resources.output,
+			.imageLayout = VK_IMAGE_LAYOUT_GENERAL
+		};
+
+		//in binding order from the camera on, the stats region is filled in per set
+		VkDescriptorBufferInfo bufferInfos[bindingCount] = {};
+		bufferInfos[1] = { .buffer = resources.camera->buffer.buffer, .offset = 0, .range = resources.camera->regionSize };
+		bufferInfos[2] = { .buffer = resources.materials, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[3] = { .buffer = resources.geometries, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[5] = { .buffer = targets.rays.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[6] = { .buffer = targets.hits.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[7] = { .buffer = targets.order.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[8] = { .buffer = targets.queues.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+		bufferInfos[9] = { .buffer = targets.buckets.buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+
+		for (uint32_t i = 0; i < setCount; i++)
+		{
+			bufferInfos[statsBinding] =
+			{
+				.buffer = targets.statsBuffer.buffer.buffer,
+				.offset = vkut::common::getRegionOffset(targets.statsBuffer, i),
+				.range = targets.statsBuffer.regionSize
+			};
+
+			std::vector<vkut::DescriptorSetInfo> descriptorSetInfos = std::vector<vkut::DescriptorSetInfo>(bindingCount);
+			descriptorSetInfos[0] = vkut::DescriptorSetInfo
+			{
+				.pNext = &accelerationStructureInfo,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+				.pImageInfo = nullptr,
+				.pBufferInfo = nullptr,
+				.pTexelBufferView = nullptr
+			};
+			for (uint32_t binding = 1; binding < bindingCount; binding++)
+			{
+				if (binding == outputBinding) continue;
+				descriptorSetInfos[binding] = getBufferSetInfo(binding, &bufferInfos[binding]);
+			}
+			descriptorSetInfos[outputBinding] = vkut::DescriptorSetInfo
+			{
+				.pNext = nullptr,
+				.dstBinding = outputBinding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+				.pImageInfo = &outputInfo,
+				.pBufferInfo = nullptr,
+				.pTexelBufferView = nullptr
+			};
+
+			targets.descriptorSets[i] = vkut::common::createDescriptorSet(pipelines.descriptorSetLayout, targets.descriptorPool, descriptorSetInfos);
+		}
+	}
+
+	void recordPaths(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		uint32_t cameraOffset, VkExtent2D extent, uint32_t seed, uint32_t bounces, const Settings &settings)
+	{
+		assert(bounces <= maxBounces);
+		assert(extent.width * extent.height <= targets.capacity);
+
+		const Stats zero = {};
+		vkut::common::writeRegion(targets.statsBuffer, static_cast<uint32_t>(frame), &zero, sizeof(Stats));
+
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+		vkut::common::resetTimestamps(commandBuffer, timestamps, firstTimestamp, timestampsPerFrame);
+
+		//the previous frame may still be reading the queues and the output
+		vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.layout, 0, 1, &targets.descriptorSets[frame], 1, &cameraOffset);
+
+		PushConstants pushConstants
+		{
+			.width = extent.width,
+			.height = extent.height,
+			.capacity = targets.capacity,
+			.seed = seed,
+			.bounces = bounces,
+			.depth = 0,
+			.sorted = settings.sortRays ? 1U : 0U
+		};
+		recordKernel(commandBuffer, pipelines, pipelines.generate, pushConstants);
+		vkCmdDispatch(commandBuffer, (extent.width + workgroupSize - 1) / workgroupSize, (extent.height + workgroupSize - 1) / workgroupSize, 1);
+		vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		vkut::common::writeTimestamp(commandBuffer, timestamps, firstTimestamp + 1U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		//the rays still going after the last bounce end in the sky, so the last queue is only shaded
+		for (uint32_t depth = 0; depth <= bounces; depth++)
+		{
+			pushConstants.depth = depth;
+			const VkDeviceSize queueOffset = (depth % 2U) * sizeof(Queue);
+			const uint32_t bounceTimestamp = firstTimestamp + 2U + depth * 3U;
+
+			recordKernel(commandBuffer, pipelines, pipelines.intersect, pushConstants);
+			vkCmdDispatchIndirect(commandBuffer, targets.queues.buffer, queueOffset);
+			vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			vkut::common::writeTimestamp(commandBuffer, timestamps, bounceTimestamp, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+			//the prepare kernel also resets the other queue, so it runs without the sort too and is timed with it
+			recordKernel(commandBuffer, pipelines, pipelines.prepare, pushConstants);
+			vkCmdDispatch(commandBuffer, 1, 1, 1);
+			vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			if (settings.sortRays)
+			{
+				recordKernel(commandBuffer, pipelines, pipelines.scatter, pushConstants);
+				vkCmdDispatchIndirect(commandBuffer, targets.queues.buffer, queueOffset);
+				vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			}
+			vkut::common::writeTimestamp(commandBuffer, timestamps, bounceTimestamp + 1U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+			recordKernel(commandBuffer, pipelines, pipelines.shade, pushConstants);
+			vkCmdDispatchIndirect(commandBuffer, targets.queues.buffer, queueOffset);
+			vkut::common::recordIndirectBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			vkut::common::writeTimestamp(commandBuffer, timestamps, bounceTimestamp + 2U, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		}
+	}
+
+	Stats getStats(const Targets &targets, size_t frame)
+	{
+		const uint32_t region = static_cast<uint32_t>(frame);
+		vkut::common::invalidateRegion(targets.statsBuffer, region, 0, sizeof(Stats));
+
+		Stats stats = {};
+		memcpy(&stats, vkut::common::getRegionPointer(targets.statsBuffer, region), sizeof(Stats));
+		return stats;
+	}
+
+	StageMilliseconds getStageMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame, uint32_t bounces)
+	{
+		const uint32_t firstTimestamp = static_cast<uint32_t>(frame) * timestampsPerFrame;
+
+		StageMilliseconds milliseconds
+		{
+			.generate = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp, firstTimestamp + 1U),
+			.intersect = .0,
+			.sort = .0,
+			.shade = .0,
+			.total = vkut::common::getElapsedMilliseconds(timestamps, firstTimestamp, firstTimestamp + 4U + bounces * 3U)
+		};
+		for (uint32_t depth = 0; depth <= bounces; depth++)
+		{
+			const uint32_t bounceTimestamp = firstTimestamp + 2U + depth * 3U;
+			milliseconds.intersect += vkut::common::getElapsedMilliseconds(timestamps, bounceTimestamp - 1U, bounceTimestamp);
+			milliseconds.sort += vkut::common::getElapsedMilliseconds(timestamps, bounceTimestamp, bounceTimestamp + 1U);
+			milliseconds.shade += vkut::common::getElapsedMilliseconds(timestamps, bounceTimestamp + 1U, bounceTimestamp + 2U);
+		}
+		return milliseconds;
+	}
+}
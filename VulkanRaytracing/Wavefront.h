@@ -0,0 +1,99 @@
+#pragma once
+#include "vkutils.h"
+#include <vector>
+
+//path tracing split into one compute dispatch per stage and bounce instead of one ray tracing pipeline running every path to its end
+//wavefrontGenerate.comp writes a queue of camera rays, then every bounce wavefrontIntersect.comp traces the queue with ray queries,
+//wavefrontPrepare.comp and wavefrontScatter.comp sort the hits by material and direction and wavefrontShade.comp shades them in that order,
+//compacting the rays that go on into the other queue, which the next bounce dispatches indirectly
+namespace wavefront {
+
+	constexpr uint32_t workgroupSize = 8;
+	//matches maxBounces in wavefront.glsl
+	constexpr uint32_t maxBounces = 4;
+	//before and after the generate kernel, then after the intersect, sort and shade stage of every bounce
+	constexpr uint32_t timestampsPerFrame = 2U + 3U * (maxBounces + 1U);
+
+	struct Settings
+	{
+		//otherwise the rays are shaded in the order the previous bounce appended them
+		bool sortRays = true;
+	};
+
+	//every kernel uses the same descriptor set and pipeline layout
+	struct Pipelines
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		VkPipelineLayout layout;
+		VkPipeline generate;
+		VkPipeline intersect;
+		VkPipeline prepare;
+		VkPipeline scatter;
+		VkPipeline shade;
+	};
+
+	//matches the Stats block in wavefront.glsl
+	struct Stats
+	{
+		uint32_t rays[maxBounces + 1];
+	};
+
+	//what the kernels read from the renderer, the descriptor sets have to be recreated whenever one of them is
+	struct Resources
+	{
+		VkAccelerationStructureKHR topLevelAS;
+		const vkut::PersistentBuffer *camera;
+		VkBuffer materials;
+		VkBuffer geometries;
+		//the trace image the paths add their radiance to
+		VkImageView output;
+	};
+
+	struct Targets
+	{
+		//rays per queue, one for every pixel of the extent
+		uint32_t capacity;
+		//both queues one after the other
+		vkut::Buffer rays;
+		vkut::Buffer hits;
+		vkut::Buffer order;
+		//the count and indirect dispatch arguments of both queues
+		vkut::Buffer queues;
+		vkut::Buffer buckets;
+		//one region per frame in flight, zeroed when the frame is recorded
+		vkut::PersistentBuffer statsBuffer;
+		VkDescriptorPool descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+	};
+
+	struct StageMilliseconds
+	{
+		double generate;
+		double intersect;
+		double sort;
+		double shade;
+		double total;
+	};
+
+	[[nodiscard]]
+	Pipelines createPipelines();
+	void destroyPipelines(Pipelines pipelines);
+
+	//the descriptor sets are left to createDescriptorSets
+	[[nodiscard]]
+	Targets createTargets(VkCommandPool commandPool, VkExtent2D extent, size_t framesInFlight);
+	void destroyTargets(Targets targets);
+
+	//one set per frame in flight, replaces the previous ones, which stay valid until the frames in flight completed
+	void createDescriptorSets(Targets &targets, const Pipelines &pipelines, const Resources &resources);
+
+	//traces one path with up to bounces diffuse bounces through every pixel of the top left extent of the output
+	//the camera region of the frame in flight is selected through the dynamic offset, seed picks the jitter and the random directions like the sample index of raytrace.rgen
+	//the TLAS has to be behind a barrier to the compute stage, whatever reads the output behind another one
+	void recordPaths(VkCommandBuffer commandBuffer, const Pipelines &pipelines, const Targets &targets, const vkut::TimestampQueries &timestamps, size_t frame,
+		uint32_t cameraOffset, VkExtent2D extent, uint32_t seed, uint32_t bounces, const Settings &settings);
+
+	//the frame has to be completed
+	Stats getStats(const Targets &targets, size_t frame);
+	StageMilliseconds getStageMilliseconds(const vkut::TimestampQueries &timestamps, size_t frame, uint32_t bounces);
+}
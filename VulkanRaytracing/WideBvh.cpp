@@ -0,0 +1,232 @@
+#include "WideBvh.h"
+#include <assert.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace bvh
+{
+	namespace {
+
+		void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+		{
+#ifdef _MSC_VER
+			int values[4];
+			__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (size_t i = 0; i < 4; i++)
+			{
+				registers[i] = static_cast<uint32_t>(values[i]);
+			}
+#else
+			__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+		}
+
+		//register state the OS saves on context switches
+		uint64_t getEnabledStateMask()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			uint32_t low, high;
+			__asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+		}
+
+		SimdLevel detectSimdLevel()
+		{
+			uint32_t registers[4];
+			cpuid(0, 0, registers);
+			const uint32_t maxLeaf = registers[0];
+
+			cpuid(1, 0, registers);
+			const bool sse2 = (registers[3] & (1U << 26)) != 0;
+			const bool fma = (registers[2] & (1U << 12)) != 0;
+			const bool osxsave = (registers[2] & (1U << 27)) != 0;
+			const bool avx = (registers[2] & (1U << 28)) != 0;
+			if (!sse2) return SimdLevel::SCALAR;
+
+			const uint64_t stateMask = osxsave ? getEnabledStateMask() : 0;
+			//xmm and ymm, then opmask and both zmm halves
+			const bool avxState = (stateMask & 0x6) == 0x6;
+			const bool avx512State = (stateMask & 0xE6) == 0xE6;
+			if (!avx || !fma || !avxState || maxLeaf < 7) return SimdLevel::SSE;
+
+			cpuid(7, 0, registers);
+			const bool avx2 = (registers[1] & (1U << 5)) != 0;
+			const bool avx512f = (registers[1] & (1U << 16)) != 0;
+			const bool avx512vl = (registers[1] & (1U << 31)) != 0;
+			if (!avx2) return SimdLevel::SSE;
+			if (!avx512f || !avx512vl || !avx512State) return SimdLevel::AVX2;
+			return SimdLevel::AVX512;
+		}
+
+		template<uint32_t Width>
+		void writeBlocks(const Hierarchy &hierarchy, const Node &leaf, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, WideHierarchy<Width> &wide)
+		{
+			for (uint32_t first = 0; first < leaf.primitiveCount; first += Width)
+			{
+				TriangleBlock<Width> block = {};
+				for (uint32_t lane = 0; lane < Width; lane++)
+				{
+					if (first + lane >= leaf.primitiveCount)
+					{
+						block.primitives[lane] = std::numeric_limits<uint32_t>::max();
+						continue;
+					}
+
+					const uint32_t primitive = hierarchy.primitives[leaf.offset + first + lane];
+					const glm::vec3 &v0 = positions[indices[primitive * 3]];
+					const glm::vec3 edge1 = positions[indices[primitive * 3 + 1]] - v0;
+					const glm::vec3 edge2 = positions[indices[primitive * 3 + 2]] - v0;
+					for (glm::length_t axis = 0; axis < 3; axis++)
+					{
+						block.v0[axis][lane] = v0[axis];
+						block.edge1[axis][lane] = edge1[axis];
+						block.edge2[axis][lane] = edge2[axis];
+					}
+					block.primitives[lane] = primitive;
+				}
+				wide.blocks.push_back(block);
+			}
+		}
+
+		//pulls up grandchildren, opening the largest interior child first, until the node is full
+		template<uint32_t Width>
+		uint32_t collapseNode(const Hierarchy &hierarchy, uint32_t binaryIndex, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, WideHierarchy<Width> &wide)
+		{
+			uint32_t children[Width];
+			uint32_t childCount = 0;
+			const Node &node = hierarchy.nodes[binaryIndex];
+			if (node.isLeaf())
+			{
+				children[childCount++] = binaryIndex;
+			}
+			else
+			{
+				children[childCount++] = binaryIndex + 1;
+				children[childCount++] = node.offset;
+			}
+
+			while (childCount < Width)
+			{
+				uint32_t largest = Width;
+				float largestArea = -1.0f;
+				for (uint32_t i = 0; i < childCount; i++)
+				{
+					const Node &child = hierarchy.nodes[children[i]];
+					if (child.isLeaf()) continue;
+
+					glm::vec3 extent = child.boundsMax - child.boundsMin;
+					float area = extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+					if (area > largestArea)
+					{
+						largest = i;
+						largestArea = area;
+					}
+				}
+				if (largest == Width) break;
+
+				const uint32_t opened = children[largest];
+				children[largest] = opened + 1;
+				children[childCount++] = hierarchy.nodes[opened].offset;
+			}
+
+			const uint32_t wideIndex = static_cast<uint32_t>(wide.nodes.size());
+			wide.nodes.emplace_back();
+			for (uint32_t slot = 0; slot < Width; slot++)
+			{
+				for (size_t axis = 0; axis < 3; axis++)
+				{
+					wide.nodes[wideIndex].bounds[axis][0][slot] = std::numeric_limits<float>::infinity();
+					wide.nodes[wideIndex].bounds[axis][1][slot] = -std::numeric_limits<float>::infinity();
+				}
+			}
+
+			for (uint32_t slot = 0; slot < childCount; slot++)
+			{
+				const Node &child = hierarchy.nodes[children[slot]];
+				for (glm::length_t axis = 0; axis < 3; axis++)
+				{
+					wide.nodes[wideIndex].bounds[axis][0][slot] = child.boundsMin[axis];
+					wide.nodes[wideIndex].bounds[axis][1][slot] = child.boundsMax[axis];
+				}
+
+				if (child.isLeaf())
+				{
+					const uint32_t firstBlock = static_cast<uint32_t>(wide.blocks.size());
+					writeBlocks(hierarchy, child, positions, indices, wide);
+					wide.nodes[wideIndex].children[slot] = firstBlock;
+					wide.nodes[wideIndex].blockCounts[slot] = static_cast<uint32_t>(wide.blocks.size()) - firstBlock;
+				}
+				else
+				{
+					//the recursion may reallocate nodes, so no reference is held across it
+					const uint32_t childIndex = collapseNode(hierarchy, children[slot], positions, indices, wide);
+					wide.nodes[wideIndex].children[slot] = childIndex;
+				}
+			}
+
+			return wideIndex;
+		}
+	}
+
+	SimdLevel getSupportedSimdLevel()
+	{
+		static const SimdLevel supportedLevel = detectSimdLevel();
+		return supportedLevel;
+	}
+
+	const char *getSimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::SCALAR: return "scalar";
+		case SimdLevel::SSE: return "SSE BVH4";
+		case SimdLevel::AVX2: return "AVX2 BVH8";
+		case SimdLevel::AVX512: return "AVX-512 BVH8";
+		default: return "unknown";
+		}
+	}
+
+	template<uint32_t Width>
+	WideHierarchy<Width> collapse(const Hierarchy &hierarchy, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices)
+	{
+		WideHierarchy<Width> wide = {};
+		if (hierarchy.nodes.empty()) return wide;
+
+		wide.nodes.reserve(hierarchy.nodes.size() / (Width / 2) + 1);
+		wide.blocks.reserve(hierarchy.primitives.size() / Width + hierarchy.statistics.leafCount);
+		collapseNode(hierarchy, 0, positions, indices, wide);
+		return wide;
+	}
+
+	template WideHierarchy<4> collapse<4>(const Hierarchy &, const std::vector<glm::vec3> &, const std::vector<uint32_t> &);
+	template WideHierarchy<8> collapse<8>(const Hierarchy &, const std::vector<glm::vec3> &, const std::vector<uint32_t> &);
+
+	WideMesh createWideMesh(const Hierarchy &hierarchy, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, SimdLevel level)
+	{
+		assert(level <= getSupportedSimdLevel());
+
+		WideMesh mesh = {};
+		if (level >= SimdLevel::SSE) mesh.hierarchy4 = collapse<4>(hierarchy, positions, indices);
+		if (level >= SimdLevel::AVX2) mesh.hierarchy8 = collapse<8>(hierarchy, positions, indices);
+		return mesh;
+	}
+
+	bool intersect(const WideMesh &mesh, SimdLevel level, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit)
+	{
+		switch (level)
+		{
+		case SimdLevel::SSE: return intersectSse(mesh.hierarchy4, origin, direction, tMin, tMax, hit);
+		case SimdLevel::AVX2: return intersectAvx2(mesh.hierarchy8, origin, direction, tMin, tMax, hit);
+		case SimdLevel::AVX512: return intersectAvx512(mesh.hierarchy8, origin, direction, tMin, tMax, hit);
+		default:
+			assert(false && "the scalar path traverses the binary hierarchy");
+			return false;
+		}
+	}
+}
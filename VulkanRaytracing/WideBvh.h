@@ -0,0 +1,81 @@
+#pragma once
+#include "Bvh.h"
+
+//binary hierarchies collapsed into 4 or 8 wide nodes, traversed with SIMD kernels picked at runtime
+namespace bvh
+{
+	//widest kernels the CPU and the OS support, in increasing order
+	enum class SimdLevel
+	{
+		SCALAR,
+		SSE,
+		AVX2,
+		AVX512
+	};
+
+	[[nodiscard]]
+	SimdLevel getSupportedSimdLevel();
+	const char *getSimdLevelName(SimdLevel level);
+
+	//child bounds are stored structure-of-arrays so that one instruction tests every child on one plane
+	template<uint32_t Width>
+	struct alignas(64) WideNode
+	{
+		//[axis][0] holds the lower planes of all children, [axis][1] the upper ones
+		//empty slots have inverted bounds and are never hit
+		float bounds[3][2][Width];
+		//interior : index of the child node, leaf : first triangle block
+		uint32_t children[Width];
+		//interior and empty : zero, leaf : number of triangle blocks
+		uint32_t blockCounts[Width];
+	};
+	static_assert(sizeof(WideNode<4>) == 128 && sizeof(WideNode<8>) == 256);
+
+	//the triangles of one leaf, prepared for a Moller-Trumbore test of Width triangles at once
+	template<uint32_t Width>
+	struct alignas(64) TriangleBlock
+	{
+		float v0[3][Width];
+		float edge1[3][Width];
+		float edge2[3][Width];
+		//padding lanes have null edges, which the determinant test rejects
+		uint32_t primitives[Width];
+	};
+
+	template<uint32_t Width>
+	struct WideHierarchy
+	{
+		std::vector<WideNode<Width>> nodes;
+		std::vector<TriangleBlock<Width>> blocks;
+	};
+
+	struct TriangleHit
+	{
+		float t;
+		uint32_t primitive;
+		glm::vec2 barycentrics;
+	};
+
+	//hierarchy must have been built with buildTriangles over the same positions and indices
+	template<uint32_t Width>
+	[[nodiscard]]
+	WideHierarchy<Width> collapse(const Hierarchy &hierarchy, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices);
+
+	//closest triangle in [tMin, tMax], updates tMax and hit when it finds one
+	bool intersectSse(const WideHierarchy<4> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit);
+	bool intersectAvx2(const WideHierarchy<8> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit);
+	bool intersectAvx512(const WideHierarchy<8> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit);
+
+	//every layout a SIMD level may need, so that the level can change after the build
+	struct WideMesh
+	{
+		WideHierarchy<4> hierarchy4;
+		WideHierarchy<8> hierarchy8;
+	};
+
+	[[nodiscard]]
+	WideMesh createWideMesh(const Hierarchy &hierarchy, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, SimdLevel level);
+
+	//level must be above SCALAR and supported
+	bool intersect(const WideMesh &mesh, SimdLevel level, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit);
+}
@@ -0,0 +1,97 @@
+#include "WideBvhTraversal.h"
+#include <immintrin.h>
+
+//compiled with /arch:AVX2, only called once CPUID reported AVX2 and FMA
+namespace bvh
+{
+	namespace {
+
+		struct Avx2Kernel
+		{
+			__m256 origin[3];
+			__m256 direction[3];
+			__m256 inverseDirection[3];
+			//origin * inverseDirection, so that a plane distance is a single fused multiply subtract
+			__m256 scaledOrigin[3];
+			//0 when the ray enters the lower plane of an axis first
+			uint32_t nearPlane[3];
+
+			uint32_t intersectChildren(const WideNode<8> &node, float tMin, float tMax, float *distances) const
+			{
+				__m256 tNear = _mm256_set1_ps(tMin);
+				__m256 tFar = _mm256_set1_ps(tMax);
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					__m256 nearPlaneT = _mm256_fmsub_ps(_mm256_load_ps(node.bounds[axis][nearPlane[axis]]), inverseDirection[axis], scaledOrigin[axis]);
+					__m256 farPlaneT = _mm256_fmsub_ps(_mm256_load_ps(node.bounds[axis][1 - nearPlane[axis]]), inverseDirection[axis], scaledOrigin[axis]);
+					//the plane distance goes first so that a NaN leaves the interval as it is
+					tNear = _mm256_max_ps(nearPlaneT, tNear);
+					tFar = _mm256_min_ps(farPlaneT, tFar);
+				}
+
+				_mm256_store_ps(distances, tNear);
+				return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ)));
+			}
+
+			bool intersectBlock(const TriangleBlock<8> &block, float tMin, float &tMax, TriangleHit &hit) const
+			{
+				const __m256 edge1[3] = { _mm256_load_ps(block.edge1[0]), _mm256_load_ps(block.edge1[1]), _mm256_load_ps(block.edge1[2]) };
+				const __m256 edge2[3] = { _mm256_load_ps(block.edge2[0]), _mm256_load_ps(block.edge2[1]), _mm256_load_ps(block.edge2[2]) };
+
+				//p = cross(direction, edge2)
+				const __m256 px = _mm256_fmsub_ps(direction[1], edge2[2], _mm256_mul_ps(direction[2], edge2[1]));
+				const __m256 py = _mm256_fmsub_ps(direction[2], edge2[0], _mm256_mul_ps(direction[0], edge2[2]));
+				const __m256 pz = _mm256_fmsub_ps(direction[0], edge2[1], _mm256_mul_ps(direction[1], edge2[0]));
+				const __m256 determinant = _mm256_fmadd_ps(edge1[0], px, _mm256_fmadd_ps(edge1[1], py, _mm256_mul_ps(edge1[2], pz)));
+				const __m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+				const __m256 sx = _mm256_sub_ps(origin[0], _mm256_load_ps(block.v0[0]));
+				const __m256 sy = _mm256_sub_ps(origin[1], _mm256_load_ps(block.v0[1]));
+				const __m256 sz = _mm256_sub_ps(origin[2], _mm256_load_ps(block.v0[2]));
+				const __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sx, px, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sz, pz))), inverseDeterminant);
+
+				//q = cross(s, edge1)
+				const __m256 qx = _mm256_fmsub_ps(sy, edge1[2], _mm256_mul_ps(sz, edge1[1]));
+				const __m256 qy = _mm256_fmsub_ps(sz, edge1[0], _mm256_mul_ps(sx, edge1[2]));
+				const __m256 qz = _mm256_fmsub_ps(sx, edge1[1], _mm256_mul_ps(sy, edge1[0]));
+				const __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(direction[0], qx, _mm256_fmadd_ps(direction[1], qy, _mm256_mul_ps(direction[2], qz))), inverseDeterminant);
+				const __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(edge2[0], qx, _mm256_fmadd_ps(edge2[1], qy, _mm256_mul_ps(edge2[2], qz))), inverseDeterminant);
+
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 one = _mm256_set1_ps(1.0f);
+				__m256 valid = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-.0f), determinant), _mm256_set1_ps(1e-12f), _CMP_GE_OQ);
+				valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+				valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+				valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_set1_ps(tMin), _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(tMax), _CMP_LE_OQ)));
+
+				const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(valid));
+				if (mask == 0) return false;
+
+				alignas(32) float tLanes[8], uLanes[8], vLanes[8];
+				_mm256_store_ps(tLanes, t);
+				_mm256_store_ps(uLanes, u);
+				_mm256_store_ps(vLanes, v);
+				return selectClosest<8>(mask, tLanes, uLanes, vLanes, block, tMax, hit);
+			}
+		};
+	}
+
+	bool intersectAvx2(const WideHierarchy<8> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit)
+	{
+		const float originComponents[3] = { origin.x, origin.y, origin.z };
+		const float directionComponents[3] = { direction.x, direction.y, direction.z };
+
+		Avx2Kernel kernel;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const float inverseDirection = 1.0f / directionComponents[axis];
+			kernel.origin[axis] = _mm256_set1_ps(originComponents[axis]);
+			kernel.direction[axis] = _mm256_set1_ps(directionComponents[axis]);
+			kernel.inverseDirection[axis] = _mm256_set1_ps(inverseDirection);
+			kernel.scaledOrigin[axis] = _mm256_set1_ps(originComponents[axis] * inverseDirection);
+			kernel.nearPlane[axis] = inverseDirection >= .0f ? 0 : 1;
+		}
+
+		return traverseWide<8>(hierarchy, kernel, tMin, tMax, hit);
+	}
+}
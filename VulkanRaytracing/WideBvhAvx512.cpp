@@ -0,0 +1,108 @@
+#include "WideBvhTraversal.h"
+#include <immintrin.h>
+
+//compiled with /arch:AVX512, only called once CPUID reported AVX-512F and AVX-512VL
+namespace bvh
+{
+	namespace {
+
+		//upper half of the lanes, where the far planes end up
+		constexpr __mmask16 farLanes = 0xFF00;
+
+		struct Avx512Kernel
+		{
+			__m256 origin[3];
+			__m256 direction[3];
+			__m512 inverseDirection[3];
+			__m512 scaledOrigin[3];
+			//moves the planes the ray enters first into the lower half
+			__m512i planeOrder[3];
+
+			//the lower and upper planes of one axis are adjacent in the node, so one 512 bit register covers both
+			uint32_t intersectChildren(const WideNode<8> &node, float tMin, float tMax, float *distances) const
+			{
+				__m512 interval = _mm512_mask_blend_ps(farLanes, _mm512_set1_ps(tMin), _mm512_set1_ps(tMax));
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					__m512 planes = _mm512_permutexvar_ps(planeOrder[axis], _mm512_load_ps(node.bounds[axis][0]));
+					__m512 planeT = _mm512_fmsub_ps(planes, inverseDirection[axis], scaledOrigin[axis]);
+					//max into the entry distances, min into the exit ones
+					interval = _mm512_mask_min_ps(_mm512_max_ps(planeT, interval), farLanes, planeT, interval);
+				}
+
+				const __m256 tNear = _mm512_castps512_ps256(interval);
+				const __m256 tFar = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(interval), 1));
+				_mm256_store_ps(distances, tNear);
+				return static_cast<uint32_t>(_mm256_cmp_ps_mask(tNear, tFar, _CMP_LE_OQ));
+			}
+
+			bool intersectBlock(const TriangleBlock<8> &block, float tMin, float &tMax, TriangleHit &hit) const
+			{
+				const __m256 edge1[3] = { _mm256_load_ps(block.edge1[0]), _mm256_load_ps(block.edge1[1]), _mm256_load_ps(block.edge1[2]) };
+				const __m256 edge2[3] = { _mm256_load_ps(block.edge2[0]), _mm256_load_ps(block.edge2[1]), _mm256_load_ps(block.edge2[2]) };
+
+				//p = cross(direction, edge2)
+				const __m256 px = _mm256_fmsub_ps(direction[1], edge2[2], _mm256_mul_ps(direction[2], edge2[1]));
+				const __m256 py = _mm256_fmsub_ps(direction[2], edge2[0], _mm256_mul_ps(direction[0], edge2[2]));
+				const __m256 pz = _mm256_fmsub_ps(direction[0], edge2[1], _mm256_mul_ps(direction[1], edge2[0]));
+				const __m256 determinant = _mm256_fmadd_ps(edge1[0], px, _mm256_fmadd_ps(edge1[1], py, _mm256_mul_ps(edge1[2], pz)));
+
+				//rejecting on the determinant first skips the division for blocks no lane of which can hit
+				__mmask8 valid = _mm256_cmp_ps_mask(_mm256_andnot_ps(_mm256_set1_ps(-.0f), determinant), _mm256_set1_ps(1e-12f), _CMP_GE_OQ);
+				if (valid == 0) return false;
+				const __m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+				const __m256 sx = _mm256_sub_ps(origin[0], _mm256_load_ps(block.v0[0]));
+				const __m256 sy = _mm256_sub_ps(origin[1], _mm256_load_ps(block.v0[1]));
+				const __m256 sz = _mm256_sub_ps(origin[2], _mm256_load_ps(block.v0[2]));
+				const __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sx, px, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sz, pz))), inverseDeterminant);
+
+				const __m256 zero = _mm256_setzero_ps();
+				const __m256 one = _mm256_set1_ps(1.0f);
+				valid = _mm256_mask_cmp_ps_mask(valid, u, zero, _CMP_GE_OQ);
+				valid = _mm256_mask_cmp_ps_mask(valid, u, one, _CMP_LE_OQ);
+				if (valid == 0) return false;
+
+				//q = cross(s, edge1)
+				const __m256 qx = _mm256_fmsub_ps(sy, edge1[2], _mm256_mul_ps(sz, edge1[1]));
+				const __m256 qy = _mm256_fmsub_ps(sz, edge1[0], _mm256_mul_ps(sx, edge1[2]));
+				const __m256 qz = _mm256_fmsub_ps(sx, edge1[1], _mm256_mul_ps(sy, edge1[0]));
+				const __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(direction[0], qx, _mm256_fmadd_ps(direction[1], qy, _mm256_mul_ps(direction[2], qz))), inverseDeterminant);
+				const __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(edge2[0], qx, _mm256_fmadd_ps(edge2[1], qy, _mm256_mul_ps(edge2[2], qz))), inverseDeterminant);
+
+				valid = _mm256_mask_cmp_ps_mask(valid, v, zero, _CMP_GE_OQ);
+				valid = _mm256_mask_cmp_ps_mask(valid, _mm256_add_ps(u, v), one, _CMP_LE_OQ);
+				valid = _mm256_mask_cmp_ps_mask(valid, t, _mm256_set1_ps(tMin), _CMP_GE_OQ);
+				valid = _mm256_mask_cmp_ps_mask(valid, t, _mm256_set1_ps(tMax), _CMP_LE_OQ);
+				if (valid == 0) return false;
+
+				alignas(32) float tLanes[8], uLanes[8], vLanes[8];
+				_mm256_store_ps(tLanes, t);
+				_mm256_store_ps(uLanes, u);
+				_mm256_store_ps(vLanes, v);
+				return selectClosest<8>(static_cast<uint32_t>(valid), tLanes, uLanes, vLanes, block, tMax, hit);
+			}
+		};
+	}
+
+	bool intersectAvx512(const WideHierarchy<8> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit)
+	{
+		const float originComponents[3] = { origin.x, origin.y, origin.z };
+		const float directionComponents[3] = { direction.x, direction.y, direction.z };
+		const __m512i inOrder = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const __m512i swapped = _mm512_set_epi32(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+		Avx512Kernel kernel;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const float inverseDirection = 1.0f / directionComponents[axis];
+			kernel.origin[axis] = _mm256_set1_ps(originComponents[axis]);
+			kernel.direction[axis] = _mm256_set1_ps(directionComponents[axis]);
+			kernel.inverseDirection[axis] = _mm512_set1_ps(inverseDirection);
+			kernel.scaledOrigin[axis] = _mm512_set1_ps(originComponents[axis] * inverseDirection);
+			kernel.planeOrder[axis] = inverseDirection >= .0f ? inOrder : swapped;
+		}
+
+		return traverseWide<8>(hierarchy, kernel, tMin, tMax, hit);
+	}
+}
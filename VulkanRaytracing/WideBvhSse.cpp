@@ -0,0 +1,97 @@
+#include "WideBvhTraversal.h"
+#include <emmintrin.h>
+
+//SSE2 only, which every x64 CPU has
+namespace bvh
+{
+	namespace {
+
+		struct SseKernel
+		{
+			__m128 origin[3];
+			__m128 direction[3];
+			__m128 inverseDirection[3];
+			//origin * inverseDirection, so that a plane distance is a multiply and a subtract
+			__m128 scaledOrigin[3];
+			//0 when the ray enters the lower plane of an axis first
+			uint32_t nearPlane[3];
+
+			uint32_t intersectChildren(const WideNode<4> &node, float tMin, float tMax, float *distances) const
+			{
+				__m128 tNear = _mm_set1_ps(tMin);
+				__m128 tFar = _mm_set1_ps(tMax);
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					__m128 nearPlaneT = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(node.bounds[axis][nearPlane[axis]]), inverseDirection[axis]), scaledOrigin[axis]);
+					__m128 farPlaneT = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(node.bounds[axis][1 - nearPlane[axis]]), inverseDirection[axis]), scaledOrigin[axis]);
+					//the plane distance goes first so that a NaN, from a flat direction on a plane through the origin, leaves the interval as it is
+					tNear = _mm_max_ps(nearPlaneT, tNear);
+					tFar = _mm_min_ps(farPlaneT, tFar);
+				}
+
+				_mm_store_ps(distances, tNear);
+				return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+			}
+
+			bool intersectBlock(const TriangleBlock<4> &block, float tMin, float &tMax, TriangleHit &hit) const
+			{
+				const __m128 edge1[3] = { _mm_load_ps(block.edge1[0]), _mm_load_ps(block.edge1[1]), _mm_load_ps(block.edge1[2]) };
+				const __m128 edge2[3] = { _mm_load_ps(block.edge2[0]), _mm_load_ps(block.edge2[1]), _mm_load_ps(block.edge2[2]) };
+
+				//p = cross(direction, edge2)
+				const __m128 px = _mm_sub_ps(_mm_mul_ps(direction[1], edge2[2]), _mm_mul_ps(direction[2], edge2[1]));
+				const __m128 py = _mm_sub_ps(_mm_mul_ps(direction[2], edge2[0]), _mm_mul_ps(direction[0], edge2[2]));
+				const __m128 pz = _mm_sub_ps(_mm_mul_ps(direction[0], edge2[1]), _mm_mul_ps(direction[1], edge2[0]));
+				const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1[0], px), _mm_mul_ps(edge1[1], py)), _mm_mul_ps(edge1[2], pz));
+				const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+				const __m128 sx = _mm_sub_ps(origin[0], _mm_load_ps(block.v0[0]));
+				const __m128 sy = _mm_sub_ps(origin[1], _mm_load_ps(block.v0[1]));
+				const __m128 sz = _mm_sub_ps(origin[2], _mm_load_ps(block.v0[2]));
+				const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDeterminant);
+
+				//q = cross(s, edge1)
+				const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, edge1[2]), _mm_mul_ps(sz, edge1[1]));
+				const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, edge1[0]), _mm_mul_ps(sx, edge1[2]));
+				const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, edge1[1]), _mm_mul_ps(sy, edge1[0]));
+				const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction[0], qx), _mm_mul_ps(direction[1], qy)), _mm_mul_ps(direction[2], qz)), inverseDeterminant);
+				const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2[0], qx), _mm_mul_ps(edge2[1], qy)), _mm_mul_ps(edge2[2], qz)), inverseDeterminant);
+
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0f);
+				__m128 valid = _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-.0f), determinant), _mm_set1_ps(1e-12f));
+				valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+				valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+				valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(t, _mm_set1_ps(tMin)), _mm_cmple_ps(t, _mm_set1_ps(tMax))));
+
+				const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(valid));
+				if (mask == 0) return false;
+
+				alignas(16) float tLanes[4], uLanes[4], vLanes[4];
+				_mm_store_ps(tLanes, t);
+				_mm_store_ps(uLanes, u);
+				_mm_store_ps(vLanes, v);
+				return selectClosest<4>(mask, tLanes, uLanes, vLanes, block, tMax, hit);
+			}
+		};
+	}
+
+	bool intersectSse(const WideHierarchy<4> &hierarchy, const glm::vec3 &origin, const glm::vec3 &direction, float tMin, float &tMax, TriangleHit &hit)
+	{
+		const float originComponents[3] = { origin.x, origin.y, origin.z };
+		const float directionComponents[3] = { direction.x, direction.y, direction.z };
+
+		SseKernel kernel;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const float inverseDirection = 1.0f / directionComponents[axis];
+			kernel.origin[axis] = _mm_set1_ps(originComponents[axis]);
+			kernel.direction[axis] = _mm_set1_ps(directionComponents[axis]);
+			kernel.inverseDirection[axis] = _mm_set1_ps(inverseDirection);
+			kernel.scaledOrigin[axis] = _mm_set1_ps(originComponents[axis] * inverseDirection);
+			kernel.nearPlane[axis] = inverseDirection >= .0f ? 0 : 1;
+		}
+
+		return traverseWide<4>(hierarchy, kernel, tMin, tMax, hit);
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "WideBvh.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//traversal loop shared by the SIMD kernels, each of which includes it from a translation unit compiled for its instruction set
+//everything here has internal linkage so that code generated for a wider instruction set is never picked by the linker for another unit
+namespace bvh
+{
+	namespace {
+
+		inline uint32_t getLowestLane(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long lane;
+			_BitScanForward(&lane, mask);
+			return static_cast<uint32_t>(lane);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+		}
+
+		//keeps the nearest of the lanes that passed the triangle test
+		template<uint32_t Width>
+		bool selectClosest(uint32_t mask, const float *t, const float *u, const float *v, const TriangleBlock<Width> &block, float &tMax, TriangleHit &hit)
+		{
+			bool found = false;
+			while (mask != 0)
+			{
+				const uint32_t lane = getLowestLane(mask);
+				mask &= mask - 1;
+				if (t[lane] > tMax) continue;
+
+				tMax = t[lane];
+				hit.t = t[lane];
+				hit.primitive = block.primitives[lane];
+				hit.barycentrics.x = u[lane];
+				hit.barycentrics.y = v[lane];
+				found = true;
+			}
+			return found;
+		}
+
+		//Kernel::intersectChildren returns the mask of the children hit and writes their entry distances
+		//Kernel::intersectBlock tests every triangle of a block and keeps the closest one
+		template<uint32_t Width, typename Kernel>
+		bool traverseWide(const WideHierarchy<Width> &hierarchy, const Kernel &kernel, float tMin, float &tMax, TriangleHit &hit)
+		{
+			struct StackEntry
+			{
+				uint32_t node;
+				float distance;
+			};
+
+			if (hierarchy.nodes.empty()) return false;
+			const WideNode<Width> *nodes = hierarchy.nodes.data();
+			const TriangleBlock<Width> *blocks = hierarchy.blocks.data();
+
+			//every level pushes at most all of its children but one
+			StackEntry stack[maxDepth * (Width - 1) + 1];
+			uint32_t stackSize = 0;
+			stack[stackSize++] = StackEntry{ .node = 0, .distance = tMin };
+			bool found = false;
+
+			while (stackSize > 0)
+			{
+				const StackEntry entry = stack[--stackSize];
+				if (entry.distance > tMax) continue;
+
+				const WideNode<Width> &node = nodes[entry.node];
+				alignas(64) float distances[Width];
+				uint32_t mask = kernel.intersectChildren(node, tMin, tMax, distances);
+
+				StackEntry interior[Width];
+				uint32_t interiorCount = 0;
+				while (mask != 0)
+				{
+					const uint32_t lane = getLowestLane(mask);
+					mask &= mask - 1;
+
+					if (node.blockCounts[lane] > 0)
+					{
+						const uint32_t lastBlock = node.children[lane] + node.blockCounts[lane];
+						for (uint32_t block = node.children[lane]; block < lastBlock; block++)
+						{
+							if (kernel.intersectBlock(blocks[block], tMin, tMax, hit)) found = true;
+						}
+						continue;
+					}
+
+					//kept sorted far to near so that the nearest child ends up on top of the stack
+					uint32_t position = interiorCount++;
+					while (position > 0 && interior[position - 1].distance < distances[lane])
+					{
+						interior[position] = interior[position - 1];
+						position--;
+					}
+					interior[position] = StackEntry{ .node = node.children[lane], .distance = distances[lane] };
+				}
+
+				for (uint32_t i = 0; i < interiorCount; i++)
+				{
+					stack[stackSize++] = interior[i];
+				}
+			}
+
+			return found;
+		}
+	}
+}
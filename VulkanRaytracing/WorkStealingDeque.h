@@ -0,0 +1,127 @@
+#pragma once
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//Chase-Lev deque of pointers : its owner pushes and pops at the bottom without locking, any other thread steals from the top
+//memory orders follow Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models"
+template<typename T>
+class WorkStealingDeque
+{
+public:
+
+	//capacity must be a power of two, the deque grows by doubling when it is full
+	explicit WorkStealingDeque(int64_t capacity = 256)
+	{
+		buffers.push_back(std::make_unique<Buffer>(capacity));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque &) = delete;
+	WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+	//owner only
+	void push(T *item)
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		Buffer *items = buffer.load(std::memory_order_relaxed);
+		if (b - t > items->capacity - 1)
+		{
+			items = grow(items, b, t);
+		}
+
+		items->put(b, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	//owner only, newest item first, nullptr when empty
+	T *pop()
+	{
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer *items = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T *item = items->get(b);
+		if (t == b)
+		{
+			//last item, race the thieves for it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	//any thread, oldest item first, nullptr when empty or when another thread won the race for it
+	T *steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) return nullptr;
+
+		T *item = buffer.load(std::memory_order_acquire)->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return item;
+	}
+
+	//only a hint when read by a thread other than the owner
+	bool isEmpty() const
+	{
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	struct Buffer
+	{
+		int64_t capacity;
+		std::unique_ptr<std::atomic<T *>[]> items;
+
+		explicit Buffer(int64_t givenCapacity) : capacity(givenCapacity), items(std::make_unique<std::atomic<T *>[]>(static_cast<size_t>(givenCapacity)))
+		{
+			assert((capacity & (capacity - 1)) == 0);
+		}
+
+		T *get(int64_t index) const { return items[static_cast<size_t>(index & (capacity - 1))].load(std::memory_order_relaxed); }
+		void put(int64_t index, T *item) { items[static_cast<size_t>(index & (capacity - 1))].store(item, std::memory_order_relaxed); }
+	};
+
+	//thieves may still read from the old buffer, so it is only freed with the deque
+	Buffer *grow(Buffer *items, int64_t b, int64_t t)
+	{
+		buffers.push_back(std::make_unique<Buffer>(items->capacity * 2));
+		Buffer *grown = buffers.back().get();
+		for (int64_t i = t; i < b; i++)
+		{
+			grown->put(i, items->get(i));
+		}
+		buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+	std::atomic<int64_t> top = 0;
+	//keeps the top, written by thieves, off the cache line of the bottom, written by the owner
+	char padding[64];
+	std::atomic<int64_t> bottom = 0;
+	std::atomic<Buffer *> buffer;
+	//owner only
+	std::vector<std::unique_ptr<Buffer>> buffers;
+};
@@ -1,7 +1,126 @@
 #include "Raytracer.h"
+#include "Logger/Logger.h"
+#include <cstring>
+#include <cstdlib>
 
-int main() 
+int main(int argc, char **argv) 
 {
 	Raytracer raytracer;
-	raytracer.run();
+
+	//the mode comes first if there is one, --log <text file>, --binary-log <file for LogDecoder>,
+	//--frames-in-flight <1 to 4>, --present <throughput, latency or vsync>, --pacing, --uniform-sampling, --denoise, --wavefront, --visibility, --host-builds, --indirect-trace,
+	//--target-ms <GPU milliseconds per frame to scale the trace resolution for>, --trace <full, checkerboard or interleaved>
+	//and --bounces <0 to 4> may follow
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--pacing") == 0)
+		{
+			raytracer.setFramePacing(true);
+		}
+		else if (strcmp(argv[i], "--uniform-sampling") == 0)
+		{
+			raytracer.setAdaptiveSampling(false);
+		}
+		else if (strcmp(argv[i], "--denoise") == 0)
+		{
+			raytracer.setDenoiser(true);
+		}
+		else if (strcmp(argv[i], "--wavefront") == 0)
+		{
+			raytracer.setWavefront(true);
+		}
+		else if (strcmp(argv[i], "--visibility") == 0)
+		{
+			raytracer.setVisibilityQueries(true);
+		}
+		else if (strcmp(argv[i], "--host-builds") == 0)
+		{
+			raytracer.setHostBuilds(true);
+		}
+		else if (strcmp(argv[i], "--indirect-trace") == 0)
+		{
+			raytracer.setIndirectTrace(true);
+		}
+		if (i + 1 == argc) break;
+
+		if (strcmp(argv[i], "--log") == 0 && !Logger::openLogFile(argv[i + 1]))
+		{
+			Logger::logErrorFormatted("Couldn't open log file %s! ", argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--binary-log") == 0 && !Logger::openBinaryLogFile(argv[i + 1]))
+		{
+			Logger::logErrorFormatted("Couldn't open binary log file %s! ", argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0)
+		{
+			const int count = atoi(argv[i + 1]);
+			if (count >= 1 && static_cast<size_t>(count) <= Raytracer::maxFramesInFlight)
+			{
+				raytracer.setFramesInFlight(static_cast<size_t>(count));
+			}
+			else
+			{
+				Logger::logErrorFormatted("Frames in flight have to be between 1 and %u, not %s! ", static_cast<uint32_t>(Raytracer::maxFramesInFlight), argv[i + 1]);
+			}
+		}
+		else if (strcmp(argv[i], "--target-ms") == 0)
+		{
+			const double milliseconds = atof(argv[i + 1]);
+			if (milliseconds > .0)
+			{
+				raytracer.setTargetFrameTime(milliseconds);
+			}
+			else
+			{
+				Logger::logErrorFormatted("The target frame time has to be positive, not %s! ", argv[i + 1]);
+			}
+		}
+		else if (strcmp(argv[i], "--bounces") == 0)
+		{
+			const int bounces = atoi(argv[i + 1]);
+			if (bounces >= 0 && static_cast<uint32_t>(bounces) <= wavefront::maxBounces)
+			{
+				raytracer.setPathBounces(static_cast<uint32_t>(bounces));
+			}
+			else
+			{
+				Logger::logErrorFormatted("Bounces have to be between 0 and %u, not %s! ", wavefront::maxBounces, argv[i + 1]);
+			}
+		}
+		else if (strcmp(argv[i], "--trace") == 0)
+		{
+			if (strcmp(argv[i + 1], "full") == 0) raytracer.setTracePattern(reconstruction::TracePattern::FULL);
+			else if (strcmp(argv[i + 1], "checkerboard") == 0) raytracer.setTracePattern(reconstruction::TracePattern::CHECKERBOARD);
+			else if (strcmp(argv[i + 1], "interleaved") == 0) raytracer.setTracePattern(reconstruction::TracePattern::INTERLEAVED);
+			else Logger::logErrorFormatted("Unknown trace pattern %s! ", argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--present") == 0)
+		{
+			if (strcmp(argv[i + 1], "throughput") == 0) raytracer.setPresentPolicy(vkut::PresentPolicy::THROUGHPUT);
+			else if (strcmp(argv[i + 1], "latency") == 0) raytracer.setPresentPolicy(vkut::PresentPolicy::LATENCY);
+			else if (strcmp(argv[i + 1], "vsync") == 0) raytracer.setPresentPolicy(vkut::PresentPolicy::VSYNC);
+			else Logger::logErrorFormatted("Unknown present policy %s! ", argv[i + 1]);
+		}
+	}
+
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		raytracer.runBenchmark();
+	}
+	else if (argc > 1 && strcmp(argv[1], "--validate") == 0)
+	{
+		raytracer.runValidation();
+	}
+	else if (argc > 1 && strcmp(argv[1], "--cpu") == 0)
+	{
+		raytracer.runCpu();
+	}
+	else if (argc > 1 && strcmp(argv[1], "--cpu-benchmark") == 0)
+	{
+		raytracer.runCpuBenchmark();
+	}
+	else
+	{
+		raytracer.run();
+	}
 }
\ No newline at end of file
@@ -4,16 +4,11 @@
 #include "Logger/Logger.h"
 #include <string>
 #include <set>
+#include <chrono>
+#include <thread>
 #include "Files.h"
 
 
-#ifdef VKUT_USE_SETUP_RESOURCE_QUEUE
-#define SETUP_RESOURCE_QUEUE_PUSH(expr) { resourceQueue.push([=](){ expr; }); }
-#else
-#define SETUP_RESOURCE_QUEUE_PUSH(expr)
-#endif
-
-
 #pragma warning(disable : 4100)
 #pragma warning(disable : 4702)
 
@@ -29,6 +24,27 @@ namespace vkut {
 
 #define VK_SET_FUNC_PTR(func) (setFunctionPointer(func, #func))
 
+		struct DeferredDestruction
+		{
+			bool enabled = false;
+			//one open scope collecting what is destroyed until the next submission
+			ResourceQueue queue;
+		};
+
+		DeferredDestruction deferredDestruction;
+
+		//last value handed to a graphics queue submission
+		uint64_t submittedGraphicsValue = 0;
+
+		//true when the resource was queued instead of destroyed
+		template<typename... Resource>
+		bool deferDestruction(const Resource &...resource)
+		{
+			if (!deferredDestruction.enabled) return false;
+			deferredDestruction.queue.push(resource...);
+			return true;
+		}
+
 
 		template <class T>
 		T min(const T &a, const T &b)
@@ -258,6 +274,18 @@ namespace vkut {
 			return ~0U;
 		}
 
+		VkMemoryPropertyFlags getMemoryTypeProperties(uint32_t memoryTypeIndex)
+		{
+			VkPhysicalDeviceMemoryProperties memProperties;
+			vkGetPhysicalDeviceMemoryProperties(vkut::physicalDevice, &memProperties);
+			return memProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+		}
+
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
 		bool hasStencilComponent(VkFormat format)
 		{
 			return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
@@ -360,10 +388,18 @@ namespace vkut {
 				swapChainAdequate = swapChainSupport.formats.size() != 0 && swapChainSupport.presentModes.size() != 0;
 			}
 
-			VkPhysicalDeviceFeatures supportedFeatures;
-			vkGetPhysicalDeviceFeatures(givenPhysicalDevice, &supportedFeatures);
+			VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES
+			};
+			VkPhysicalDeviceFeatures2 supportedFeatures
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &timelineFeatures
+			};
+			vkGetPhysicalDeviceFeatures2(givenPhysicalDevice, &supportedFeatures);
 
-			return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+			return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.features.samplerAnisotropy && timelineFeatures.timelineSemaphore;
 		}
 
 #pragma endregion
@@ -382,16 +418,21 @@ namespace vkut {
 			return availableFormats[0];
 		}
 
-		VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes)
+		VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, PresentPolicy policy)
 		{
+			//fifo is the only mode every device supports
+			if (policy == PresentPolicy::VSYNC) return VK_PRESENT_MODE_FIFO_KHR;
+
+			const VkPresentModeKHR preferredMode = policy == PresentPolicy::THROUGHPUT ? VK_PRESENT_MODE_MAILBOX_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
+			const VkPresentModeKHR fallbackMode = policy == PresentPolicy::THROUGHPUT ? VK_PRESENT_MODE_IMMEDIATE_KHR : VK_PRESENT_MODE_MAILBOX_KHR;
 			VkPresentModeKHR bestMode = VK_PRESENT_MODE_FIFO_KHR;
 
 			for (unsigned int i = 0; i < availablePresentModes.size(); i++) {
 				const VkPresentModeKHR &availablePresentMode = availablePresentModes[i];
-				if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+				if (availablePresentMode == preferredMode) {
 					return availablePresentMode;
 				}
-				else if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+				else if (availablePresentMode == fallbackMode)
 				{
 					bestMode = availablePresentMode;
 				}
@@ -443,7 +484,7 @@ namespace vkut {
 
 			VkShaderModule shaderModule;
 			VK_CHECK(vkCreateShaderModule(vkut::device, &createInfo, nullptr, &shaderModule));
-			Logger::logTrivialFormatted("Created shader module %u!", shaderModule);
+			LOG_TRIVIAL_FORMATTED("Created shader module %u!", shaderModule);
 
 			return shaderModule;
 		}
@@ -451,7 +492,112 @@ namespace vkut {
 		void destroyShaderModule(VkShaderModule shaderModule)
 		{
 			vkDestroyShaderModule(device, shaderModule, nullptr);
-			Logger::logTrivialFormatted("Destroyed shader module %u!", shaderModule);
+			LOG_TRIVIAL_FORMATTED("Destroyed shader module %u!", shaderModule);
+		}
+
+		TimestampQueries createTimestampQueries(uint32_t count)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(vkut::physicalDevice, &properties);
+
+			VkQueryPoolCreateInfo queryPoolInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType = VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount = count,
+			};
+
+			TimestampQueries queries
+			{
+				.count = count,
+				.period = properties.limits.timestampPeriod
+			};
+			VK_CHECK(vkCreateQueryPool(vkut::device, &queryPoolInfo, nullptr, &queries.pool));
+			LOG_TRIVIAL_FORMATTED("Created timestamp query pool %u! ", queries.pool);
+
+			return queries;
+		}
+
+		void destroyTimestampQueries(TimestampQueries queries)
+		{
+			if (deferDestruction(queries)) return;
+			vkDestroyQueryPool(vkut::device, queries.pool, nullptr);
+			LOG_TRIVIAL_FORMATTED("Destroyed timestamp query pool %u! ", queries.pool);
+		}
+
+		void resetTimestamps(VkCommandBuffer commandBuffer, const TimestampQueries &queries, uint32_t first, uint32_t count)
+		{
+			assert(first + count <= queries.count);
+			vkCmdResetQueryPool(commandBuffer, queries.pool, first, count);
+		}
+
+		void writeTimestamp(VkCommandBuffer commandBuffer, const TimestampQueries &queries, uint32_t index, VkPipelineStageFlagBits stage)
+		{
+			assert(index < queries.count);
+			vkCmdWriteTimestamp(commandBuffer, stage, queries.pool, index);
+		}
+
+		double getElapsedMilliseconds(const TimestampQueries &queries, uint32_t begin, uint32_t end)
+		{
+			uint64_t beginTicks = 0, endTicks = 0;
+			VK_CHECK(vkGetQueryPoolResults(vkut::device, queries.pool, begin, 1, sizeof(uint64_t), &beginTicks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+			VK_CHECK(vkGetQueryPoolResults(vkut::device, queries.pool, end, 1, sizeof(uint64_t), &endTicks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+			return static_cast<double>(endTicks - beginTicks) * queries.period / 1000000.0;
+		}
+
+		void beginDeferredDestruction()
+		{
+			assert(!deferredDestruction.enabled);
+			deferredDestruction.queue.beginScope();
+			deferredDestruction.enabled = true;
+			Logger::logMessage("Began deferred destruction!");
+		}
+
+		void endDeferredDestruction()
+		{
+			deferredDestruction.enabled = false;
+			deferredDestruction.queue.popAll();
+			Logger::logMessage("Ended deferred destruction!");
+		}
+
+		uint64_t claimGraphicsValue()
+		{
+			const uint64_t value = ++submittedGraphicsValue;
+
+			//what was destroyed since the previous submission goes once this one completed
+			if (deferredDestruction.enabled)
+			{
+				deferredDestruction.queue.endScope(value);
+				deferredDestruction.queue.beginScope();
+			}
+			return value;
+		}
+
+		uint64_t getSubmittedGraphicsValue()
+		{
+			return submittedGraphicsValue;
+		}
+
+		uint64_t getCompletedGraphicsValue()
+		{
+			uint64_t value;
+			VK_CHECK(vkGetSemaphoreCounterValue(vkut::device, graphicsTimeline, &value));
+			return value;
+		}
+
+		void waitGraphicsValue(uint64_t value)
+		{
+			VkSemaphoreWaitInfo waitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+				.semaphoreCount = 1,
+				.pSemaphores = &graphicsTimeline,
+				.pValues = &value
+			};
+			VK_CHECK(vkWaitSemaphores(vkut::device, &waitInfo, std::numeric_limits<uint64_t>::max()));
+
+			//submissions complete in order, the timeline may already be past value
+			if (deferredDestruction.enabled) deferredDestruction.queue.collect(getCompletedGraphicsValue());
 		}
 
 
@@ -470,7 +616,7 @@ namespace vkut {
 				.sharingMode = VK_SHARING_MODE_EXCLUSIVE
 			};
 			VK_CHECK(vkCreateBuffer(vkut::device, &bufferInfo, nullptr, &buffer.buffer));
-			Logger::logTrivialFormatted("Created buffer %u! ", buffer);
+			LOG_TRIVIAL_FORMATTED("Created buffer %u! ", buffer.buffer);
 
 			VkMemoryRequirements memRequirements;
 			vkGetBufferMemoryRequirements(vkut::device, buffer.buffer, &memRequirements);
@@ -488,7 +634,7 @@ namespace vkut {
 			}
 
 			VK_CHECK(vkAllocateMemory(vkut::device, &allocInfo, nullptr, &buffer.memory));
-			Logger::logTrivialFormatted("Allocated buffer memory %u! ", buffer.memory);
+			LOG_TRIVIAL_FORMATTED("Allocated buffer memory %u! ", buffer.memory);
 
 			VK_CHECK(vkBindBufferMemory(vkut::device, buffer.buffer, buffer.memory, 0));
 			
@@ -497,10 +643,11 @@ namespace vkut {
 
 		void destroyBuffer(const Buffer &buffer)
 		{
+			if (deferDestruction(buffer)) return;
 			vkDestroyBuffer(vkut::device, buffer.buffer, nullptr);
 			vkFreeMemory(vkut::device, buffer.memory, nullptr);
-			Logger::logTrivialFormatted("Destroyed buffer %u! ", buffer.buffer);
-			Logger::logTrivialFormatted("Freed buffer memory %u! ", buffer.memory);
+			LOG_TRIVIAL_FORMATTED("Destroyed buffer %u! ", buffer.buffer);
+			LOG_TRIVIAL_FORMATTED("Freed buffer memory %u! ", buffer.memory);
 		}
 
 		void copyToBuffer(const Buffer &buffer, void *data, size_t size)
@@ -521,6 +668,189 @@ namespace vkut {
 			copyToBuffer(buffer, (void *)data.data(), sizeof(T) * data.size());
 		}
 
+		PersistentBuffer createPersistentBuffer(VkDeviceSize regionSize, uint32_t regionCount, VkBufferUsageFlags usage)
+		{
+			assert(regionCount > 0);
+
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(vkut::physicalDevice, &properties);
+
+			//every region can be bound as a dynamic offset and flushed without touching its neighbours
+			VkDeviceSize alignment = max(properties.limits.nonCoherentAtomSize, max(properties.limits.minUniformBufferOffsetAlignment, properties.limits.minStorageBufferOffsetAlignment));
+
+			PersistentBuffer persistentBuffer
+			{
+				.regionSize = regionSize,
+				.regionStride = alignUp(regionSize, alignment),
+				.regionCount = regionCount,
+				.atomSize = properties.limits.nonCoherentAtomSize,
+			};
+
+			VkBufferCreateInfo bufferInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.size = persistentBuffer.regionStride * regionCount,
+				.usage = usage,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE
+			};
+			persistentBuffer.buffer.size = bufferInfo.size;
+			VK_CHECK(vkCreateBuffer(vkut::device, &bufferInfo, nullptr, &persistentBuffer.buffer.buffer));
+
+			VkMemoryRequirements memRequirements;
+			vkGetBufferMemoryRequirements(vkut::device, persistentBuffer.buffer.buffer, &memRequirements);
+
+			VkMemoryAllocateInfo allocInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+				.allocationSize = memRequirements.size,
+				.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			};
+			persistentBuffer.coherent = (getMemoryTypeProperties(allocInfo.memoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+			VK_CHECK(vkAllocateMemory(vkut::device, &allocInfo, nullptr, &persistentBuffer.buffer.memory));
+			VK_CHECK(vkBindBufferMemory(vkut::device, persistentBuffer.buffer.buffer, persistentBuffer.buffer.memory, 0));
+
+			void *mappedData = nullptr;
+			VK_CHECK(vkMapMemory(vkut::device, persistentBuffer.buffer.memory, 0, VK_WHOLE_SIZE, 0, &mappedData));
+			persistentBuffer.mappedPointer = reinterpret_cast<uint8_t *>(mappedData);
+
+			LOG_MESSAGE_FORMATTED("Created %s persistent buffer %u with %u regions! ", persistentBuffer.coherent ? "coherent" : "non coherent", persistentBuffer.buffer.buffer, regionCount);
+
+			return persistentBuffer;
+		}
+
+		void destroyPersistentBuffer(PersistentBuffer persistentBuffer)
+		{
+			if (deferDestruction(persistentBuffer)) return;
+			vkUnmapMemory(vkut::device, persistentBuffer.buffer.memory);
+			destroyBuffer(persistentBuffer.buffer);
+		}
+
+		void *getRegionPointer(const PersistentBuffer &persistentBuffer, uint32_t region)
+		{
+			assert(region < persistentBuffer.regionCount);
+			return persistentBuffer.mappedPointer + getRegionOffset(persistentBuffer, region);
+		}
+
+		VkDeviceSize getRegionOffset(const PersistentBuffer &persistentBuffer, uint32_t region)
+		{
+			return persistentBuffer.regionStride * region;
+		}
+
+		VkMappedMemoryRange getAlignedRange(const PersistentBuffer &persistentBuffer, uint32_t region, VkDeviceSize offset, VkDeviceSize size)
+		{
+			assert(offset + size <= persistentBuffer.regionSize);
+
+			//the stride is a multiple of the atom size, so rounding out never leaves the region
+			VkDeviceSize begin = getRegionOffset(persistentBuffer, region) + offset;
+			VkDeviceSize alignedBegin = begin / persistentBuffer.atomSize * persistentBuffer.atomSize;
+			VkDeviceSize alignedEnd = min(alignUp(begin + size, persistentBuffer.atomSize), getRegionOffset(persistentBuffer, region) + persistentBuffer.regionStride);
+
+			return VkMappedMemoryRange
+			{
+				.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+				.memory = persistentBuffer.buffer.memory,
+				.offset = alignedBegin,
+				.size = alignedEnd - alignedBegin
+			};
+		}
+
+		void flushRegion(const PersistentBuffer &persistentBuffer, uint32_t region, VkDeviceSize offset, VkDeviceSize size)
+		{
+			if (persistentBuffer.coherent) return;
+
+			VkMappedMemoryRange range = getAlignedRange(persistentBuffer, region, offset, size);
+			VK_CHECK(vkFlushMappedMemoryRanges(vkut::device, 1, &range));
+		}
+
+		void invalidateRegion(const PersistentBuffer &persistentBuffer, uint32_t region, VkDeviceSize offset, VkDeviceSize size)
+		{
+			if (persistentBuffer.coherent) return;
+
+			VkMappedMemoryRange range = getAlignedRange(persistentBuffer, region, offset, size);
+			VK_CHECK(vkInvalidateMappedMemoryRanges(vkut::device, 1, &range));
+		}
+
+		void writeRegion(const PersistentBuffer &persistentBuffer, uint32_t region, const void *data, VkDeviceSize size, VkDeviceSize offset)
+		{
+			memcpy(reinterpret_cast<uint8_t *>(getRegionPointer(persistentBuffer, region)) + offset, data, size);
+			flushRegion(persistentBuffer, region, offset, size);
+		}
+
+		Buffer createDeviceLocalBuffer(VkCommandPool commandPool, VkDeviceSize size, VkBufferUsageFlags usage, const std::function<void(void *)> &writeData, VkMemoryAllocateFlagsInfo flagsInfo)
+		{
+			Buffer stagingBuffer = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			void *stagingData;
+			VK_CHECK(vkMapMemory(device, stagingBuffer.memory, 0, size, 0, &stagingData));
+			writeData(stagingData);
+			vkUnmapMemory(device, stagingBuffer.memory);
+
+			Buffer buffer = createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, flagsInfo);
+
+			VkBufferCopy copyRegion
+			{
+				.srcOffset = 0,
+				.dstOffset = 0,
+				.size = size
+			};
+
+			VkCommandBuffer commandBuffer = initSingleTimeCommands(commandPool);
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer, buffer.buffer, 1, &copyRegion);
+			submitSingleTimeCommands(commandPool, commandBuffer);
+
+			destroyBuffer(stagingBuffer);
+
+			return buffer;
+		}
+
+		std::vector<uint8_t> readImage(VkCommandPool commandPool, VkImage image, VkImageLayout layout, uint32_t width, uint32_t height, uint32_t bytesPerPixel)
+		{
+			const VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * bytesPerPixel;
+			Buffer readbackBuffer = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			VkImageSubresourceRange subresourceRange
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			};
+
+			VkBufferImageCopy copyRegion
+			{
+				.bufferOffset = 0,
+				.bufferRowLength = 0,
+				.bufferImageHeight = 0,
+				.imageSubresource
+				{
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = 0,
+					.baseArrayLayer = 0,
+					.layerCount = 1
+				},
+				.imageOffset = { 0, 0, 0 },
+				.imageExtent = { width, height, 1 }
+			};
+
+			VkCommandBuffer commandBuffer = initSingleTimeCommands(commandPool);
+			transitionImageLayout(commandBuffer, image, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, subresourceRange, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.buffer, 1, &copyRegion);
+			transitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layout, subresourceRange, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+			submitSingleTimeCommands(commandPool, commandBuffer);
+
+			std::vector<uint8_t> pixels = std::vector<uint8_t>(size);
+			void *mappedData;
+			VK_CHECK(vkMapMemory(device, readbackBuffer.memory, 0, size, 0, &mappedData));
+			memcpy(pixels.data(), mappedData, size);
+			vkUnmapMemory(device, readbackBuffer.memory);
+
+			destroyBuffer(readbackBuffer);
+
+			return pixels;
+		}
+
 		VkDescriptorPool createDescriptorPool(const std::vector<VkDescriptorType> &descriptorTypes, uint32_t descriptorCount, uint32_t maxSets)
 		{
 			std::vector<VkDescriptorPoolSize> poolSizes = std::vector<VkDescriptorPoolSize>(descriptorTypes.size());
@@ -544,15 +874,16 @@ namespace vkut {
 
 			VkDescriptorPool descriptorPool = {};
 			VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool));
-			Logger::logMessageFormatted("Created descriptor pool %u! ", descriptorPool);
+			LOG_MESSAGE_FORMATTED("Created descriptor pool %u! ", descriptorPool);
 			return descriptorPool;
 		}
 
 		//implicitly destroys all descriptor sets from this pool
 		void destroyDescriptorPool(VkDescriptorPool descriptorPool)
 		{
+			if (deferDestruction(ResourceType::DESCRIPTOR_POOL, descriptorPool)) return;
 			vkDestroyDescriptorPool(vkut::device, descriptorPool, nullptr);
-			Logger::logMessageFormatted("Destroyed descriptor pool %u! ", descriptorPool);
+			LOG_MESSAGE_FORMATTED("Destroyed descriptor pool %u! ", descriptorPool);
 		}
 		
 		VkDescriptorSet createDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorPool descriptorPool, const std::vector<DescriptorSetInfo> &descriptorSetInfos)
@@ -568,7 +899,7 @@ namespace vkut {
 			VkDescriptorSet descriptorSet = {};
 			
 			VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet));
-			Logger::logMessageFormatted("Allocated descriptor set %u!", descriptorSet);
+			LOG_MESSAGE_FORMATTED("Allocated descriptor set %u!", descriptorSet);
 
 			std::vector<VkWriteDescriptorSet> descriptorWrites = std::vector<VkWriteDescriptorSet>(descriptorSetInfos.size());
 			for (size_t i = 0; i < descriptorWrites.size(); i++)
@@ -593,7 +924,7 @@ namespace vkut {
 			}
 
 			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-			Logger::logMessageFormatted("Updated descriptor set %u! ", descriptorSet);
+			LOG_MESSAGE_FORMATTED("Updated descriptor set %u! ", descriptorSet);
 			
 			return descriptorSet;
 		}
@@ -608,16 +939,17 @@ namespace vkut {
 			VkDescriptorSetLayout descriptorSetLayout = {};
 			VK_CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout));
 
-			Logger::logMessageFormatted("Created descriptor set layout %u! ", descriptorSetLayout);
+			LOG_MESSAGE_FORMATTED("Created descriptor set layout %u! ", descriptorSetLayout);
 
 			return descriptorSetLayout;
 		}
 
 		void destroyDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout)
 		{
+			if (deferDestruction(ResourceType::DESCRIPTOR_SET_LAYOUT, descriptorSetLayout)) return;
 			vkDestroyDescriptorSetLayout(vkut::device, descriptorSetLayout, nullptr);
 
-			Logger::logMessageFormatted("Destroyed descriptor set layout %u! ", descriptorSetLayout);
+			LOG_MESSAGE_FORMATTED("Destroyed descriptor set layout %u! ", descriptorSetLayout);
 		}
 
 
@@ -783,15 +1115,16 @@ namespace vkut {
 			VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &image.memory));
 			VK_CHECK(vkBindImageMemory(device, image.image, image.memory, 0));
 
-			Logger::logMessageFormatted("Created image %u with memory %u! ", image.image, image.memory);
+			LOG_MESSAGE_FORMATTED("Created image %u with memory %u! ", image.image, image.memory);
 			return image;
 		}
 
 		void destroyImage(Image image)
 		{
+			if (deferDestruction(image)) return;
 			vkDestroyImage(vkut::device, image.image, nullptr);
 			vkFreeMemory(vkut::device, image.memory, nullptr);
-			Logger::logMessageFormatted("Destroyed image %u with memory %u! ", image.image, image.memory);
+			LOG_MESSAGE_FORMATTED("Destroyed image %u with memory %u! ", image.image, image.memory);
 		}
 
 
@@ -805,7 +1138,7 @@ namespace vkut {
 		}
 
 
-		VkPipelineLayout createPipelineLayout(std::vector<VkDescriptorSetLayout> descriptorSetLayouts)
+		VkPipelineLayout createPipelineLayout(std::vector<VkDescriptorSetLayout> descriptorSetLayouts, std::vector<VkPushConstantRange> pushConstantRanges)
 		{
 			VkPipelineLayout pipelineLayout = {};
 
@@ -813,23 +1146,48 @@ namespace vkut {
 			{
 				.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
 				.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
-				.pSetLayouts = descriptorSetLayouts.data()
+				.pSetLayouts = descriptorSetLayouts.data(),
+				.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+				.pPushConstantRanges = pushConstantRanges.data()
 			};
 			vkCreatePipelineLayout(vkut::device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
-			Logger::logMessageFormatted("Created pipeline layout %u! ", pipelineLayout);
+			LOG_MESSAGE_FORMATTED("Created pipeline layout %u! ", pipelineLayout);
 			return pipelineLayout;
 		}
 		
 		void destroyPipelineLayout(VkPipelineLayout pipelineLayout)
 		{
+			if (deferDestruction(ResourceType::PIPELINE_LAYOUT, pipelineLayout)) return;
 			vkDestroyPipelineLayout(vkut::device, pipelineLayout, nullptr);
-			Logger::logMessageFormatted("Destroyed pipeline layout %u! ", pipelineLayout);
+			LOG_MESSAGE_FORMATTED("Destroyed pipeline layout %u! ", pipelineLayout);
 		}
 
 		void destroyPipeline(VkPipeline pipeline)
 		{
+			if (deferDestruction(ResourceType::PIPELINE, pipeline)) return;
 			vkDestroyPipeline(vkut::device, pipeline, nullptr);
-			Logger::logMessageFormatted("Destroyed pipeline %u! ", pipeline);
+			LOG_MESSAGE_FORMATTED("Destroyed pipeline %u! ", pipeline);
+		}
+
+		VkPipeline createComputePipeline(VkPipelineLayout layout, VkShaderModule shaderModule)
+		{
+			VkComputePipelineCreateInfo pipelineCreateInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+				.stage
+				{
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+					.module = shaderModule,
+					.pName = "main"
+				},
+				.layout = layout,
+			};
+
+			VkPipeline pipeline = {};
+			VK_CHECK(vkCreateComputePipelines(vkut::device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline));
+			LOG_MESSAGE_FORMATTED("Created compute pipeline %u! ", pipeline);
+			return pipeline;
 		}
 
 		VkRenderPass createRenderPass(const std::vector<VkAttachmentDescription> &colorDescriptions, Optional<VkAttachmentDescription> depthDescription)
@@ -887,15 +1245,16 @@ namespace vkut {
 
 			VkRenderPass renderPass;
 			VK_CHECK(vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass));
-			Logger::logMessageFormatted("Created render pass %u! ", renderPass);
+			LOG_MESSAGE_FORMATTED("Created render pass %u! ", renderPass);
 
 			return renderPass;
 		}
 
 		void destroyRenderPass(VkRenderPass renderPass)
 		{
+			if (deferDestruction(ResourceType::RENDER_PASS, renderPass)) return;
 			vkDestroyRenderPass(vkut::device, renderPass, nullptr);
-			Logger::logMessageFormatted("Destroyed render pass %u! ", renderPass);
+			LOG_MESSAGE_FORMATTED("Destroyed render pass %u! ", renderPass);
 		}
 
 
@@ -918,15 +1277,99 @@ namespace vkut {
 			};
 
 			VK_CHECK(vkCreateImageView(vkut::device, &viewInfo, nullptr, &returnImageView));
-			Logger::logMessageFormatted("Created image view %u! ", returnImageView);
+			LOG_MESSAGE_FORMATTED("Created image view %u! ", returnImageView);
 
 			return returnImageView;
 		}
 
 		void destroyImageView(VkImageView view)
 		{
+			if (deferDestruction(ResourceType::IMAGE_VIEW, view)) return;
 			vkDestroyImageView(vkut::device, view, nullptr);
-			Logger::logMessageFormatted("Destroyed image view %u! ", view);
+			LOG_MESSAGE_FORMATTED("Destroyed image view %u! ", view);
+		}
+
+		StorageImage createStorageImage(VkCommandPool commandPool, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage)
+		{
+			VkImageCreateInfo imageInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+				.imageType = VK_IMAGE_TYPE_2D,
+				.format = format,
+				.extent = { extent.width, extent.height, 1 },
+				.mipLevels = 1,
+				.arrayLayers = 1,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.tiling = VK_IMAGE_TILING_OPTIMAL,
+				.usage = usage | VK_IMAGE_USAGE_STORAGE_BIT,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+			};
+
+			StorageImage storageImage
+			{
+				.image = createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+				.format = format,
+				.extent = extent
+			};
+			storageImage.view = createImageView(storageImage.image.image, format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+			VkImageSubresourceRange subresourceRange
+			{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			};
+			transitionImageLayout(commandPool, storageImage.image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, subresourceRange,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+			return storageImage;
+		}
+
+		void destroyStorageImage(StorageImage storageImage)
+		{
+			destroyImageView(storageImage.view);
+			destroyImage(storageImage.image);
+		}
+
+		void recordShaderBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+		{
+			VkMemoryBarrier barrier
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+				.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			};
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				srcStage,
+				dstStage,
+				0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr);
+		}
+
+		void recordIndirectBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+		{
+			VkMemoryBarrier barrier
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+				.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+			};
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				srcStage,
+				dstStage | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+				0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr);
 		}
 
 
@@ -943,7 +1386,7 @@ namespace vkut {
 
 			VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()));
 
-			Logger::logMessageFormatted("Created %u command buffers! ", amount);
+			LOG_MESSAGE_FORMATTED("Created %u command buffers! ", amount);
 
 			return commandBuffers;
 		}
@@ -951,7 +1394,17 @@ namespace vkut {
 		void destroyCommandBuffers(VkCommandPool commandPool, const std::vector<VkCommandBuffer> &commandBuffers)
 		{
 			vkFreeCommandBuffers(vkut::device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-			Logger::logMessageFormatted("Destroyed %u command buffers! ", commandBuffers.size());
+			LOG_MESSAGE_FORMATTED("Destroyed %u command buffers! ", commandBuffers.size());
+		}
+
+		VkCommandBuffer beginSingleTimeCommands(VkCommandPool commandPool)
+		{
+			return initSingleTimeCommands(commandPool);
+		}
+
+		void endSingleTimeCommands(VkCommandPool commandPool, VkCommandBuffer commandBuffer)
+		{
+			submitSingleTimeCommands(commandPool, commandBuffer);
 		}
 
 		void startRecordCommandBuffer(VkCommandBuffer commandBuffer)
@@ -973,32 +1426,61 @@ namespace vkut {
 	namespace setup {
 
 #ifdef VKUT_USE_SETUP_RESOURCE_QUEUE
-#define SETUP_RESOURCE_QUEUE_PUSH(expr) { resourceQueue.push([=](){ expr; }); }
+#define SETUP_RESOURCE_QUEUE_PUSH(...) { resourceQueue.push(__VA_ARGS__); }
 #else
-#define SETUP_RESOURCE_QUEUE_PUSH(expr)
+#define SETUP_RESOURCE_QUEUE_PUSH(...)
 #endif
+
+		namespace {
+
+			void createRenderFinishedSemaphores()
+			{
+				VkSemaphoreCreateInfo semaphoreInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+				};
+
+				renderFinishedSemaphores.resize(swapChainImages.size());
+				for (size_t i = 0; i < renderFinishedSemaphores.size(); i++)
+				{
+					VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]));
+				}
+			}
+		}
 	
 		void createSyncObjects(size_t maxFramesInFlight)
 		{
 			imageAvailableSemaphores.resize(maxFramesInFlight);
-			inFlightFences.resize(maxFramesInFlight);
 
-			VkSemaphoreCreateInfo semaphoreInfo = {};
-			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-			VkFenceCreateInfo fenceInfo = {};
-			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+			VkSemaphoreCreateInfo semaphoreInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+			};
 
 			for (size_t i = 0; i < maxFramesInFlight; i++)
 			{
 				VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores.data()[i]));
-				VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences.data()[i]));
 			};
 
+			createRenderFinishedSemaphores();
+
+			VkSemaphoreTypeCreateInfo timelineInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				//values keep increasing should the sync objects be created again
+				.initialValue = submittedGraphicsValue
+			};
+			VkSemaphoreCreateInfo timelineSemaphoreInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+				.pNext = &timelineInfo
+			};
+			VK_CHECK(vkCreateSemaphore(device, &timelineSemaphoreInfo, nullptr, &graphicsTimeline));
+
 			Logger::logMessage("Created sync objects!");
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroySyncObjects());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::SYNC_OBJECTS);
 		}
 
 		void destroySyncObjects()
@@ -1008,10 +1490,12 @@ namespace vkut {
 				vkDestroySemaphore(vkut::device, imageAvailableSemaphores[i], nullptr);
 			};
 
-			for (size_t i = 0; i < inFlightFences.size(); i++)
+			for (size_t i = 0; i < renderFinishedSemaphores.size(); i++)
 			{
-				vkDestroyFence(vkut::device, inFlightFences[i], nullptr);
+				vkDestroySemaphore(vkut::device, renderFinishedSemaphores[i], nullptr);
 			};
+
+			vkDestroySemaphore(vkut::device, graphicsTimeline, nullptr);
 			Logger::logMessage("Destroyed sync objects!");
 		}
 
@@ -1033,20 +1517,21 @@ namespace vkut {
 				.layers = 1
 			};
 			VK_CHECK(vkCreateFramebuffer(vkut::device, &framebufferInfo, nullptr, &framebuffer));
-			Logger::logMessageFormatted("Created framebuffer %u with renderpass %u! ", framebuffer, renderPass);
+			LOG_MESSAGE_FORMATTED("Created framebuffer %u with renderpass %u! ", framebuffer, renderPass);
 			
-			SETUP_RESOURCE_QUEUE_PUSH(destroyFramebuffer());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::FRAMEBUFFER, framebuffer);
 			
 			return framebuffer;
 		}
 
 		void destroyFramebuffer(VkFramebuffer framebuffer)
 		{
+			if (deferDestruction(ResourceType::FRAMEBUFFER, framebuffer)) return;
 			vkDestroyFramebuffer(vkut::device, framebuffer, nullptr);
-			Logger::logMessageFormatted("Destroyed framebuffer %u! ", framebuffer);
+			LOG_MESSAGE_FORMATTED("Destroyed framebuffer %u! ", framebuffer);
 		}
 
-		VkCommandPool createGraphicsCommandPool()
+		VkCommandPool createGraphicsCommandPool(VkCommandPoolCreateFlags flags)
 		{
 			QueueFamilyIndices queueFamilyIndices = findQueueFamilies(vkut::physicalDevice);
 			assert(queueFamilyIndices.graphicsFamily.isSet());
@@ -1054,15 +1539,16 @@ namespace vkut {
 			VkCommandPoolCreateInfo poolInfo
 			{
 				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = flags,
 				.queueFamilyIndex = queueFamilyIndices.graphicsFamily.getValue(),
 			};
 
 			VkCommandPool commandPool;
 			VK_CHECK(vkCreateCommandPool(vkut::device, &poolInfo, nullptr, &commandPool));
 
-			Logger::logMessageFormatted("Created graphics command pool %u! ", commandPool);
+			LOG_MESSAGE_FORMATTED("Created graphics command pool %u! ", commandPool);
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroyCommandPool(commandPool));
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::COMMAND_POOL, commandPool);
 
 			return commandPool;
 		}
@@ -1070,89 +1556,104 @@ namespace vkut {
 		void destroyCommandPool(VkCommandPool commandPool)
 		{
 			vkDestroyCommandPool(vkut::device, commandPool, nullptr);
-			Logger::logMessageFormatted("Destroyed command pool %u! ", commandPool);
+			LOG_MESSAGE_FORMATTED("Destroyed command pool %u! ", commandPool);
 		}
 
-		void createSwapchainImageViews()
-		{
-			vkut::swapChainImageViews.resize(swapChainImages.size());
-			for (size_t i = 0; i < swapChainImageViews.size(); i++)
+		namespace {
+
+			//shared by the first creation and recreateSwapChain, which keeps the queue entries of the first
+			void initSwapchainImageViews()
 			{
-				swapChainImageViews[i] = common::createImageView(swapChainImages[i], swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+				vkut::swapChainImageViews.resize(swapChainImages.size());
+				for (size_t i = 0; i < swapChainImageViews.size(); i++)
+				{
+					swapChainImageViews[i] = common::createImageView(swapChainImages[i], swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+				}
+				Logger::logMessage("Created swapchain image views!");
 			}
-			Logger::logMessage("Created swapchain image views!");
-
-			SETUP_RESOURCE_QUEUE_PUSH(destroySwapchainImageViews());
-		}
 
-		void destroySwapchainImageViews()
-		{
-			for (size_t i = 0; i < swapChainImageViews.size(); i++)
+			void initSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags)
 			{
-				common::destroyImageView(swapChainImageViews[i]);
-			}
-			Logger::logMessage("Destroyed swapchain image views!");
-		}
+				SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
-		void createSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags)
-		{
-			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
+				VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
+				VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes, presentPolicy);
+				VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities, width, height);
 
-			VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-			VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
-			VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities, width, height);
+				uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
 
-			uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+				if (swapChainSupport.capabilities.maxImageCount > 0
+					&& imageCount > swapChainSupport.capabilities.maxImageCount)
+				{
+					imageCount = swapChainSupport.capabilities.maxImageCount;
+				}
 
-			if (swapChainSupport.capabilities.maxImageCount > 0
-				&& imageCount > swapChainSupport.capabilities.maxImageCount)
-			{
-				imageCount = swapChainSupport.capabilities.maxImageCount;
-			}
+				VkSwapchainCreateInfoKHR createInfo
+				{
+					.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+					.surface = surface,
+					.minImageCount = imageCount,
+					.imageFormat = surfaceFormat.format,
+					.imageColorSpace = surfaceFormat.colorSpace,
+					.imageExtent = extent,
+					.imageArrayLayers = 1,
+					.imageUsage = flags,
+					.preTransform = swapChainSupport.capabilities.currentTransform,
+					.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+					.presentMode = presentMode,
+					.clipped = VK_TRUE,
+					//lets the driver reuse what it can of a swapchain being recreated
+					.oldSwapchain = vkut::swapChain,
+				};
 
-			VkSwapchainCreateInfoKHR createInfo
-			{
-				.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-				.surface = surface,
-				.minImageCount = imageCount,
-				.imageFormat = surfaceFormat.format,
-				.imageColorSpace = surfaceFormat.colorSpace,
-				.imageExtent = extent,
-				.imageArrayLayers = 1,
-				.imageUsage = flags,
-				.preTransform = swapChainSupport.capabilities.currentTransform,
-				.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-				.presentMode = presentMode,
-				.clipped = VK_TRUE,
-				.oldSwapchain = VK_NULL_HANDLE,
-			};
+				QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+				uint32_t queueFamilyIndices[] = { indices.graphicsFamily.getValue(), indices.presentFamily.getValue() };
 
-			QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
-			uint32_t queueFamilyIndices[] = { indices.graphicsFamily.getValue(), indices.presentFamily.getValue() };
+				if (indices.graphicsFamily.getValue() != indices.presentFamily.getValue())
+				{
+					createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+					createInfo.queueFamilyIndexCount = 2;
+					createInfo.pQueueFamilyIndices = queueFamilyIndices;
+				}
+				else
+				{
+					createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				}
 
-			if (indices.graphicsFamily.getValue() != indices.presentFamily.getValue())
-			{
-				createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-				createInfo.queueFamilyIndexCount = 2;
-				createInfo.pQueueFamilyIndices = queueFamilyIndices;
-			}
-			else
-			{
-				createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				VK_CHECK(vkCreateSwapchainKHR(vkut::device, &createInfo, nullptr, &vkut::swapChain));
+				LOG_MESSAGE_FORMATTED("Created swapchain %u with present mode %u! ", vkut::swapChain, presentMode);
+
+				vkGetSwapchainImagesKHR(vkut::device, vkut::swapChain, &imageCount, nullptr);
+				swapChainImages.resize(imageCount);
+				vkGetSwapchainImagesKHR(vkut::device, vkut::swapChain, &imageCount, vkut::swapChainImages.data());
+
+				vkut::swapChainImageFormat = surfaceFormat.format;
+				vkut::swapChainExtent = extent;
 			}
+		}
 
+		void createSwapchainImageViews()
+		{
+			initSwapchainImageViews();
 
-			VK_CHECK(vkCreateSwapchainKHR(vkut::device, &createInfo, nullptr, &vkut::swapChain));
-			Logger::logMessage("Created swapchain!");
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::SWAPCHAIN_IMAGE_VIEWS);
+		}
 
-			vkGetSwapchainImagesKHR(vkut::device, vkut::swapChain, &imageCount, nullptr);
-			swapChainImages.resize(imageCount);
-			vkGetSwapchainImagesKHR(vkut::device, vkut::swapChain, &imageCount, vkut::swapChainImages.data());
+		void destroySwapchainImageViews()
+		{
+			for (size_t i = 0; i < swapChainImageViews.size(); i++)
+			{
+				common::destroyImageView(swapChainImageViews[i]);
+			}
+			Logger::logMessage("Destroyed swapchain image views!");
+		}
 
-			vkut::swapChainImageFormat = surfaceFormat.format;
-			vkut::swapChainExtent = extent;
+		void createSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags)
+		{
+			initSwapChain(width, height, flags);
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroySwapChain());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::SWAPCHAIN);
 		}
 
 		void destroySwapChain()
@@ -1161,6 +1662,26 @@ namespace vkut {
 			Logger::logMessage("Destroyed swapchain!");
 		}
 
+		void recreateSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags)
+		{
+			destroySwapchainImageViews();
+
+			VkSwapchainKHR oldSwapChain = swapChain;
+			initSwapChain(width, height, flags);
+			initSwapchainImageViews();
+
+			//frames in flight may still present images of the old swapchain, which wait on their render finished semaphores
+			for (VkSemaphore semaphore : renderFinishedSemaphores)
+			{
+				if (!deferDestruction(ResourceType::SEMAPHORE, semaphore)) vkDestroySemaphore(device, semaphore, nullptr);
+			}
+			createRenderFinishedSemaphores();
+
+			if (deferDestruction(ResourceType::RETIRED_SWAPCHAIN, oldSwapChain)) return;
+			vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed retired swapchain %u! ", oldSwapChain);
+		}
+
 		void createLogicalDevice(void *pNext)
 		{
 			QueueFamilyIndices indices = findQueueFamilies(vkut::physicalDevice);
@@ -1189,10 +1710,17 @@ namespace vkut {
 				.samplerAnisotropy = VK_TRUE
 			};
 
+			VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+				.pNext = pNext,
+				.timelineSemaphore = VK_TRUE,
+			};
+
 			VkPhysicalDeviceBufferDeviceAddressFeatures addressFeatures
 			{
 				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
-				.pNext = pNext,
+				.pNext = &timelineFeatures,
 				.bufferDeviceAddress = VK_TRUE,
 			};
 
@@ -1229,7 +1757,7 @@ namespace vkut {
 			vkGetDeviceQueue(vkut::device, indices.graphicsFamily.getValue(), 0, &vkut::graphicsQueue);
 			vkGetDeviceQueue(vkut::device, indices.presentFamily.getValue(), 0, &vkut::presentQueue);
 			
-			SETUP_RESOURCE_QUEUE_PUSH(destroyLogicalDevice());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::LOGICAL_DEVICE);
 		}
 
 		void destroyLogicalDevice()
@@ -1268,7 +1796,7 @@ namespace vkut {
 			VK_CHECK(glfwCreateWindowSurface(vkut::instance, window, nullptr, &vkut::surface));
 			Logger::logMessage("Created surface!");
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroySurface());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::SURFACE);
 		}
 
 		void destroySurface()
@@ -1288,7 +1816,7 @@ namespace vkut {
 
 			Logger::logMessage("Created debug messenger!");
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroyDebugMessenger());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::DEBUG_MESSENGER);
 		}
 
 		void destroyDebugMessenger() {
@@ -1344,7 +1872,7 @@ namespace vkut {
 			VK_CHECK(vkCreateInstance(&createInfo, nullptr, &vkut::instance));
 			Logger::logMessage("Created instance!");
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroyInstance());
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::INSTANCE);
 		}
 
 		void destroyInstance()
@@ -1361,7 +1889,7 @@ namespace vkut {
 			assert(window != NULL);
 			Logger::logMessage("Created window!");
 
-			SETUP_RESOURCE_QUEUE_PUSH(destroyWindow(window));
+			SETUP_RESOURCE_QUEUE_PUSH(ResourceType::WINDOW, window);
 
 			return window;
 		}
@@ -1383,49 +1911,87 @@ namespace vkut {
 			
 			VK_SET_FUNC_PTR(vkCreateAccelerationStructureKHR);
 			VK_SET_FUNC_PTR(vkDestroyAccelerationStructureKHR);
-			VK_SET_FUNC_PTR(vkBindAccelerationStructureMemoryKHR);
-			VK_SET_FUNC_PTR(vkGetAccelerationStructureMemoryRequirementsKHR);
-			VK_SET_FUNC_PTR(vkCmdBuildAccelerationStructureKHR);
 			VK_SET_FUNC_PTR(vkCreateRayTracingPipelinesKHR);
 			VK_SET_FUNC_PTR(vkGetRayTracingShaderGroupHandlesKHR);
 			VK_SET_FUNC_PTR(vkCmdTraceRaysKHR);
+			VK_SET_FUNC_PTR(vkCmdTraceRaysIndirectKHR);
 			VK_SET_FUNC_PTR(vkGetAccelerationStructureDeviceAddressKHR);
+			VK_SET_FUNC_PTR(vkCmdWriteAccelerationStructuresPropertiesKHR);
+			VK_SET_FUNC_PTR(vkCmdCopyAccelerationStructureKHR);
+			VK_SET_FUNC_PTR(vkWriteAccelerationStructuresPropertiesKHR);
+			VK_SET_FUNC_PTR(vkCopyAccelerationStructureKHR);
+			VK_SET_FUNC_PTR(vkCreateDeferredOperationKHR);
+			VK_SET_FUNC_PTR(vkDestroyDeferredOperationKHR);
+			VK_SET_FUNC_PTR(vkGetDeferredOperationMaxConcurrencyKHR);
+			VK_SET_FUNC_PTR(vkGetDeferredOperationResultKHR);
+			VK_SET_FUNC_PTR(vkDeferredOperationJoinKHR);
+			VK_SET_FUNC_PTR(vkGetAccelerationStructureBuildSizesKHR);
+			VK_SET_FUNC_PTR(vkCmdBuildAccelerationStructuresKHR);
+			VK_SET_FUNC_PTR(vkBuildAccelerationStructuresKHR);
 
 		}
 
 		void getPhysicalDeviceRaytracingProperties() 
 		{
-			physicalDeviceRaytracingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PROPERTIES_NV;
+			physicalDeviceRaytracingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR;
 			VkPhysicalDeviceProperties2 deviceProps2{};
 			deviceProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
 			deviceProps2.pNext = &physicalDeviceRaytracingProperties;
 			vkGetPhysicalDeviceProperties2(vkut::physicalDevice, &deviceProps2);
 		}
 
-		VkMemoryRequirements getAccelerationStructureMemoryRequirements(VkAccelerationStructureKHR acceleration, VkAccelerationStructureMemoryRequirementsTypeKHR type)
+		void *getFeatureChain(Features &features)
 		{
-			VkMemoryRequirements2 memoryRequirements2;
-			memoryRequirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
-			memoryRequirements2.pNext = nullptr;
-
-			VkAccelerationStructureMemoryRequirementsInfoKHR accelerationMemoryRequirements
+			VkPhysicalDeviceRayTracingPipelineFeaturesKHR supportedPipeline
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR,
+				.pNext = nullptr,
+			};
+			VkPhysicalDeviceAccelerationStructureFeaturesKHR supported
 			{
-				accelerationMemoryRequirements.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_INFO_KHR,
-				accelerationMemoryRequirements.pNext = nullptr,
-				accelerationMemoryRequirements.type = type,
-				accelerationMemoryRequirements.buildType = VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-				accelerationMemoryRequirements.accelerationStructure = acceleration,
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR,
+				.pNext = &supportedPipeline,
 			};
+			VkPhysicalDeviceFeatures2 supportedFeatures
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &supported,
+			};
+			vkGetPhysicalDeviceFeatures2(vkut::physicalDevice, &supportedFeatures);
+			hostCommandsEnabled = supported.accelerationStructureHostCommands == VK_TRUE;
+			indirectTraceRaysEnabled = supportedPipeline.rayTracingPipelineTraceRaysIndirect == VK_TRUE;
 
-			vkGetAccelerationStructureMemoryRequirementsKHR(device, &accelerationMemoryRequirements, &memoryRequirements2);
-
-			return memoryRequirements2.memoryRequirements;
+			features.query = VkPhysicalDeviceRayQueryFeaturesKHR
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR,
+				.pNext = nullptr,
+				.rayQuery = VK_TRUE,
+			};
+			features.pipeline = VkPhysicalDeviceRayTracingPipelineFeaturesKHR
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR,
+				.pNext = &features.query,
+				.rayTracingPipeline = VK_TRUE,
+				.rayTracingPipelineTraceRaysIndirect = supportedPipeline.rayTracingPipelineTraceRaysIndirect,
+			};
+			features.accelerationStructure = VkPhysicalDeviceAccelerationStructureFeaturesKHR
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR,
+				.pNext = &features.pipeline,
+				.accelerationStructure = VK_TRUE,
+				.accelerationStructureHostCommands = supported.accelerationStructureHostCommands,
+			};
+			return &features.accelerationStructure;
 		}
 
-		MappedBuffer createAccelerationScratchBuffer(VkAccelerationStructureKHR acceleration, VkAccelerationStructureMemoryRequirementsTypeKHR type)
-		{
-			VkMemoryRequirements asRequirements = getAccelerationStructureMemoryRequirements(acceleration, type);
+		constexpr VkBufferUsageFlags accelerationStorageUsage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR;
+		constexpr VkBufferUsageFlags scratchUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		constexpr VkBufferUsageFlags shaderBindingTableUsage = VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR;
 
+		//memory an acceleration structure lives in or builds one, usage is accelerationStorageUsage or scratchUsage
+		//structures built on the host have to live in host visible memory
+		MappedBuffer createAccelerationBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+		{
 			VkMemoryAllocateFlagsInfo memAllocFlagsInfo
 			{
 				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
@@ -1435,9 +2001,9 @@ namespace vkut {
 			};
 
 			Buffer BLASbuffer = vkut::common::createBuffer(
-				asRequirements.size, 
-				VK_BUFFER_USAGE_RAY_TRACING_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				size, 
+				usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
+				properties,
 				memAllocFlagsInfo);
 
 			MappedBuffer mappedBuffer
@@ -1451,11 +2017,8 @@ namespace vkut {
 			return mappedBuffer;
 		}
 
-		template<typename T>
-		MappedBuffer createMappedBuffer(const std::vector<T> &data) {
-			
-			uint32_t byteLength = static_cast<uint32_t>( data.size() * sizeof(T));
-
+		MappedBuffer createMappedBuffer(VkDeviceSize byteLength, const std::function<void(void *)> &writeData)
+		{
 			VkMemoryAllocateFlagsInfo memAllocFlagsInfo
 			{
 				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
@@ -1466,7 +2029,7 @@ namespace vkut {
 
 			Buffer buffer = vkut::common::createBuffer(
 				byteLength,
-				VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
+				buildInputUsage, 
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 				memAllocFlagsInfo);
 
@@ -1479,104 +2042,259 @@ namespace vkut {
 
 			mappedBuffer.memoryAddress = GetBufferAddress(mappedBuffer.buffer);
 
+			//stays mapped until destroyMappedBuffer
 			void *dstData;
 			VK_CHECK(vkMapMemory(vkut::device, mappedBuffer.memory, 0, byteLength, 0, &dstData));
-			memcpy(dstData, (void *)data.data(), byteLength);
-			vkUnmapMemory(device, mappedBuffer.memory);
+			writeData(dstData);
 			mappedBuffer.mappedPointer = dstData;
 
 			return mappedBuffer;
 		}
+
+		template<typename T>
+		MappedBuffer createMappedBuffer(const std::vector<T> &data) {
+			
+			VkDeviceSize byteLength = static_cast<VkDeviceSize>(data.size() * sizeof(T));
+
+			return createMappedBuffer(byteLength, [&](void *dstData) { memcpy(dstData, (void *)data.data(), byteLength); });
+		}
+
+		//device local buffers are read by builds and shaders without crossing the bus, host visible ones are meant for data rewritten every frame
+		MappedBuffer createGeometryBuffer(VkCommandPool commandPool, VkDeviceSize byteLength, const std::function<void(void *)> &writeData, MemoryPlacement placement)
+		{
+			if (placement == MemoryPlacement::HOST_VISIBLE)
+			{
+				return createMappedBuffer(byteLength, writeData);
+			}
+
+			VkMemoryAllocateFlagsInfo memAllocFlagsInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+				.pNext = nullptr,
+				.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR,
+				.deviceMask = 0
+			};
+
+			Buffer buffer = vkut::common::createDeviceLocalBuffer(
+				commandPool,
+				byteLength,
+				buildInputUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				writeData,
+				memAllocFlagsInfo);
+
+			MappedBuffer mappedBuffer
+			{
+				.buffer = buffer.buffer,
+				.memory = buffer.memory
+			};
+
+			mappedBuffer.memoryAddress = GetBufferAddress(mappedBuffer.buffer);
+
+			return mappedBuffer;
+		}
+
+		template<typename T>
+		MappedBuffer createGeometryBuffer(VkCommandPool commandPool, const std::vector<T> &data, MemoryPlacement placement) {
+
+			VkDeviceSize byteLength = static_cast<VkDeviceSize>(data.size() * sizeof(T));
+
+			return createGeometryBuffer(commandPool, byteLength, [&](void *dstData) { memcpy(dstData, (void *)data.data(), byteLength); }, placement);
+		}
 		
 		void destroyMappedBuffer(MappedBuffer mappedBuffer)
 		{
+			if (deferDestruction(mappedBuffer)) return;
+			if (mappedBuffer.mappedPointer != nullptr) vkUnmapMemory(device, mappedBuffer.memory);
 			vkut::common::destroyBuffer({ mappedBuffer.buffer, mappedBuffer.memory });
 		}
 
-		void BindAccelerationMemory(VkAccelerationStructureKHR acceleration, VkDeviceMemory memory)
+		VkBuildAccelerationStructureFlagsKHR getBuildFlags(BuildPolicy policy)
 		{
-			VkBindAccelerationStructureMemoryInfoKHR accelerationMemoryBindInfo
+			switch (policy)
 			{
-				.sType = VK_STRUCTURE_TYPE_BIND_ACCELERATION_STRUCTURE_MEMORY_INFO_KHR,
-				.pNext = nullptr,
-				.accelerationStructure = acceleration,
-				.memory = memory,
-				.memoryOffset = 0,
-				.deviceIndexCount = 0,
-				.pDeviceIndices = nullptr,
-			};
+			case BuildPolicy::FAST_TRACE:
+				return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+			case BuildPolicy::FAST_BUILD:
+				return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+			case BuildPolicy::LOW_MEMORY:
+				return VK_BUILD_ACCELERATION_STRUCTURE_LOW_MEMORY_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+			default:
+				assert(false);
+				return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+			}
+		}
+
+		const char *getMemoryPlacementName(MemoryPlacement placement)
+		{
+			switch (placement)
+			{
+			case MemoryPlacement::DEVICE_LOCAL: return "device local";
+			case MemoryPlacement::HOST_VISIBLE: return "host visible";
+			}
+			return "unknown";
+		}
 
-			VK_CHECK(vkBindAccelerationStructureMemoryKHR(device, 1, &accelerationMemoryBindInfo));
+		const char *getBuildPolicyName(BuildPolicy policy)
+		{
+			switch (policy)
+			{
+			case BuildPolicy::FAST_TRACE: return "fast trace";
+			case BuildPolicy::FAST_BUILD: return "fast build";
+			case BuildPolicy::LOW_MEMORY: return "low memory";
+			default: return "unknown";
+			}
 		}
 
-		VkAccelerationStructureKHR createAccelerationStructure(VkAccelerationStructureCreateGeometryTypeInfoKHR geometryTypeInfo, VkAccelerationStructureTypeKHR type)
+		//an acceleration structure with the memory it lives in and the scratch sizes of its builds
+		struct AccelerationStructureAllocation
+		{
+			VkAccelerationStructureKHR accelerationStructure;
+			MappedBuffer memory;
+			VkDeviceSize size;
+			VkDeviceSize buildScratchSize;
+			VkDeviceSize updateScratchSize;
+		};
+
+		//sized for the geometry, which is not read yet, or for compactedSize when it is the copy target of a compaction
+		AccelerationStructureAllocation allocateAccelerationStructure(const VkAccelerationStructureGeometryKHR &geometry, uint32_t primitiveCount,
+			VkAccelerationStructureTypeKHR type, VkBuildAccelerationStructureFlagsKHR flags, VkDeviceSize compactedSize = 0, VkAccelerationStructureBuildTypeKHR buildType = VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR)
 		{
+			AccelerationStructureAllocation allocation = {};
+			const VkMemoryPropertyFlags properties = buildType == VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR
+				? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+				: VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+			//the sizes are known before the structure exists, which is created inside a buffer of that size
+			VkAccelerationStructureBuildGeometryInfoKHR buildInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+				.pNext = nullptr,
+				.type = type,
+				.flags = flags,
+				.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+				.srcAccelerationStructure = VK_NULL_HANDLE,
+				.dstAccelerationStructure = VK_NULL_HANDLE,
+				.geometryCount = 1,
+				.pGeometries = &geometry,
+				.ppGeometries = nullptr,
+				.scratchData{},
+			};
+
+			VkAccelerationStructureBuildSizesInfoKHR sizes
+			{
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR,
+				.pNext = nullptr,
+			};
+			vkGetAccelerationStructureBuildSizesKHR(device, buildType, &buildInfo, &primitiveCount, &sizes);
+
+			allocation.size = compactedSize > 0 ? compactedSize : sizes.accelerationStructureSize;
+			allocation.buildScratchSize = sizes.buildScratchSize;
+			allocation.updateScratchSize = sizes.updateScratchSize;
+			allocation.memory = createAccelerationBuffer(allocation.size, accelerationStorageUsage, properties);
+
 			VkAccelerationStructureCreateInfoKHR accelerationInfo
 			{
 				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
 				.pNext = nullptr,
-				.compactedSize = 0,
+				.createFlags = 0,
+				.buffer = allocation.memory.buffer,
+				.offset = 0,
+				.size = allocation.size,
 				.type = type,
-				.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
-				.maxGeometryCount = 1,
-				.pGeometryInfos = &geometryTypeInfo,
-				.deviceAddress = VK_NULL_HANDLE,
+				.deviceAddress = 0,
 			};
 
-			VkAccelerationStructureKHR accelerationStructure = {};
-			
-			VK_CHECK(vkCreateAccelerationStructureKHR(device, &accelerationInfo, nullptr, &accelerationStructure));
-			Logger::logMessageFormatted("Created acceleration structure %u! ", accelerationStructure);
+			VK_CHECK(vkCreateAccelerationStructureKHR(device, &accelerationInfo, nullptr, &allocation.accelerationStructure));
+
+			LOG_MESSAGE_FORMATTED("Created acceleration structure %u! ", allocation.accelerationStructure);
 			
-			return accelerationStructure;
+			return allocation;
 		}
 
-		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices)
+		//updatable structures keep a scratch buffer large enough for both full rebuilds and updates
+		MappedBuffer createScratchBuffer(const AccelerationStructureAllocation &allocation, bool allowsUpdate)
 		{
-			VkAccelerationStructureKHR accelerationStructure = {};
-			MappedBuffer accelerationMappedBuffer = {};
-			uint64_t address = {};
-			
-			VkAccelerationStructureCreateGeometryTypeInfoKHR accelerationCreateGeometryInfo
+			const VkDeviceSize size = allowsUpdate && allocation.updateScratchSize > allocation.buildScratchSize ? allocation.updateScratchSize : allocation.buildScratchSize;
+			return createAccelerationBuffer(size, scratchUsage);
+		}
+
+		uint64_t getAccelerationStructureAddress(VkAccelerationStructureKHR accelerationStructure)
+		{
+			VkAccelerationStructureDeviceAddressInfoKHR devAddrInfo
 			{
-				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_GEOMETRY_TYPE_INFO_KHR,
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
 				.pNext = nullptr,
-				.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR,
-				.maxPrimitiveCount = static_cast<uint32_t>(indices.size() / 3),
-				.indexType = VK_INDEX_TYPE_UINT32,
-				.maxVertexCount = static_cast<uint32_t>(vertices.size() / 3),
-				.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
-				.allowsTransforms = VK_FALSE,
+				.accelerationStructure = accelerationStructure,
 			};
+			return vkGetAccelerationStructureDeviceAddressKHR(device, &devAddrInfo);
+		}
 
-			accelerationStructure = createAccelerationStructure(
-				accelerationCreateGeometryInfo,
-				VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR);
+		void recordAccelerationStructureBarrier(VkCommandBuffer commandBuffer)
+		{
+			VkMemoryBarrier barrier
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+				.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+			};
 
-			MappedBuffer objectMemory = createAccelerationScratchBuffer(
-				accelerationStructure, 
-				VK_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_TYPE_OBJECT_KHR);
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+				VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+				0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr);
+		}
 
-			BindAccelerationMemory(accelerationStructure, objectMemory.memory);
+		//copies a built acceleration structure into a new one of its compacted size, the source is left untouched
+		AccelerationStructureAllocation compactAccelerationStructure(
+			VkCommandPool commandPool, 
+			VkAccelerationStructureKHR source,
+			const VkAccelerationStructureGeometryKHR &geometry,
+			uint32_t primitiveCount,
+			VkBuildAccelerationStructureFlagsKHR flags,
+			VkDeviceSize &compactedSize)
+		{
+			VkQueryPoolCreateInfo queryPoolInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+				.queryCount = 1,
+			};
+			VkQueryPool queryPool = {};
+			VK_CHECK(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool));
+
+			VkCommandBuffer commandBuffer = initSingleTimeCommands(commandPool);
+			vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+			vkCmdWriteAccelerationStructuresPropertiesKHR(commandBuffer, 1, &source, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, queryPool, 0);
+			submitSingleTimeCommands(commandPool, commandBuffer);
 
-			MappedBuffer buildScratchMemory = createAccelerationScratchBuffer(
-				accelerationStructure, 
-				VK_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_TYPE_BUILD_SCRATCH_KHR);
+			VK_CHECK(vkGetQueryPoolResults(device, queryPool, 0, 1, sizeof(VkDeviceSize), &compactedSize, sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+			vkDestroyQueryPool(device, queryPool, nullptr);
 
-			// Get bottom level acceleration structure handle for use in top level instances
-			VkAccelerationStructureDeviceAddressInfoKHR devAddrInfo
+			AccelerationStructureAllocation compacted = allocateAccelerationStructure(geometry, primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, flags, compactedSize);
+
+			VkCopyAccelerationStructureInfoKHR copyInfo
 			{
-				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+				.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
 				.pNext = nullptr,
-				.accelerationStructure = accelerationStructure,
+				.src = source,
+				.dst = compacted.accelerationStructure,
+				.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR,
 			};
-			address = vkGetAccelerationStructureDeviceAddressKHR(device, &devAddrInfo);
-			
-			MappedBuffer vertexBuffer = createMappedBuffer(vertices);
 
-			MappedBuffer indexBuffer = createMappedBuffer(indices);
+			commandBuffer = initSingleTimeCommands(commandPool);
+			vkCmdCopyAccelerationStructureKHR(commandBuffer, &copyInfo);
+			submitSingleTimeCommands(commandPool, commandBuffer);
+
+			return compacted;
+		}
 
-			VkAccelerationStructureGeometryKHR accelerationGeometry
+		VkAccelerationStructureGeometryKHR getTrianglesGeometry(uint64_t vertexAddress, uint32_t vertexCount, uint64_t indexAddress)
+		{
+			return VkAccelerationStructureGeometryKHR
 			{
 				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
 				.pNext = nullptr,
@@ -1588,177 +2306,437 @@ namespace vkut {
 						.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
 						.pNext = nullptr,
 						.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
-						.vertexData{ .deviceAddress = vertexBuffer.memoryAddress },
+						.vertexData{ .deviceAddress = vertexAddress },
 						.vertexStride = 3 * sizeof(float),
+						.maxVertex = vertexCount - 1,
 						.indexType = VK_INDEX_TYPE_UINT32,
-						.indexData{ .deviceAddress = indexBuffer.memoryAddress },
+						.indexData{ .deviceAddress = indexAddress },
 						.transformData{},
 					}
 				},
 				.flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
 			};
+		}
 
-			std::vector<VkAccelerationStructureGeometryKHR> accelerationGeometries( { accelerationGeometry });
-			const VkAccelerationStructureGeometryKHR *ppGeometries = accelerationGeometries.data();
+		VkAccelerationStructureGeometryKHR getInstancesGeometry(uint64_t instanceAddress)
+		{
+			return VkAccelerationStructureGeometryKHR
+			{
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+				.pNext = nullptr,
+				.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
+				.geometry
+				{
+					.instances
+					{
+						.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+						.pNext = nullptr,
+						.arrayOfPointers = VK_FALSE,
+						.data{ .deviceAddress = instanceAddress }
+					}
+				},
+				.flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
+			};
+		}
+
+		//a full build, or an update in place when update is set
+		void recordBuild(VkCommandBuffer commandBuffer, const VkAccelerationStructureGeometryKHR &geometry, uint32_t primitiveCount, VkAccelerationStructureTypeKHR type,
+			VkBuildAccelerationStructureFlagsKHR flags, VkAccelerationStructureKHR accelerationStructure, VkBool32 update, uint64_t scratchAddress)
+		{
+			VkAccelerationStructureBuildGeometryInfoKHR accelerationBuildGeometryInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+				.pNext = nullptr,
+				.type = type,
+				.flags = flags,
+				.mode = update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+				.srcAccelerationStructure = update ? accelerationStructure : VK_NULL_HANDLE,
+				.dstAccelerationStructure = accelerationStructure,
+				.geometryCount = 1,
+				.pGeometries = &geometry,
+				.ppGeometries = nullptr,
+				.scratchData{ .deviceAddress = scratchAddress },
+			};
+
+			VkAccelerationStructureBuildRangeInfoKHR accelerationBuildRangeInfo
+			{
+				.primitiveCount = primitiveCount,
+				.primitiveOffset = 0,
+				.firstVertex = 0,
+				.transformOffset = 0
+			};
+
+			const VkAccelerationStructureBuildRangeInfoKHR *accelerationBuildRanges = &accelerationBuildRangeInfo;
+
+			vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &accelerationBuildGeometryInfo, &accelerationBuildRanges);
+		}
 
+		//returns once the operation has no more work for this thread, VK_THREAD_IDLE_KHR means it may have some later
+		void joinDeferredOperation(VkDeferredOperationKHR operation)
+		{
+			VkResult result = vkDeferredOperationJoinKHR(device, operation);
+			while (result == VK_THREAD_IDLE_KHR)
+			{
+				std::this_thread::yield();
+				result = vkDeferredOperationJoinKHR(device, operation);
+			}
+			assert(result == VK_SUCCESS || result == VK_THREAD_DONE_KHR);
+		}
+
+		//runs command with a deferred operation and returns once joinOperation has finished it, the parameters of command are read until then
+		VkResult runDeferred(const JoinOperation &joinOperation, const std::function<VkResult(VkDeferredOperationKHR)> &command)
+		{
+			VkDeferredOperationKHR operation = {};
+			VK_CHECK(vkCreateDeferredOperationKHR(device, nullptr, &operation));
+
+			VkResult result = command(operation);
+			if (result == VK_OPERATION_DEFERRED_KHR)
+			{
+				//no upper bound is reported as UINT32_MAX, joinOperation clamps it to the threads it has
+				const uint32_t concurrency = vkGetDeferredOperationMaxConcurrencyKHR(device, operation);
+				joinOperation(concurrency > 0 ? concurrency : 1, [operation]() { joinDeferredOperation(operation); });
+				result = vkGetDeferredOperationResultKHR(device, operation);
+			}
+			else if (result == VK_OPERATION_NOT_DEFERRED_KHR)
+			{
+				result = VK_SUCCESS;
+			}
+
+			vkDestroyDeferredOperationKHR(device, operation, nullptr);
+			return result;
+		}
+
+		//a full build on the host spread over the threads joinOperation has
+		VkResult buildOnHost(const JoinOperation &joinOperation, const VkAccelerationStructureGeometryKHR &geometry, uint32_t primitiveCount, VkAccelerationStructureTypeKHR type,
+			VkBuildAccelerationStructureFlagsKHR flags, VkAccelerationStructureKHR accelerationStructure, void *scratch)
+		{
 			VkAccelerationStructureBuildGeometryInfoKHR accelerationBuildGeometryInfo
 			{
 				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
 				.pNext = nullptr,
-				.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
-				.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
-				.update = VK_FALSE,
+				.type = type,
+				.flags = flags,
+				.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
 				.srcAccelerationStructure = VK_NULL_HANDLE,
 				.dstAccelerationStructure = accelerationStructure,
-				.geometryArrayOfPointers = VK_FALSE,
 				.geometryCount = 1,
-				.ppGeometries = &ppGeometries,
-				.scratchData{.deviceAddress = buildScratchMemory.memoryAddress },
+				.pGeometries = &geometry,
+				.ppGeometries = nullptr,
+				.scratchData{ .hostAddress = scratch },
 			};
 
-			VkAccelerationStructureBuildOffsetInfoKHR accelerationBuildOffsetInfo
+			VkAccelerationStructureBuildRangeInfoKHR accelerationBuildRangeInfo
 			{
-				.primitiveCount = 1,
+				.primitiveCount = primitiveCount,
 				.primitiveOffset = 0,
 				.firstVertex = 0,
 				.transformOffset = 0
 			};
 
-			std::vector<VkAccelerationStructureBuildOffsetInfoKHR *> accelerationBuildOffsets = { &accelerationBuildOffsetInfo };
+			const VkAccelerationStructureBuildRangeInfoKHR *accelerationBuildRanges = &accelerationBuildRangeInfo;
+
+			//the infos above live on this frame, so the operation has to be finished before returning
+			return runDeferred(joinOperation, [&](VkDeferredOperationKHR operation)
+			{
+				return vkBuildAccelerationStructuresKHR(device, operation, 1, &accelerationBuildGeometryInfo, &accelerationBuildRanges);
+			});
+		}
+
+		//compactAccelerationStructure without a queue, source has to be built on the host as well
+		AccelerationStructureAllocation compactOnHost(
+			const JoinOperation &joinOperation,
+			VkAccelerationStructureKHR source,
+			const VkAccelerationStructureGeometryKHR &geometry,
+			uint32_t primitiveCount,
+			VkBuildAccelerationStructureFlagsKHR flags,
+			VkDeviceSize &compactedSize)
+		{
+			VK_CHECK(vkWriteAccelerationStructuresPropertiesKHR(device, 1, &source, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, sizeof(VkDeviceSize), &compactedSize, sizeof(VkDeviceSize)));
+
+			AccelerationStructureAllocation compacted = allocateAccelerationStructure(
+				geometry, primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, flags, compactedSize, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR);
+
+			VkCopyAccelerationStructureInfoKHR copyInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR,
+				.pNext = nullptr,
+				.src = source,
+				.dst = compacted.accelerationStructure,
+				.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR,
+			};
+
+			VK_CHECK(runDeferred(joinOperation, [&](VkDeferredOperationKHR operation) { return vkCopyAccelerationStructureKHR(device, operation, &copyInfo); }));
+
+			return compacted;
+		}
+
+		void recordBLASBuild(VkCommandBuffer commandBuffer, const BottomLevelAccelerationStructure &blas, VkBool32 update, uint64_t scratchAddress)
+		{
+			recordBuild(commandBuffer, getTrianglesGeometry(blas.vertexAddress, blas.vertexCount, blas.indexAddress), blas.primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+				getBuildFlags(blas.policy), blas.accelerationStructure, update, scratchAddress);
+		}
+
+		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, uint64_t vertexAddress, uint32_t vertexCount, uint64_t indexAddress, uint32_t primitiveCount, BuildPolicy policy)
+		{
+			const VkBuildAccelerationStructureFlagsKHR buildFlags = getBuildFlags(policy);
+			const bool allowsUpdate = (buildFlags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR) != 0;
+			
+			const VkAccelerationStructureGeometryKHR geometry = getTrianglesGeometry(vertexAddress, vertexCount, indexAddress);
+			const AccelerationStructureAllocation allocation = allocateAccelerationStructure(geometry, primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, buildFlags);
+
+			BottomLevelAccelerationStructure blas
+			{
+				.mappedBuffer = allocation.memory,
+				.accelerationStructure = allocation.accelerationStructure,
+				.policy = policy,
+				.size = allocation.size,
+				.vertexAddress = vertexAddress,
+				.indexAddress = indexAddress,
+				.vertexCount = vertexCount,
+				.primitiveCount = primitiveCount,
+			};
+
+			MappedBuffer buildScratchMemory = createScratchBuffer(allocation, allowsUpdate);
+
+			TimestampQueries timestamps = vkut::common::createTimestampQueries(2);
 
 			VkCommandBuffer commandBuffer = vkut::initSingleTimeCommands(commandPool);
 
-			vkCmdBuildAccelerationStructureKHR(commandBuffer, 1, &accelerationBuildGeometryInfo, accelerationBuildOffsets.data());
+			vkut::common::resetTimestamps(commandBuffer, timestamps, 0, 2);
+			vkut::common::writeTimestamp(commandBuffer, timestamps, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+			recordBLASBuild(commandBuffer, blas, VK_FALSE, buildScratchMemory.memoryAddress);
+			vkut::common::writeTimestamp(commandBuffer, timestamps, 1, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR);
 
 			vkut::submitSingleTimeCommands(commandPool, commandBuffer);
 
-			assert(address != 0);
-			BottomLevelAccelerationStructure result
+			blas.buildMilliseconds = vkut::common::getElapsedMilliseconds(timestamps, 0, 1);
+			vkut::common::destroyTimestampQueries(timestamps);
+
+			if (allowsUpdate)
 			{
-				.mappedBuffer = accelerationMappedBuffer,
-				.accelerationStructure = accelerationStructure,
-				.address = address,
-				.indexBuffer = indexBuffer,
-				.vertexBuffer = vertexBuffer
-			};
+				blas.scratchBuffer = buildScratchMemory;
+			}
+			else
+			{
+				destroyMappedBuffer(buildScratchMemory);
+			}
 
-			destroyMappedBuffer(objectMemory);
-			destroyMappedBuffer(buildScratchMemory);
+			if (buildFlags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
+			{
+				VkDeviceSize compactedSize = 0;
+				const AccelerationStructureAllocation compacted = compactAccelerationStructure(commandPool, blas.accelerationStructure, geometry, primitiveCount, buildFlags, compactedSize);
 
-			Logger::logMessageFormatted("Created bottom level acceleration structure %u! ", accelerationStructure);
+				LOG_TRIVIAL_FORMATTED("Compacted acceleration structure %u from %u to %u bytes! ", blas.accelerationStructure, static_cast<uint32_t>(blas.size), static_cast<uint32_t>(compactedSize));
 
-			return result;
+				vkDestroyAccelerationStructureKHR(device, blas.accelerationStructure, nullptr);
+				destroyMappedBuffer(blas.mappedBuffer);
+
+				blas.accelerationStructure = compacted.accelerationStructure;
+				blas.mappedBuffer = compacted.memory;
+				blas.size = compactedSize;
+			}
+
+			// Get bottom level acceleration structure handle for use in top level instances
+			blas.address = getAccelerationStructureAddress(blas.accelerationStructure);
+			assert(blas.address != 0);
+
+			LOG_MESSAGE_FORMATTED("Created %s bottom level acceleration structure %u! ", getBuildPolicyName(policy), blas.accelerationStructure);
+
+			return blas;
 		}
 
-		void destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructure blas)
+		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices, BuildPolicy policy, MemoryPlacement placement)
 		{
-			destroyMappedBuffer(blas.mappedBuffer);
-			destroyMappedBuffer(blas.indexBuffer);
-			destroyMappedBuffer(blas.vertexBuffer);
+			MappedBuffer vertexBuffer = createGeometryBuffer(commandPool, vertices, placement);
+			MappedBuffer indexBuffer = createGeometryBuffer(commandPool, indices, placement);
 
-			vkDestroyAccelerationStructureKHR(vkut::device, blas.accelerationStructure, nullptr);
-			Logger::logMessageFormatted("Destroyed bottom level acceleration structure %u! ", blas.accelerationStructure);
+			BottomLevelAccelerationStructure blas = createBLAS(
+				commandPool,
+				vertexBuffer.memoryAddress,
+				static_cast<uint32_t>(vertices.size() / 3),
+				indexBuffer.memoryAddress,
+				static_cast<uint32_t>(indices.size() / 3),
+				policy);
+
+			blas.vertexBuffer = vertexBuffer;
+			blas.indexBuffer = indexBuffer;
+			return blas;
 		}
 
-		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, const std::vector<VkAccelerationStructureInstanceKHR> &instances)
+		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const Buffer &vertexBuffer, uint32_t vertexCount, const std::vector<uint32_t> &indices, BuildPolicy policy)
 		{
-			VkAccelerationStructureKHR accelerationStructure = {};
+			MappedBuffer indexBuffer = createGeometryBuffer(commandPool, indices, MemoryPlacement::DEVICE_LOCAL);
 
-			VkAccelerationStructureCreateGeometryTypeInfoKHR accelerationCreateGeometryInfo
-			{
-				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_GEOMETRY_TYPE_INFO_KHR,
-				.pNext = nullptr,
-				.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
-				.maxPrimitiveCount = static_cast<uint32_t>(instances.size()),
-				.indexType = VK_INDEX_TYPE_NONE_KHR,
-				.maxVertexCount = 0,
-				.vertexFormat = VK_FORMAT_UNDEFINED,
-				.allowsTransforms = VK_FALSE
-			};
+			BottomLevelAccelerationStructure blas = createBLAS(
+				commandPool,
+				GetBufferAddress(vertexBuffer.buffer),
+				vertexCount,
+				indexBuffer.memoryAddress,
+				static_cast<uint32_t>(indices.size() / 3),
+				policy);
+
+			blas.indexBuffer = indexBuffer;
+			return blas;
+		}
+
+		BottomLevelAccelerationStructure createHostBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices, const JoinOperation &joinOperation,
+			BuildPolicy policy, MemoryPlacement placement)
+		{
+			assert(hostCommandsEnabled);
 
-			accelerationStructure = createAccelerationStructure(accelerationCreateGeometryInfo, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR);
+			const VkBuildAccelerationStructureFlagsKHR buildFlags = getBuildFlags(policy);
+			const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / 3);
+			const uint32_t primitiveCount = static_cast<uint32_t>(indices.size() / 3);
 
-			MappedBuffer objectMemory = createAccelerationScratchBuffer(
-				accelerationStructure, VK_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_TYPE_OBJECT_KHR);
+			//the shaders read the buffers, the build reads the vectors
+			MappedBuffer vertexBuffer = createGeometryBuffer(commandPool, vertices, placement);
+			MappedBuffer indexBuffer = createGeometryBuffer(commandPool, indices, placement);
 
-			BindAccelerationMemory(accelerationStructure, objectMemory.memory);
+			VkAccelerationStructureGeometryKHR geometry = getTrianglesGeometry(0, vertexCount, 0);
+			geometry.geometry.triangles.vertexData.hostAddress = vertices.data();
+			geometry.geometry.triangles.indexData.hostAddress = indices.data();
 
-			MappedBuffer buildScratchMemory = createAccelerationScratchBuffer(
-				accelerationStructure, VK_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_TYPE_BUILD_SCRATCH_KHR);
+			const AccelerationStructureAllocation allocation = allocateAccelerationStructure(
+				geometry, primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, buildFlags, 0, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR);
+			std::vector<uint8_t> scratch(allocation.buildScratchSize);
 
-			MappedBuffer instanceBuffer = createMappedBuffer(instances);
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			VK_CHECK(buildOnHost(joinOperation, geometry, primitiveCount, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR, buildFlags, allocation.accelerationStructure, scratch.data()));
+			const double buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-			VkAccelerationStructureGeometryKHR accelerationGeometry
+			BottomLevelAccelerationStructure blas
 			{
-				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
-				.pNext = nullptr,
-				.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
-				.geometry
-				{
-					.instances
-					{
-						.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
-						.pNext = nullptr,
-						.arrayOfPointers = VK_FALSE,
-						.data{ .deviceAddress = instanceBuffer.memoryAddress }
-					}
-				},
-				.flags = VK_GEOMETRY_OPAQUE_BIT_KHR,
+				.mappedBuffer = allocation.memory,
+				.accelerationStructure = allocation.accelerationStructure,
+				.indexBuffer = indexBuffer,
+				.vertexBuffer = vertexBuffer,
+				.policy = policy,
+				.size = allocation.size,
+				.buildMilliseconds = buildMilliseconds,
+				.vertexAddress = vertexBuffer.memoryAddress,
+				.indexAddress = indexBuffer.memoryAddress,
+				.vertexCount = vertexCount,
+				.primitiveCount = primitiveCount,
 			};
 
-			std::vector<VkAccelerationStructureGeometryKHR> accelerationGeometries({ accelerationGeometry });
-			const VkAccelerationStructureGeometryKHR *ppGeometries = accelerationGeometries.data();
+			if (buildFlags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
+			{
+				VkDeviceSize compactedSize = 0;
+				const AccelerationStructureAllocation compacted = compactOnHost(joinOperation, blas.accelerationStructure, geometry, primitiveCount, buildFlags, compactedSize);
 
-			VkAccelerationStructureBuildGeometryInfoKHR accelerationBuildGeometryInfo
+				LOG_TRIVIAL_FORMATTED("Compacted acceleration structure %u from %u to %u bytes on the host! ", blas.accelerationStructure, static_cast<uint32_t>(blas.size), static_cast<uint32_t>(compactedSize));
+
+				vkDestroyAccelerationStructureKHR(device, blas.accelerationStructure, nullptr);
+				destroyMappedBuffer(blas.mappedBuffer);
+
+				blas.accelerationStructure = compacted.accelerationStructure;
+				blas.mappedBuffer = compacted.memory;
+				blas.size = compactedSize;
+			}
+
+			blas.address = getAccelerationStructureAddress(blas.accelerationStructure);
+			assert(blas.address != 0);
+
+			LOG_MESSAGE_FORMATTED("Created %s bottom level acceleration structure %u on the host! ", getBuildPolicyName(policy), blas.accelerationStructure);
+
+			return blas;
+		}
+
+		void recordBLASUpdate(VkCommandBuffer commandBuffer, const BottomLevelAccelerationStructure &blas, bool rebuild)
+		{
+			assert(blas.scratchBuffer.buffer != VK_NULL_HANDLE);
+			recordBLASBuild(commandBuffer, blas, rebuild ? VK_FALSE : VK_TRUE, blas.scratchBuffer.memoryAddress);
+		}
+
+		void destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructure blas)
+		{
+			if (deferDestruction(blas)) return;
+			destroyMappedBuffer(blas.mappedBuffer);
+			destroyMappedBuffer(blas.indexBuffer);
+			if (blas.vertexBuffer.buffer != VK_NULL_HANDLE) destroyMappedBuffer(blas.vertexBuffer);
+			if (blas.scratchBuffer.buffer != VK_NULL_HANDLE) destroyMappedBuffer(blas.scratchBuffer);
+
+			vkDestroyAccelerationStructureKHR(vkut::device, blas.accelerationStructure, nullptr);
+			LOG_MESSAGE_FORMATTED("Destroyed bottom level acceleration structure %u! ", blas.accelerationStructure);
+		}
+
+		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, const std::vector<VkAccelerationStructureInstanceKHR> &instances, bool allowUpdate, MemoryPlacement placement)
+		{
+			return createTLAS(commandPool, static_cast<uint32_t>(instances.size()), [&](VkAccelerationStructureInstanceKHR *dstInstances)
 			{
-				.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
-				.pNext = nullptr,
-				.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-				.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
-				.update = VK_FALSE,
-				.srcAccelerationStructure = VK_NULL_HANDLE,
-				.dstAccelerationStructure = accelerationStructure,
-				.geometryArrayOfPointers = VK_FALSE,
-				.geometryCount = static_cast<uint32_t>(accelerationGeometries.size()),
-				.ppGeometries = &ppGeometries,
-				.scratchData { .deviceAddress = buildScratchMemory.memoryAddress }
-			};
+				memcpy(dstInstances, instances.data(), instances.size() * sizeof(VkAccelerationStructureInstanceKHR));
+			}, allowUpdate, placement);
+		}
+
+		VkBuildAccelerationStructureFlagsKHR getTLASBuildFlags(bool allowUpdate)
+		{
+			return VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | (allowUpdate ? VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR : 0);
+		}
+
+		void recordTLASBuild(VkCommandBuffer commandBuffer, const TopLevelAccelerationStructure &tlas, VkBool32 update, uint64_t scratchAddress)
+		{
+			recordBuild(commandBuffer, getInstancesGeometry(tlas.instanceBuffer.memoryAddress), tlas.instanceCount, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+				getTLASBuildFlags(tlas.allowsUpdate), tlas.accelerationStructure, update, scratchAddress);
+		}
+
+		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, uint32_t instanceCount, const std::function<void(VkAccelerationStructureInstanceKHR *)> &writeInstances, bool allowUpdate, MemoryPlacement placement)
+		{
+			//the instances are written first, the final extensions size the structure from their geometry
+			MappedBuffer instanceBuffer = createGeometryBuffer(
+				commandPool,
+				instanceCount * sizeof(VkAccelerationStructureInstanceKHR),
+				[&](void *dstData) { writeInstances(reinterpret_cast<VkAccelerationStructureInstanceKHR *>(dstData)); },
+				placement);
+
+			const AccelerationStructureAllocation allocation = allocateAccelerationStructure(
+				getInstancesGeometry(instanceBuffer.memoryAddress), instanceCount, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, getTLASBuildFlags(allowUpdate));
 
-			VkAccelerationStructureBuildOffsetInfoKHR accelerationBuildOffsetInfo
+			TopLevelAccelerationStructure tlas
 			{
-				.primitiveCount = 1,
-				.primitiveOffset = 0x0,
-				.firstVertex = 0,
-				.transformOffset = 0x0
+				.mappedBuffer = allocation.memory,
+				.instanceBuffer = instanceBuffer,
+				.accelerationStructure = allocation.accelerationStructure,
+				.instanceCount = instanceCount,
+				.allowsUpdate = allowUpdate
 			};
 
-			std::vector<VkAccelerationStructureBuildOffsetInfoKHR *> accelerationBuildOffsets = { &accelerationBuildOffsetInfo };
+			MappedBuffer buildScratchMemory = createScratchBuffer(allocation, allowUpdate);
 
 			VkCommandBuffer commandBuffer = initSingleTimeCommands(commandPool);
 
-			vkCmdBuildAccelerationStructureKHR(commandBuffer, 1, &accelerationBuildGeometryInfo,
-				accelerationBuildOffsets.data());
+			recordTLASBuild(commandBuffer, tlas, VK_FALSE, buildScratchMemory.memoryAddress);
 
 			submitSingleTimeCommands(commandPool, commandBuffer);
 
-			destroyMappedBuffer(buildScratchMemory);
-			destroyMappedBuffer(objectMemory);
+			if (allowUpdate)
+			{
+				tlas.scratchBuffer = buildScratchMemory;
+			}
+			else
+			{
+				destroyMappedBuffer(buildScratchMemory);
+			}
 
-			Logger::logMessageFormatted("Created top level acceleration structure %u! ", accelerationStructure);
+			LOG_MESSAGE_FORMATTED("Created top level acceleration structure %u with %u instances! ", tlas.accelerationStructure, instanceCount);
 
-			return TopLevelAccelerationStructure
-			{
-				.instanceBuffer = instanceBuffer,
-				.accelerationStructure = accelerationStructure
-			};
+			return tlas;
+		}
+
+		void recordTLASUpdate(VkCommandBuffer commandBuffer, const TopLevelAccelerationStructure &tlas)
+		{
+			assert(tlas.allowsUpdate);
+			recordTLASBuild(commandBuffer, tlas, VK_TRUE, tlas.scratchBuffer.memoryAddress);
 		}
 
 		void destroyTopLevelAccelerationStructure(TopLevelAccelerationStructure tlas)
 		{
+			if (deferDestruction(tlas)) return;
+			destroyMappedBuffer(tlas.mappedBuffer);
 			destroyMappedBuffer(tlas.instanceBuffer);
+			if (tlas.scratchBuffer.buffer != VK_NULL_HANDLE) destroyMappedBuffer(tlas.scratchBuffer);
 			vkDestroyAccelerationStructureKHR(vkut::device, tlas.accelerationStructure, nullptr);
 
-			Logger::logMessageFormatted("Destroyed top level acceleration structure %u! ", tlas.accelerationStructure);
+			LOG_MESSAGE_FORMATTED("Destroyed top level acceleration structure %u! ", tlas.accelerationStructure);
 		}
 
 		VkPipeline createPipeline(VkPipelineLayout layout, const std::vector<VkPipelineShaderStageCreateInfo> &stages, const std::vector<VkRayTracingShaderGroupCreateInfoKHR> &groups)
@@ -1773,22 +2751,17 @@ namespace vkut {
 				.pStages = stages.data(),
 				.groupCount = static_cast<uint32_t>(groups.size()),
 				.pGroups = groups.data(),
-				.maxRecursionDepth = physicalDeviceRaytracingProperties.maxRecursionDepth,
-				.libraries
-					{
-						.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
-						.pNext = nullptr,
-						.libraryCount = 0,
-						.pLibraries = nullptr
-					},
-				.pLibraryInterface = 0,
+				.maxPipelineRayRecursionDepth = maxRayRecursionDepth,
+				.pLibraryInfo = nullptr,
+				.pLibraryInterface = nullptr,
+				.pDynamicState = nullptr,
 				.layout = layout,
 				.basePipelineHandle = VK_NULL_HANDLE, // Optional
 				.basePipelineIndex = -1, // Optional
 			};
 
-			VK_CHECK(vkCreateRayTracingPipelinesKHR(vkut::device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
-			Logger::logMessageFormatted("Created raytracing pipeline %u! ", pipeline);
+			VK_CHECK(vkCreateRayTracingPipelinesKHR(vkut::device, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
+			LOG_MESSAGE_FORMATTED("Created raytracing pipeline %u! ", pipeline);
 
 			return pipeline;
 		}
@@ -1857,15 +2830,21 @@ namespace vkut {
 			return info;
 		}
 
+		VkDeviceSize getShaderGroupStride()
+		{
+			return alignUp(physicalDeviceRaytracingProperties.shaderGroupHandleSize, physicalDeviceRaytracingProperties.shaderGroupBaseAlignment);
+		}
+
 		ShaderBindingTable createShaderBindingTable(VkCommandPool commandPool, VkPipeline pipeline, std::vector<uint32_t> handles)
 		{
 			uint32_t groupCount = static_cast<uint32_t>(handles.size());
 			uint32_t groupHandleSize = physicalDeviceRaytracingProperties.shaderGroupHandleSize;
+			VkDeviceSize groupStride = getShaderGroupStride();
 
-			uint32_t bindingTableSize = groupCount * groupHandleSize;
-			std::vector<uint8_t> shaderHandleStorage(bindingTableSize);
+			std::vector<uint8_t> shaderHandleStorage(groupCount * groupHandleSize);
 			vkGetRayTracingShaderGroupHandlesKHR(device, pipeline, 0, groupCount, shaderHandleStorage.size(), shaderHandleStorage.data());
 
+			VkDeviceSize bindingTableSize = groupCount * groupStride;
 			Buffer stagingBuffer = vkut::common::createBuffer(
 				bindingTableSize, 
 				VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
@@ -1874,14 +2853,25 @@ namespace vkut {
 			void *data;
 			vkMapMemory(device, stagingBuffer.memory, 0, bindingTableSize, 0, &data);
 
-			memcpy(data, shaderHandleStorage.data(), bindingTableSize);
+			//every record starts at a multiple of the base alignment, so any group can start a region
+			for (uint32_t i = 0; i < groupCount; i++)
+			{
+				memcpy(static_cast<uint8_t *>(data) + i * groupStride, shaderHandleStorage.data() + i * groupHandleSize, groupHandleSize);
+			}
 
 			vkUnmapMemory(device, stagingBuffer.memory);
 
+			VkMemoryAllocateFlagsInfo allocateFlags
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+				.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+			};
+
 			ShaderBindingTable table = vkut::common::createBuffer(
 				bindingTableSize, 
-				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_RAY_TRACING_BIT_KHR, 
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | shaderBindingTableUsage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				allocateFlags);
 			
 			VkCommandBuffer commandBuffer = vkut::initSingleTimeCommands(commandPool);
 			VkBufferCopy copyRegion
@@ -1897,6 +2887,28 @@ namespace vkut {
 
 			return table;
 		}
+
+		void recordTraceRaysIndirect(VkCommandBuffer commandBuffer, const ShaderBindingTableRegion &raygen, const ShaderBindingTableRegion &miss, const ShaderBindingTableRegion &hitGroup,
+			const ShaderBindingTableRegion &callable, const Buffer &buffer, VkDeviceSize offset)
+		{
+			assert(indirectTraceRaysEnabled);
+			const VkDeviceAddress commandAddress = GetBufferAddress(buffer.buffer) + offset;
+			//the command is read through its address, which has to be a multiple of 4
+			assert(commandAddress % 4 == 0);
+			vkCmdTraceRaysIndirectKHR(commandBuffer, &raygen, &miss, &hitGroup, &callable, commandAddress);
+		}
+
+		ShaderBindingTableRegion getShaderBindingTableRegion(const ShaderBindingTable &table, uint32_t firstGroup, uint32_t groupCount)
+		{
+			const VkDeviceSize stride = getShaderGroupStride();
+			//unused regions have to be all zero
+			return ShaderBindingTableRegion
+			{
+				.deviceAddress = groupCount > 0 ? GetBufferAddress(table.buffer) + firstGroup * stride : 0,
+				.stride = groupCount > 0 ? stride : 0,
+				.size = groupCount * stride,
+			};
+		}
 		
 		void destroyShaderBindingTable(ShaderBindingTable table)
 		{
@@ -1,18 +1,13 @@
 #ifndef VK_UTILS_H_DEFINED
 #define VK_UTILS_H_DEFINED
 
-#define VK_ENABLE_BETA_EXTENSIONS
 #include "vulkan.h"
 #include <vector>
 #include "Optional.h"
 #include <utility>
-
-#ifdef VKUT_USE_SETUP_RESOURCE_QUEUE
-
+#include <functional>
 #include "ResourceQueue.h"
 
-#endif
-
 #define VK_CHECK(vkOp) 				  														\
 {									  														\
 	VkResult res = vkOp; 		  															\
@@ -40,8 +35,22 @@ namespace vkut {
 	inline std::vector<VkImageView> swapChainImageViews = {};
 	inline VkFormat swapChainImageFormat = {};
 	inline VkExtent2D swapChainExtent = {};
+	//one per frame in flight, signaled by the acquire
 	inline std::vector<VkSemaphore> imageAvailableSemaphores = {};
-	inline std::vector<VkFence> inFlightFences = {};
+	//one per swapchain image, presenting an image holds on to its semaphore until the image is acquired again
+	inline std::vector<VkSemaphore> renderFinishedSemaphores = {};
+	//timeline semaphore of the graphics queue, each frame submitted signals the next value
+	inline VkSemaphore graphicsTimeline = {};
+
+	//picks the present mode of swapchains created from now on
+	enum class PresentPolicy
+	{
+		THROUGHPUT,	//mailbox, then immediate : never waits for the display, mailbox does not tear
+		LATENCY,	//immediate, then mailbox : shows a frame as soon as it is done, may tear
+		VSYNC		//fifo : paced by the display
+	};
+
+	inline PresentPolicy presentPolicy = PresentPolicy::THROUGHPUT;
 
 	//structs
 	struct Image
@@ -50,6 +59,15 @@ namespace vkut {
 		VkDeviceMemory memory;
 	};
 
+	//image and view in VK_IMAGE_LAYOUT_GENERAL for shader reads and writes, e.g. offscreen render targets
+	struct StorageImage
+	{
+		Image image;
+		VkImageView view;
+		VkFormat format;
+		VkExtent2D extent;
+	};
+
 	struct Buffer
 	{
 		VkBuffer buffer;
@@ -57,6 +75,26 @@ namespace vkut {
 		VkDeviceSize size;
 	};
 
+	//host visible buffer mapped for its whole lifetime, split into regionCount regions (typically one per frame in flight)
+	struct PersistentBuffer
+	{
+		Buffer buffer;
+		uint8_t *mappedPointer;
+		VkDeviceSize regionSize;
+		//regionSize aligned to the offset and non coherent atom size limits
+		VkDeviceSize regionStride;
+		uint32_t regionCount;
+		VkDeviceSize atomSize;
+		bool coherent;
+	};
+
+	struct TimestampQueries
+	{
+		VkQueryPool pool;
+		uint32_t count;
+		float period;
+	};
+
 	struct DescriptorSetInfo
 	{
 		const void *pNext;
@@ -96,22 +134,40 @@ namespace vkut {
 		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 		void destroyImageView(VkImageView view);
 
+		//device local, usage gets VK_IMAGE_USAGE_STORAGE_BIT added, its content is undefined until first written
+		[[nodiscard]]
+		StorageImage createStorageImage(VkCommandPool commandPool, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage = 0);
+		void destroyStorageImage(StorageImage storageImage);
+
+		//makes shader writes of srcStage visible to shader reads and writes of dstStage, storage images stay in their layout
+		void recordShaderBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+		//as above, the writes are also visible to the indirect commands recorded after it reading their arguments
+		void recordIndirectBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+
 		[[nodiscard]]
 		VkRenderPass createRenderPass(const std::vector<VkAttachmentDescription> &colorDescriptions, Optional<VkAttachmentDescription> depthDescription = Optional<VkAttachmentDescription>());
 		void destroyRenderPass(VkRenderPass renderPass);
 
 		[[nodiscard]]
-		VkPipelineLayout createPipelineLayout(std::vector<VkDescriptorSetLayout> descriptorSetLayouts);
+		VkPipelineLayout createPipelineLayout(std::vector<VkDescriptorSetLayout> descriptorSetLayouts, std::vector<VkPushConstantRange> pushConstantRanges = {});
 		void destroyPipelineLayout(VkPipelineLayout pipelineLayout);
 
 		void destroyPipeline(VkPipeline pipeline);
 
+		//the shader module can be destroyed once the pipeline is created
+		[[nodiscard]]
+		VkPipeline createComputePipeline(VkPipelineLayout layout, VkShaderModule shaderModule);
+
 		VkFormat findDepthFormat();
 		
 		[[nodiscard]]
 		std::vector<VkCommandBuffer> createCommandBuffers(VkCommandPool commandPool, size_t amount, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 		void destroyCommandBuffers(VkCommandPool commandPool, const std::vector<VkCommandBuffer> &commandBuffers);
 
+		//endSingleTimeCommands submits, waits for the graphics queue to be idle and frees the command buffer
+		VkCommandBuffer beginSingleTimeCommands(VkCommandPool commandPool);
+		void endSingleTimeCommands(VkCommandPool commandPool, VkCommandBuffer commandBuffer);
+
 		void startRecordCommandBuffer(VkCommandBuffer commandBuffer);
 		void endRecordCommandBuffer(VkCommandBuffer commandBuffer);
 	
@@ -132,14 +188,63 @@ namespace vkut {
 		Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags propertyFlags, VkMemoryAllocateFlagsInfo flagsInfo = {});
 		void destroyBuffer(const Buffer &buffer);
 
+		//the buffer has to be host visible and coherent
+		void copyToBuffer(const Buffer &buffer, void *data, size_t size);
 		template<typename T> void copyToBuffer(const Buffer &buffer, const T &data);
 		template<typename T> void copyToBuffer(const Buffer &buffer, const std::vector<T> &data);
+
+		[[nodiscard]]
+		PersistentBuffer createPersistentBuffer(VkDeviceSize regionSize, uint32_t regionCount, VkBufferUsageFlags usage);
+		void destroyPersistentBuffer(PersistentBuffer persistentBuffer);
+
+		void *getRegionPointer(const PersistentBuffer &persistentBuffer, uint32_t region);
+		VkDeviceSize getRegionOffset(const PersistentBuffer &persistentBuffer, uint32_t region);
+
+		//offset and size are relative to the region, both are no-ops on coherent memory
+		void flushRegion(const PersistentBuffer &persistentBuffer, uint32_t region, VkDeviceSize offset, VkDeviceSize size);
+		void invalidateRegion(const PersistentBuffer &persistentBuffer, uint32_t region, VkDeviceSize offset, VkDeviceSize size);
+
+		//memcpy into the region followed by a flush, the region must not be in use by the device
+		void writeRegion(const PersistentBuffer &persistentBuffer, uint32_t region, const void *data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+		//writeData fills a temporary staging buffer which is then copied on the graphics queue, usage gets VK_BUFFER_USAGE_TRANSFER_DST_BIT added
+		[[nodiscard]]
+		Buffer createDeviceLocalBuffer(VkCommandPool commandPool, VkDeviceSize size, VkBufferUsageFlags usage, const std::function<void(void *)> &writeData, VkMemoryAllocateFlagsInfo flagsInfo = {});
 		
 
+		//copies a color image into host memory, the image is in layout before and after the call
+		//the image needs VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+		[[nodiscard]]
+		std::vector<uint8_t> readImage(VkCommandPool commandPool, VkImage image, VkImageLayout layout, uint32_t width, uint32_t height, uint32_t bytesPerPixel);
+
 		[[nodiscard]]
 		VkShaderModule createShaderModule(const char *path);
 		void destroyShaderModule(VkShaderModule shaderModule);
 
+		[[nodiscard]]
+		TimestampQueries createTimestampQueries(uint32_t count);
+		void destroyTimestampQueries(TimestampQueries queries);
+
+		void resetTimestamps(VkCommandBuffer commandBuffer, const TimestampQueries &queries, uint32_t first, uint32_t count);
+		void writeTimestamp(VkCommandBuffer commandBuffer, const TimestampQueries &queries, uint32_t index, VkPipelineStageFlagBits stage);
+
+		//waits for both timestamps to be available
+		double getElapsedMilliseconds(const TimestampQueries &queries, uint32_t begin, uint32_t end);
+
+		//while deferred destruction is on, the destroy functions queue their resources until the graphics timeline reached the value of the next submission
+		void beginDeferredDestruction();
+		//destroys everything still queued, the device has to be idle
+		void endDeferredDestruction();
+
+		//returns the value the next frame submitted to the graphics queue has to signal on graphicsTimeline
+		[[nodiscard]]
+		uint64_t claimGraphicsValue();
+		//value of the last claim, resources retired with it outlive every frame submitted so far
+		uint64_t getSubmittedGraphicsValue();
+		//every frame up to this value completed
+		uint64_t getCompletedGraphicsValue();
+		//waits on the host until the graphics timeline reached value, then destroys what no frame uses anymore
+		void waitGraphicsValue(uint64_t value);
 	}
 	
 	namespace setup {
@@ -170,12 +275,15 @@ namespace vkut {
 
 		void createSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 		void destroySwapChain();
+		//replaces the swapchain and its image views, the resource queue keeps destroying the current ones
+		//the old ones go through deferred destruction when it is on
+		void recreateSwapChain(uint32_t width, uint32_t height, VkImageUsageFlags flags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 
 		void createSwapchainImageViews();
 		void destroySwapchainImageViews();
 
 		[[nodiscard]]
-		VkCommandPool createGraphicsCommandPool();
+		VkCommandPool createGraphicsCommandPool(VkCommandPoolCreateFlags flags = 0);
 		void destroyCommandPool(VkCommandPool commandPool);
 
 		[[nodiscard]]
@@ -186,18 +294,53 @@ namespace vkut {
 		void destroySyncObjects();
 	}
 
+	//VK_KHR_acceleration_structure, VK_KHR_ray_tracing_pipeline and VK_KHR_ray_query
 	namespace raytracing {
-		
 
 		inline PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR;
 		inline PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR;
-		inline PFN_vkBindAccelerationStructureMemoryKHR vkBindAccelerationStructureMemoryKHR;
-		inline PFN_vkGetAccelerationStructureMemoryRequirementsKHR vkGetAccelerationStructureMemoryRequirementsKHR;
-		inline PFN_vkCmdBuildAccelerationStructureKHR vkCmdBuildAccelerationStructureKHR;
 		inline PFN_vkCreateRayTracingPipelinesKHR vkCreateRayTracingPipelinesKHR;
 		inline PFN_vkGetRayTracingShaderGroupHandlesKHR vkGetRayTracingShaderGroupHandlesKHR;
 		inline PFN_vkCmdTraceRaysKHR vkCmdTraceRaysKHR;
+		inline PFN_vkCmdTraceRaysIndirectKHR vkCmdTraceRaysIndirectKHR;
 		inline PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR;
+		inline PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR;
+		inline PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR;
+		inline PFN_vkWriteAccelerationStructuresPropertiesKHR vkWriteAccelerationStructuresPropertiesKHR;
+		inline PFN_vkCopyAccelerationStructureKHR vkCopyAccelerationStructureKHR;
+		inline PFN_vkCreateDeferredOperationKHR vkCreateDeferredOperationKHR;
+		inline PFN_vkDestroyDeferredOperationKHR vkDestroyDeferredOperationKHR;
+		inline PFN_vkGetDeferredOperationMaxConcurrencyKHR vkGetDeferredOperationMaxConcurrencyKHR;
+		inline PFN_vkGetDeferredOperationResultKHR vkGetDeferredOperationResultKHR;
+		inline PFN_vkDeferredOperationJoinKHR vkDeferredOperationJoinKHR;
+
+		inline PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR;
+		inline PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR;
+		inline PFN_vkBuildAccelerationStructuresKHR vkBuildAccelerationStructuresKHR;
+
+		inline const std::vector<const char *> extensionNames =
+		{
+			VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
+			VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
+			VK_KHR_RAY_QUERY_EXTENSION_NAME,
+			VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME
+		};
+
+		using ShaderBindingTableRegion = VkStridedDeviceAddressRegionKHR;
+		using Properties = VkPhysicalDeviceRayTracingPipelinePropertiesKHR;
+
+		struct Features
+		{
+			VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructure;
+			VkPhysicalDeviceRayTracingPipelineFeaturesKHR pipeline;
+			VkPhysicalDeviceRayQueryFeaturesKHR query;
+		};
+
+		//vertex, index and instance buffers the builds read
+		constexpr VkBufferUsageFlags buildInputUsage = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+
+		//every ray is traced from a ray generation shader or a compute shader
+		constexpr uint32_t maxRayRecursionDepth = 1;
 
 		struct MappedBuffer
 		{
@@ -209,18 +352,43 @@ namespace vkut {
 
 		using ShaderBindingTable = Buffer;
 
+		enum class BuildPolicy
+		{
+			FAST_TRACE,	//static geometry : prefer fast trace, compacted after the build
+			FAST_BUILD,	//deforming geometry : prefer fast build, allows in place updates
+			LOW_MEMORY	//distant geometry : smallest possible footprint
+		};
+
+		enum class MemoryPlacement
+		{
+			DEVICE_LOCAL,	//static data, uploaded once through a staging buffer
+			HOST_VISIBLE	//data the host rewrites every frame
+		};
+
 		struct BottomLevelAccelerationStructure
 		{
 			MappedBuffer mappedBuffer;
 			VkAccelerationStructureKHR accelerationStructure;
 			uint64_t address;
+			//vertexBuffer is left empty when the vertices live in a buffer owned by the caller
 			MappedBuffer indexBuffer, vertexBuffer;
+			//only allocated for policies that allow updates
+			MappedBuffer scratchBuffer;
+			BuildPolicy policy;
+			VkDeviceSize size;
+			double buildMilliseconds;
+			uint64_t vertexAddress, indexAddress;
+			uint32_t vertexCount, primitiveCount;
 		};
 
 		struct TopLevelAccelerationStructure
 		{
+			MappedBuffer mappedBuffer;
 			MappedBuffer instanceBuffer;
+			MappedBuffer scratchBuffer;
 			VkAccelerationStructureKHR accelerationStructure;
+			uint32_t instanceCount;
+			bool allowsUpdate;
 		};
 
 		enum class ShaderGroupType
@@ -230,29 +398,76 @@ namespace vkut {
 			MISS
 		};
 
-		inline VkPhysicalDeviceRayTracingPropertiesKHR physicalDeviceRaytracingProperties = {};
+		inline Properties physicalDeviceRaytracingProperties = {};
+		//set by getFeatureChain when the device can build acceleration structures on the host
+		inline bool hostCommandsEnabled = false;
+		//set by getFeatureChain when the device can read the launch size of a trace from a buffer
+		inline bool indirectTraceRaysEnabled = false;
+
+		//runs join on up to concurrency threads, the calling one included, and returns once every one of them returned
+		using JoinOperation = std::function<void(uint32_t concurrency, const std::function<void()> &join)>;
 
 		void initRaytracingFunctions();
 		
 		void getPhysicalDeviceRaytracingProperties();
 
+		//ray tracing pipelines, ray queries, and host builds and indirect traces if supported, the chain returned points into features and goes to setup::createLogicalDevice
+		[[nodiscard]]
+		void *getFeatureChain(Features &features);
+
 		[[nodiscard]]
 		VkPipeline createPipeline(VkPipelineLayout layout, const std::vector<VkPipelineShaderStageCreateInfo> &stages, const std::vector<VkRayTracingShaderGroupCreateInfoKHR> &groups);
 
 		VkRayTracingShaderGroupCreateInfoKHR getShaderGroupCreateInfo(ShaderGroupType groupType, uint32_t index);
 		VkPipelineShaderStageCreateInfo getShaderStageCreateInfo(VkShaderModule shaderModule, VkShaderStageFlagBits stage);
 
+		VkBuildAccelerationStructureFlagsKHR getBuildFlags(BuildPolicy policy);
+		const char *getBuildPolicyName(BuildPolicy policy);
+		const char *getMemoryPlacementName(MemoryPlacement placement);
+
 		[[nodiscard]]
-		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices);
+		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices, BuildPolicy policy = BuildPolicy::FAST_TRACE, MemoryPlacement placement = MemoryPlacement::DEVICE_LOCAL);
+
+		//vertexBuffer needs buildInputUsage and has to outlive the BLAS
+		[[nodiscard]]
+		BottomLevelAccelerationStructure createBLAS(VkCommandPool commandPool, const Buffer &vertexBuffer, uint32_t vertexCount, const std::vector<uint32_t> &indices, BuildPolicy policy = BuildPolicy::FAST_BUILD);
+
+		//built by the CPU through a deferred operation that joinOperation spreads over threads, without touching a queue
+		//the geometry buffers are still created for the shaders, only device local ones are uploaded through the queue
+		//needs hostCommandsEnabled, the BLAS is compacted on the host too but never updatable, buildMilliseconds is wall clock time without the compaction
+		[[nodiscard]]
+		BottomLevelAccelerationStructure createHostBLAS(VkCommandPool commandPool, const std::vector<float> &vertices, const std::vector<uint32_t> &indices, const JoinOperation &joinOperation,
+			BuildPolicy policy = BuildPolicy::FAST_TRACE, MemoryPlacement placement = MemoryPlacement::DEVICE_LOCAL);
+
+		//refits in place (srcAccelerationStructure = dstAccelerationStructure) or rebuilds, the policy has to allow updates
+		void recordBLASUpdate(VkCommandBuffer commandBuffer, const BottomLevelAccelerationStructure &blas, bool rebuild);
+		void recordAccelerationStructureBarrier(VkCommandBuffer commandBuffer);
 		void destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructure blas);
 		
 		[[nodiscard]]
-		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, const std::vector<VkAccelerationStructureInstanceKHR> &instances);
+		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, const std::vector<VkAccelerationStructureInstanceKHR> &instances, bool allowUpdate = false, MemoryPlacement placement = MemoryPlacement::DEVICE_LOCAL);
+		
+		//writeInstances fills instanceCount records into the instance buffer, or into its staging buffer when it is device local
+		[[nodiscard]]
+		TopLevelAccelerationStructure createTLAS(VkCommandPool commandPool, uint32_t instanceCount, const std::function<void(VkAccelerationStructureInstanceKHR *)> &writeInstances, bool allowUpdate = false, MemoryPlacement placement = MemoryPlacement::DEVICE_LOCAL);
+		
+		//refits the TLAS after the BLASes it references were updated
+		void recordTLASUpdate(VkCommandBuffer commandBuffer, const TopLevelAccelerationStructure &tlas);
 		void destroyTopLevelAccelerationStructure(TopLevelAccelerationStructure tlas);
 
+		//one record per group, each aligned to the shader group base alignment
 		[[nodiscard]]
 		ShaderBindingTable createShaderBindingTable(VkCommandPool commandPool, VkPipeline pipeline, std::vector<uint32_t> handles);
 		void destroyShaderBindingTable(ShaderBindingTable table);
+		VkDeviceSize getShaderGroupStride();
+		//groupCount consecutive records from firstGroup on, an empty region for 0
+		ShaderBindingTableRegion getShaderBindingTableRegion(const ShaderBindingTable &table, uint32_t firstGroup, uint32_t groupCount);
+
+		//vkCmdTraceRaysIndirectKHR with the VkTraceRaysIndirectCommandKHR at the device address of buffer plus offset, which needs VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+		//and VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, offset has to be a multiple of 4
+		//needs indirectTraceRaysEnabled, whatever writes the command has to be behind common::recordIndirectBarrier
+		void recordTraceRaysIndirect(VkCommandBuffer commandBuffer, const ShaderBindingTableRegion &raygen, const ShaderBindingTableRegion &miss, const ShaderBindingTableRegion &hitGroup,
+			const ShaderBindingTableRegion &callable, const Buffer &buffer, VkDeviceSize offset);
 	}
 }
 